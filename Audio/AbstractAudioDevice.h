@@ -29,6 +29,7 @@ namespace Audio {
 
     struct  AudioFormat;
     struct  AbstractFilter;
+    class   FilterProcessor;
     class   AudioPacket;
     class   TaskCallback;
     class   AbstractAudioDeviceImpl;
@@ -57,7 +58,10 @@ namespace Audio {
         virtual AudioPacket     readFromBuffer() = 0;   
         //virtual AudioStream     readFromBuffer(TaskCallback* callback) = 0;
         virtual bool            readFromBuffer(AudioStream& out, TaskCallback* callback) = 0;
+        // Each packet written through a filter is a stream of its own, the filter starts over every call
         virtual bool            writeToBuffer(const AudioPacket& in, const AbstractFilter& filter) = 0;
+        // Successive packets through the same processor are one stream. The caller owns it, and its filter
+        virtual bool            writeToBuffer(const AudioPacket& in, FilterProcessor& processor) = 0;
         virtual bool            writeToBuffer(AudioStream& in, const AbstractFilter& filter, TaskCallback* callback = nullptr) = 0;
 
         virtual std::string     id() const;
@@ -0,0 +1,179 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "AllocationAudit.h"
+
+#include <LockFree/ThreadLocal.h>
+//#include <DX/LockFree/ThreadLocal.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace DX {
+namespace Audio {
+namespace AllocationAudit {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // AllocationAudit impl
+
+    /*
+        Everything here can run inside operator new, so none of it may allocate: plain integers, a
+        plain data thread local and fputs
+    */
+    static DX_THREAD_LOCAL size_t       s_realtimeDepth = 0;
+    static std::atomic<size_t>          s_violations(0);
+    static std::atomic<size_t>          s_allocations(0);
+    static std::atomic<ViolationHandler> s_handler(nullptr);
+
+    #ifdef DX_AUDIT_ALLOCATIONS
+    static void defaultViolationHandler(size_t)
+    {
+        std::fputs("DX Audio: heap allocation on a realtime thread\n", stderr);
+        std::abort();
+    }
+    #endif
+
+    RealtimeScope::RealtimeScope(bool armed) : m_armed(armed)
+    {
+    #ifdef DX_AUDIT_ALLOCATIONS
+        if(m_armed)
+            ++s_realtimeDepth;
+    #endif
+    }
+
+    RealtimeScope::~RealtimeScope()
+    {
+    #ifdef DX_AUDIT_ALLOCATIONS
+        if(m_armed)
+            --s_realtimeDepth;
+    #endif
+    }
+
+    bool isEnabled()
+    {
+    #ifdef DX_AUDIT_ALLOCATIONS
+        return true;
+    #else
+        return false;
+    #endif
+    }
+
+    bool isRealtimeThread()
+    {
+        return s_realtimeDepth > 0;
+    }
+
+    size_t violations()
+    {
+        return s_violations;
+    }
+
+    size_t allocations()
+    {
+        return s_allocations;
+    }
+
+    void resetCounters()
+    {
+        s_violations = 0;
+        s_allocations = 0;
+    }
+
+    void setViolationHandler(ViolationHandler handler)
+    {
+        s_handler = handler;
+    }
+
+    void recordAllocation(size_t size)
+    {
+    #ifdef DX_AUDIT_ALLOCATIONS
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+        if(s_realtimeDepth == 0)
+            return;
+
+        s_violations.fetch_add(1, std::memory_order_relaxed);
+        const ViolationHandler handler = s_handler.load();
+        if(handler)
+            handler(size);
+        else
+            defaultViolationHandler(size);
+    #else
+        (void)size;
+    #endif
+    }
+
+}
+}
+}
+
+#ifdef DX_AUDIT_ALLOCATIONS
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // operator new / delete replacements
+
+    void* operator new(size_t size)
+    {
+        DX::Audio::AllocationAudit::recordAllocation(size);
+        void* memory = std::malloc(size > 0 ? size : 1);
+        if(!memory)
+            throw std::bad_alloc();
+        return memory;
+    }
+
+    void* operator new[](size_t size)
+    {
+        return operator new(size);
+    }
+
+    void* operator new(size_t size, const std::nothrow_t&) throw()
+    {
+        DX::Audio::AllocationAudit::recordAllocation(size);
+        return std::malloc(size > 0 ? size : 1);
+    }
+
+    void* operator new[](size_t size, const std::nothrow_t& nothrow) throw()
+    {
+        return operator new(size, nothrow);
+    }
+
+    void operator delete(void* memory) throw()
+    {
+        std::free(memory);
+    }
+
+    void operator delete[](void* memory) throw()
+    {
+        std::free(memory);
+    }
+
+    void operator delete(void* memory, const std::nothrow_t&) throw()
+    {
+        std::free(memory);
+    }
+
+    void operator delete[](void* memory, const std::nothrow_t&) throw()
+    {
+        std::free(memory);
+    }
+
+#endif
@@ -0,0 +1,115 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX Audio - AllocationAudit catches heap allocations made by realtime audio threads
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstddef>
+
+namespace DX {
+namespace Audio {
+namespace AllocationAudit {
+
+    //! Defines how many periods device loops run before they start auditing. Arbitrary for now, best results TBD
+    #ifndef DEFAULT_AUDIT_WARMUP
+        #define DEFAULT_AUDIT_WARMUP 64
+    #endif
+
+    /*! \brief AllocationAudit is a test and benchmark mode that makes allocating on a realtime thread
+        fail loudly.
+
+        Once warmed up, capture -> filter -> playback is meant to run without touching the heap:
+        packets come from an AudioPacketPool, AudioStreams reuse their nodes, and AudioPackets move
+        instead of copy. Building with DX_AUDIT_ALLOCATIONS defined replaces the global operator new
+        (and new[], and their nothrow versions) with versions that check whether the calling thread
+        is inside a RealtimeScope. AudioAllocator heap allocations are checked the same way. Each
+        allocation on a realtime thread counts as a violation and goes to the violation handler,
+        which by default writes a message to stderr and aborts - so a regression shows up as a
+        failing run, not as an occasional glitch.
+
+        The device loops open a RealtimeScope for every period once DEFAULT_AUDIT_WARMUP periods have
+        gone by, which gives pools and streams time to fill up first.
+
+        Without DX_AUDIT_ALLOCATIONS nothing is replaced and RealtimeScope does nothing, so normal
+        builds pay nothing.
+
+        \note On Windows, replacing operator new only affects the module (exe or dll) it is compiled
+        into. Build DXAudio itself with DX_AUDIT_ALLOCATIONS to audit its threads.
+
+        \code
+        AllocationAudit::setViolationHandler(&countOnly); // Benchmarks may want to count, not abort
+        runPipelineFor(std::chrono::seconds(10));
+        assert(AllocationAudit::violations() == 0);
+        \endcode
+    */
+
+    /*! Called on every realtime allocation, with its size. Must not allocate. */
+    typedef void (*ViolationHandler)(size_t size);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // RealtimeScope
+
+    /*! \brief Marks the current thread as realtime for as long as the RealtimeScope lives. Scopes nest. */
+    class RealtimeScope
+    {
+    public:
+        /*! \param[in] armed    False makes the scope do nothing, for warm-up periods */
+        explicit RealtimeScope(bool armed = true);
+        ~RealtimeScope();
+
+    private:
+        const bool  m_armed;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        RealtimeScope(const RealtimeScope&);
+        RealtimeScope(RealtimeScope&&);
+    };
+
+    /*! \return True if built with DX_AUDIT_ALLOCATIONS */
+    bool    isEnabled();
+    /*! \return True if the calling thread is inside an armed RealtimeScope */
+    bool    isRealtimeThread();
+
+    /*! \return The number of allocations made on realtime threads */
+    size_t  violations();
+    /*! \return The number of allocations seen in total, realtime or not */
+    size_t  allocations();
+    /*! Zeroes violations() and allocations() */
+    void    resetCounters();
+
+    /*! Replaces what happens on a realtime allocation. nullptr goes back to printing and aborting. */
+    void    setViolationHandler(ViolationHandler handler);
+
+    /*! Counts an allocation of size AudioBytes, and reports it if the calling thread is realtime.
+        \note This is largely for internal use, by the operator new replacements and AudioAllocator.
+    */
+    void    recordAllocation(size_t size);
+
+}
+}
+}
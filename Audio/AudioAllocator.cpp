@@ -0,0 +1,396 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "AudioAllocator.h"
+#include "AllocationAudit.h"
+
+#include <assert.h>
+#include <cstring>
+#include <thread>
+
+#ifdef WIN32
+    #include <malloc.h>
+    #include <windows.h>
+#else
+    #include <stdlib.h>
+    #include <sys/mman.h>
+#endif
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // AudioMemoryDeleter impl
+
+    AudioMemoryDeleter::AudioMemoryDeleter() : allocator(nullptr), size(0)
+    {
+    }
+
+    AudioMemoryDeleter::AudioMemoryDeleter(const std::shared_ptr<AudioAllocator>& allocator, size_t size)
+        : allocator(allocator), size(size)
+    {
+    }
+
+    void AudioMemoryDeleter::operator()(AudioByte* memory) const
+    {
+        if(!memory)
+            return;
+
+        if(allocator)
+            allocator->deallocateBytes(memory, size);
+        else
+            delete[] memory;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // AudioAllocator impl
+
+    // Constant initialized (shared_ptr's default constructor is constexpr), so it's safe to use from other statics
+    static std::shared_ptr<AudioAllocator> s_defaultAllocator;
+
+    AudioAllocator::AudioAllocator()
+    {
+    }
+
+    AudioAllocator::~AudioAllocator()
+    {
+    }
+
+    AudioMemory AudioAllocator::allocate(size_t size)
+    {
+        if(size == 0)
+            return AudioMemory();
+
+        AudioByte* memory = allocateBytes(size);
+        if(!memory)
+            return AudioMemory();
+        return AudioMemory(memory, AudioMemoryDeleter(shared_from_this(), size));
+    }
+
+    std::shared_ptr<AudioAllocator> AudioAllocator::getDefault()
+    {
+        std::shared_ptr<AudioAllocator> allocator = std::atomic_load(&s_defaultAllocator);
+        if(allocator)
+            return allocator;
+
+        // First use (or reset back to nullptr), race to install an AlignedAllocator
+        std::shared_ptr<AudioAllocator> expected;
+        allocator = AlignedAllocator::create();
+        if(!std::atomic_compare_exchange_strong(&s_defaultAllocator, &expected, allocator))
+            return expected;
+        return allocator;
+    }
+
+    void AudioAllocator::setDefault(const std::shared_ptr<AudioAllocator>& allocator)
+    {
+        std::atomic_store(&s_defaultAllocator, allocator);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // AlignedAllocator impl
+
+    static bool isPowerOfTwo(size_t value)
+    {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+
+    static AudioByte* alignedAllocate(size_t size, size_t alignment)
+    {
+        AllocationAudit::recordAllocation(size);
+    #ifdef WIN32
+        return static_cast<AudioByte*>(_aligned_malloc(size, alignment));
+    #else
+        void* memory = nullptr;
+        if(posix_memalign(&memory, alignment, size) != 0)
+            return nullptr;
+        return static_cast<AudioByte*>(memory);
+    #endif
+    }
+
+    static void alignedFree(AudioByte* memory)
+    {
+    #ifdef WIN32
+        _aligned_free(memory);
+    #else
+        free(memory);
+    #endif
+    }
+
+    std::shared_ptr<AlignedAllocator> AlignedAllocator::create(size_t alignment)
+    {
+        // Constructor is private, so no make_shared
+        return std::shared_ptr<AlignedAllocator>(new AlignedAllocator(alignment));
+    }
+
+    AlignedAllocator::AlignedAllocator(size_t alignment)
+        : m_alignment(isPowerOfTwo(alignment) && alignment >= sizeof(void*) ? alignment : DEFAULT_AUDIO_ALIGNMENT)
+    {
+        assert(isPowerOfTwo(alignment));
+    }
+
+    AlignedAllocator::~AlignedAllocator()
+    {
+    }
+
+    size_t AlignedAllocator::alignment() const
+    {
+        return m_alignment;
+    }
+
+    AudioByte* AlignedAllocator::allocateBytes(size_t size)
+    {
+        return alignedAllocate(size, m_alignment);
+    }
+
+    void AlignedAllocator::deallocateBytes(AudioByte* memory, size_t)
+    {
+        alignedFree(memory);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // HugePageArena impl
+
+    // Blocks run from 2^MIN_BLOCK_SHIFT (one aligned cache line) up to 2^(MIN_BLOCK_SHIFT + NUM_BLOCK_CLASSES - 1) AudioBytes
+    static const size_t MIN_BLOCK_SHIFT = 6;
+    static const size_t NUM_BLOCK_CLASSES = 26;
+
+    static_assert((size_t(1) << MIN_BLOCK_SHIFT) >= DEFAULT_AUDIO_ALIGNMENT, "Arena blocks must be at least as aligned as the heap");
+
+    static size_t blockClassOf(size_t size)
+    {
+        size_t blockClass = 0;
+        while(blockClass < NUM_BLOCK_CLASSES && (size_t(1) << (blockClass + MIN_BLOCK_SHIFT)) < size)
+            ++blockClass;
+        return blockClass;
+    }
+
+    static size_t blockSizeOf(size_t blockClass)
+    {
+        return size_t(1) << (blockClass + MIN_BLOCK_SHIFT);
+    }
+
+    // Every arena operation is a handful of pointer swaps, so a plain spin is plenty
+    class ArenaLock
+    {
+    public:
+        ArenaLock(std::atomic<bool>& lock) : m_lock(lock)
+        {
+            while(m_lock.exchange(true, std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+
+        ~ArenaLock()
+        {
+            m_lock.store(false, std::memory_order_release);
+        }
+
+    private:
+        std::atomic<bool>& m_lock;
+
+        ArenaLock(const ArenaLock&);
+        ArenaLock& operator=(const ArenaLock&);
+    };
+
+    // Maps size bytes (a multiple of HUGE_PAGE_SIZE) as well as the system lets us, see HugePageArena
+    static AudioByte* mapArena(size_t size, HugePageArena::Backing& backing)
+    {
+    #ifdef WIN32
+        const SIZE_T largePage = GetLargePageMinimum();
+        if(largePage > 0 && size % largePage == 0)
+        {
+            void* memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if(memory)
+            {
+                // Large pages are always resident, nothing to touch
+                backing = HugePageArena::EXPLICIT_HUGE_PAGES;
+                return static_cast<AudioByte*>(memory);
+            }
+        }
+
+        void* memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if(!memory)
+        {
+            backing = HugePageArena::NO_BACKING;
+            return nullptr;
+        }
+        backing = HugePageArena::REGULAR_PAGES;
+        std::memset(memory, 0, size);
+        return static_cast<AudioByte*>(memory);
+    #else
+        #ifdef MAP_POPULATE
+            const int populate = MAP_POPULATE;
+        #else
+            const int populate = 0;
+        #endif
+
+        #ifdef MAP_HUGETLB
+            void* huge = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+            if(huge != MAP_FAILED)
+            {
+                backing = HugePageArena::EXPLICIT_HUGE_PAGES;
+                return static_cast<AudioByte*>(huge);
+            }
+        #endif
+
+        // Over-map by a huge page so the arena can start on a huge page boundary, then trim the slack
+        void* mapped = mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(mapped == MAP_FAILED)
+        {
+            backing = HugePageArena::NO_BACKING;
+            return nullptr;
+        }
+
+        AudioByte* const start = static_cast<AudioByte*>(mapped);
+        const size_t misalignment = reinterpret_cast<size_t>(start) % HUGE_PAGE_SIZE;
+        const size_t lead = (misalignment == 0 ? 0 : HUGE_PAGE_SIZE - misalignment);
+        AudioByte* const aligned = start + lead;
+        if(lead > 0)
+            munmap(start, lead);
+        if(HUGE_PAGE_SIZE - lead > 0)
+            munmap(aligned + size, HUGE_PAGE_SIZE - lead);
+
+        backing = HugePageArena::REGULAR_PAGES;
+        #ifdef MADV_HUGEPAGE
+            if(madvise(aligned, size, MADV_HUGEPAGE) == 0)
+                backing = HugePageArena::TRANSPARENT_HUGE_PAGES;
+        #endif
+
+        // Fault everything in now, rather than on the audio thread
+        std::memset(aligned, 0, size);
+        return aligned;
+    #endif
+    }
+
+    static void unmapArena(AudioByte* memory, size_t size)
+    {
+        if(!memory)
+            return;
+    #ifdef WIN32
+        (void)size;
+        VirtualFree(memory, 0, MEM_RELEASE);
+    #else
+        munmap(memory, size);
+    #endif
+    }
+
+    std::shared_ptr<HugePageArena> HugePageArena::create(size_t arenaSize)
+    {
+        // Constructor is private, so no make_shared
+        return std::shared_ptr<HugePageArena>(new HugePageArena(arenaSize));
+    }
+
+    HugePageArena::HugePageArena(size_t arenaSize)
+        : m_base(nullptr), m_capacity(0), m_backing(NO_BACKING), m_lock(false), m_carved(0), m_freeLists(new FreeBlock*[NUM_BLOCK_CLASSES]), m_overflowAllocations(0)
+    {
+        for(size_t i = 0; i < NUM_BLOCK_CLASSES; ++i)
+            m_freeLists[i] = nullptr;
+
+        const size_t capacity = ((arenaSize + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE;
+        if(capacity == 0)
+            return;
+
+        m_base = mapArena(capacity, m_backing);
+        if(m_base)
+            m_capacity = capacity;
+    }
+
+    HugePageArena::~HugePageArena()
+    {
+        // Every block holds a reference to us, so by now they've all come back
+        unmapArena(m_base, m_capacity);
+    }
+
+    size_t HugePageArena::alignment() const
+    {
+        return DEFAULT_AUDIO_ALIGNMENT;
+    }
+
+    HugePageArena::Backing HugePageArena::backing() const
+    {
+        return m_backing;
+    }
+
+    size_t HugePageArena::capacity() const
+    {
+        return m_capacity;
+    }
+
+    size_t HugePageArena::bytesCarved() const
+    {
+        ArenaLock lock(m_lock);
+        return m_carved;
+    }
+
+    size_t HugePageArena::overflowAllocations() const
+    {
+        return m_overflowAllocations;
+    }
+
+    AudioByte* HugePageArena::allocateBytes(size_t size)
+    {
+        const size_t blockClass = blockClassOf(size);
+        if(blockClass < NUM_BLOCK_CLASSES && m_base)
+        {
+            const size_t blockSize = blockSizeOf(blockClass);
+            ArenaLock lock(m_lock);
+            FreeBlock* block = m_freeLists[blockClass];
+            if(block)
+            {
+                m_freeLists[blockClass] = block->next;
+                return reinterpret_cast<AudioByte*>(block);
+            }
+            if(m_capacity - m_carved >= blockSize)
+            {
+                AudioByte* memory = m_base + m_carved;
+                m_carved += blockSize;
+                return memory;
+            }
+        }
+
+        ++m_overflowAllocations;
+        return alignedAllocate(size, DEFAULT_AUDIO_ALIGNMENT);
+    }
+
+    void HugePageArena::deallocateBytes(AudioByte* memory, size_t size)
+    {
+        if(!owns(memory))
+        {
+            alignedFree(memory);
+            return;
+        }
+
+        const size_t blockClass = blockClassOf(size);
+        assert(blockClass < NUM_BLOCK_CLASSES);
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(memory);
+        ArenaLock lock(m_lock);
+        block->next = m_freeLists[blockClass];
+        m_freeLists[blockClass] = block;
+    }
+
+    bool HugePageArena::owns(const AudioByte* memory) const
+    {
+        return m_base && memory >= m_base && memory < m_base + m_capacity;
+    }
+
+}
+}
@@ -0,0 +1,228 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX Audio - AudioAllocator decides where AudioPacket memory comes from: aligned heap or huge pages
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "AudioFormat.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace DX {
+namespace Audio {
+
+    class AudioAllocator;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // AudioMemory
+
+    /*! \brief AudioMemoryDeleter hands a buffer back to the AudioAllocator it came from, keeping that
+        allocator alive until it has. A deleter without an allocator falls back to delete[], for
+        memory that came from plain new AudioByte[].
+    */
+    struct AudioMemoryDeleter
+    {
+        AudioMemoryDeleter(); /*!< Frees with delete[] */
+        AudioMemoryDeleter(const std::shared_ptr<AudioAllocator>& allocator, size_t size);
+
+        void operator()(AudioByte* memory) const;
+
+        std::shared_ptr<AudioAllocator> allocator;
+        size_t                          size;
+    };
+
+    /*! An owned buffer of AudioBytes that knows how to free itself */
+    typedef std::unique_ptr<AudioByte[], AudioMemoryDeleter> AudioMemory;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // AudioAllocator
+
+    //! Defines the alignment, in AudioBytes, of AudioPacket memory. One cache line, and a full AVX-512 register
+    #ifndef DEFAULT_AUDIO_ALIGNMENT
+        #define DEFAULT_AUDIO_ALIGNMENT 64
+    #endif
+
+    /*! \brief AudioAllocator is the hook through which AudioPackets (and AudioPacketPools) get their
+        memory.
+
+        Every AudioPacket that isn't pooled allocates from getDefault(), which is an AlignedAllocator
+        unless setDefault() says otherwise. An AudioPacketPool allocates from whichever AudioAllocator
+        it was created with. Memory always goes back to the allocator it came from, no matter who ends
+        up freeing it, and allocators live until the last of their memory is gone.
+
+        \note AudioAllocators can only be created through their create() functions, as the memory they
+        hand out needs shared ownership of them.
+
+        \code
+        // Long running, many channel pipeline - keep every packet on huge pages
+        std::shared_ptr<AudioPacketPool> pool = AudioPacketPool::create(DEFAULT_POOL_DEPTH, HugePageArena::create());
+        \endcode
+    */
+    class AudioAllocator : public std::enable_shared_from_this<AudioAllocator>
+    {
+    public:
+        virtual ~AudioAllocator();
+
+        /*! \return A buffer of size AudioBytes, aligned to at least alignment(). Empty if size is 0
+            or the allocation failed.
+        */
+        AudioMemory         allocate(size_t size);
+        /*! \return The alignment, in AudioBytes, every buffer from this allocator has */
+        virtual size_t      alignment() const = 0;
+
+        /*! \return The allocator unpooled AudioPackets draw from */
+        static std::shared_ptr<AudioAllocator>  getDefault();
+        /*! Replaces the allocator unpooled AudioPackets draw from. nullptr goes back to an AlignedAllocator.
+            \note Memory already handed out is unaffected - it still goes back to where it came from.
+        */
+        static void                             setDefault(const std::shared_ptr<AudioAllocator>& allocator);
+
+    protected:
+        AudioAllocator();
+
+        virtual AudioByte*  allocateBytes(size_t size) = 0;
+        virtual void        deallocateBytes(AudioByte* memory, size_t size) = 0;
+
+    private:
+        friend struct AudioMemoryDeleter;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        AudioAllocator(const AudioAllocator&);
+        AudioAllocator(AudioAllocator&&);
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // AlignedAllocator
+
+    /*! \brief AlignedAllocator takes memory straight from the heap, aligned so that SIMD kernels never
+        have a load or store split across cache lines.
+    */
+    class AlignedAllocator : public AudioAllocator
+    {
+    public:
+        /*! \param[in] alignment    A power of two, at least sizeof(void*) */
+        static std::shared_ptr<AlignedAllocator>    create(size_t alignment = DEFAULT_AUDIO_ALIGNMENT);
+        ~AlignedAllocator();
+
+        size_t              alignment() const;
+
+    protected:
+        AudioByte*          allocateBytes(size_t size);
+        void                deallocateBytes(AudioByte* memory, size_t size);
+
+    private:
+        explicit AlignedAllocator(size_t alignment);
+
+        const size_t        m_alignment;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // HugePageArena
+
+    //! Defines how much memory a HugePageArena maps up front. Arbitrary for now, best results TBD
+    #ifndef DEFAULT_ARENA_SIZE
+        #define DEFAULT_ARENA_SIZE (32 * 1024 * 1024)
+    #endif
+
+    //! Defines the huge page size HugePageArenas round up to
+    #ifndef HUGE_PAGE_SIZE
+        #define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+    #endif
+
+    /*! \brief HugePageArena maps one large block of memory up front, backed by 2 MB pages where the
+        system allows it, and carves AudioPacket buffers out of it. A pipeline pushing dozens of
+        channels through several filters touches a lot of distinct 4 KB pages every period; on 2 MB
+        pages that whole working set fits in a handful of TLB entries.
+
+        Getting the memory is best effort, in order:
+            - Explicit huge pages (MAP_HUGETLB on Linux, MEM_LARGE_PAGES on Windows - the latter needs
+              the process to hold SeLockMemoryPrivilege)
+            - Regular pages, 2 MB aligned, with madvise(MADV_HUGEPAGE) asking for transparent huge pages
+            - Regular pages
+        backing() says which one was used. Either way the memory is mapped and touched up front, so
+        the audio thread never takes a page fault on it.
+
+        Buffers are rounded up to a power of two (at least DEFAULT_AUDIO_ALIGNMENT AudioBytes) and kept
+        on per-size free lists once they're handed back, so the arena suits long-running pipelines
+        that settle into a fixed set of packet sizes - the same pattern AudioPacketPool is built around.
+        Anything the arena can't fit goes to the aligned heap instead.
+    */
+    class HugePageArena : public AudioAllocator
+    {
+    public:
+        enum Backing
+        {
+            EXPLICIT_HUGE_PAGES     = 0,
+            TRANSPARENT_HUGE_PAGES  = 1,
+            REGULAR_PAGES           = 2,
+            NO_BACKING              = 3 /*!< Mapping failed entirely, everything goes to the fallback */
+        };
+
+        /*! \param[in] arenaSize    Bytes to map, rounded up to a multiple of HUGE_PAGE_SIZE */
+        static std::shared_ptr<HugePageArena>   create(size_t arenaSize = DEFAULT_ARENA_SIZE);
+        ~HugePageArena();
+
+        size_t              alignment() const;
+        Backing             backing() const;
+        size_t              capacity() const; /*!< Bytes mapped for the arena */
+        size_t              bytesCarved() const; /*!< Bytes of the arena handed out at least once */
+        /*! \return The number of allocations that didn't fit in the arena and went to the fallback */
+        size_t              overflowAllocations() const;
+
+    protected:
+        AudioByte*          allocateBytes(size_t size);
+        void                deallocateBytes(AudioByte* memory, size_t size);
+
+    private:
+        // Freed blocks are strung together through their own first bytes
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        explicit HugePageArena(size_t arenaSize);
+
+        bool                owns(const AudioByte* memory) const;
+
+        AudioByte*                          m_base;
+        size_t                              m_capacity;
+        Backing                             m_backing;
+
+        mutable std::atomic<bool>           m_lock;
+        size_t                              m_carved;
+        std::unique_ptr<FreeBlock*[]>       m_freeLists;
+        std::atomic<size_t>                 m_overflowAllocations;
+    };
+
+}
+}
@@ -59,6 +59,11 @@ namespace Audio {
         return (m_impl && m_impl->writeToBuffer(in, filter));
     }
 
+    bool AudioCaptureDevice::writeToBuffer(const AudioPacket& in, FilterProcessor& processor)
+    {
+        return (m_impl && m_impl->writeToBuffer(in, processor));
+    }
+
     bool AudioCaptureDevice::writeToBuffer(AudioStream& in, const AbstractFilter& filter, TaskCallback* callback)
     {
         return (m_impl && m_impl->writeToBuffer(in, filter, callback));
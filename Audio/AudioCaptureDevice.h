@@ -41,6 +41,7 @@ namespace Audio {
         virtual AudioPacket readFromBuffer();
         virtual bool        readFromBuffer(AudioStream& out, TaskCallback* callback);
         virtual bool        writeToBuffer(const AudioPacket& in, const AbstractFilter& filter);
+        virtual bool        writeToBuffer(const AudioPacket& in, FilterProcessor& processor);
         virtual bool        writeToBuffer(AudioStream& in, const AbstractFilter& filter, TaskCallback* callback);
 
     };
@@ -21,12 +21,33 @@
 
 // All-in-one include header
 
+#include "AllocationAudit.h"
+#include "AudioAllocator.h"
 #include "AudioCaptureDevice.h"
 #include "AudioPlaybackDevice.h"
 #include "AudioDeviceManager.h"
 #include "AudioFormat.h"
 #include "AudioPacket.h"
+#include "AudioPacketChain.h"
+#include "AudioPacketPool.h"
+#include "AudioPacketView.h"
+#include "AudioTimestamp.h"
+#include "ElasticBuffer.h"
+#include "Interleaving.h"
+#include "LatencyTrace.h"
+#include "SampleConversion.h"
+#include "SampleSpan.h"
 #include "Filters/AbstractFilter.h"
+#include "Filters/Biquad.h"
+#include "Filters/BiquadCascade.h"
+#include "Filters/Convolution.h"
+#include "Filters/FFT.h"
+#include "Filters/FilterGraph.h"
+#include "Filters/FilterProcessor.h"
+#include "Filters/Gain.h"
+#include "Filters/Pipeline.h"
+#include "Filters/PolyphaseResampler.h"
+#include "Filters/STFT.h"
 #include "Tasks/AbstractAudioTask.h"
 #include "Tasks/TaskCallback.h"
 #include "AudioStream.h"
@@ -26,12 +26,19 @@ namespace Audio {
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // AudioFormat impl
 
+    AudioFormat::AudioFormat() : channels(0), samplesPerSecond(0), bitsPerBlock(0), bitsPerSample(0),
+        encoding(UNKNOWN_ENCODING), layout(INTERLEAVED)
+    {
+    }
+
     bool AudioFormat::operator==(const AudioFormat& other) const
     {
         return channels         == other.channels
             && samplesPerSecond == other.samplesPerSecond
             && bitsPerBlock     == other.bitsPerBlock
-            && bitsPerSample    == other.bitsPerSample;
+            && bitsPerSample    == other.bitsPerSample
+            && encodingOf(*this) == encodingOf(other)
+            && layout           == other.layout;
     }
 
     bool AudioFormat::operator!=(const AudioFormat& other) const
@@ -39,5 +46,43 @@ namespace Audio {
         return !(*this == other);
     }
 
+    SampleEncoding encodingOf(const AudioFormat& format)
+    {
+        if(format.encoding != UNKNOWN_ENCODING)
+            return format.encoding;
+
+        switch(format.bitsPerSample)
+        {
+        case 16:
+            return PCM_INT16;
+        case 24:
+            return PCM_INT24;
+        case 32:
+            return FLOAT32;
+        case 64:
+            return FLOAT64;
+        default:
+            return UNKNOWN_ENCODING;
+        }
+    }
+
+    size_t bytesPerSample(SampleEncoding encoding)
+    {
+        switch(encoding)
+        {
+        case PCM_INT16:
+            return 2;
+        case PCM_INT24:
+            return 3;
+        case PCM_INT32:
+        case FLOAT32:
+            return 4;
+        case FLOAT64:
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
 }
 }
\ No newline at end of file
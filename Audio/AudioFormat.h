@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 namespace DX {
 namespace Audio {
 
@@ -35,6 +37,37 @@ namespace Audio {
 
     typedef unsigned char AudioByte;
 
+    /*! \brief SampleEncoding says how the bits of a single sample are to be read. bitsPerSample alone
+        can't tell a 32-bit float from a 32-bit integer.
+
+        \note 24-bit samples packed in a 32-bit container (24 valid bits) are PCM_INT32 - only the
+        container matters for how samples are laid out and converted.
+    */
+    enum SampleEncoding
+    {
+        UNKNOWN_ENCODING    = 0, /*!< Not known, see encodingOf() for the best guess */
+        PCM_INT16           = 1,
+        PCM_INT24           = 2, /*!< Packed, 3 bytes per sample */
+        PCM_INT32           = 3,
+        FLOAT32             = 4,
+        FLOAT64             = 5
+    };
+
+    /*! \brief SampleLayout says how the channels of a block of audio are arranged in memory.
+
+        INTERLEAVED is what devices hand us: every frame holds one sample of each channel, back to
+        back (L R L R ...). PLANAR stores each channel as its own contiguous run of frames, one run
+        after the other (L L ... R R ...), which is what per-channel DSP wants to vectorize over.
+
+        \note Anything that indexes by frame - AudioPacket::operator[], AudioPacketView slicing - only
+        makes sense for INTERLEAVED data. Use SampleSpan (which honours the layout) for PLANAR packets.
+    */
+    enum SampleLayout
+    {
+        INTERLEAVED         = 0,
+        PLANAR              = 1
+    };
+
     /*! \brief AudioFormat is a lightweight tag structure designed to attach to things that need
         some kind of audio format information. This typically includes hardware audio devices, where
         the information is pulled from, Streams to and from devices, and AudioPackets themselves.
@@ -62,7 +95,14 @@ namespace Audio {
         unsigned int    samplesPerSecond; /*!< Frequency of sound that the AudioFormat represents */
         unsigned short  bitsPerBlock; /*!< Number of bits to align a single block to */
         unsigned int    bitsPerSample; /*!< Number of bits per sample of mono data */
+        SampleEncoding  encoding; /*!< How each sample is encoded, may be UNKNOWN_ENCODING */
+        SampleLayout    layout; /*!< How channels are arranged, INTERLEAVED for device formats */
 
+        AudioFormat(); /*!< Zero everything, UNKNOWN_ENCODING and INTERLEAVED */
+
+        /*! Formats are equal if they describe the same audio - an UNKNOWN_ENCODING compares by the
+            encoding encodingOf() guesses for it
+        */
         bool operator==(const AudioFormat& other) const;
         bool operator!=(const AudioFormat& other) const;
     };
@@ -72,5 +112,13 @@ namespace Audio {
     */
     static AudioFormat BAD_FORMAT;
 
+    /*! \return The encoding of format's samples. If format doesn't say, this is a guess from
+        bitsPerSample - 32 bits is assumed to be FLOAT32, as that's what shared mode devices mix in.
+    */
+    SampleEncoding  encodingOf(const AudioFormat& format);
+
+    /*! \return The number of AudioBytes a single sample of encoding takes up, 0 if unknown */
+    size_t          bytesPerSample(SampleEncoding encoding);
+
 }
 }
@@ -23,6 +23,7 @@
 #endif
 
 #include "AudioPacket.h"
+#include "AudioPacketPool.h"
 
 #include <assert.h>
 #include <stdexcept>
@@ -85,39 +86,53 @@ namespace Audio {
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // AudioPacket impl
 
-    AudioPacket::AudioPacket(size_t size) : m_size(size), m_maxSize(size), m_memory(nullptr)
+    AudioPacket::AudioPacket(size_t size) : m_size(size), m_maxSize(0), m_memory(nullptr)
     {
         if(m_size > 0)
-            m_memory = std::unique_ptr<AudioByte[]>(new AudioByte[m_size]);
+            allocateMemory(m_size);
     }
 
     AudioPacket::AudioPacket(const AudioFormat& format, size_t size) 
-        : m_size(size), m_maxSize(size), m_memory(nullptr), m_format(format)
+        : m_size(size), m_maxSize(0), m_memory(nullptr), m_format(format)
     {
         if(m_size > 0)
-            m_memory = std::unique_ptr<AudioByte[]>(new AudioByte[m_size]);
+            allocateMemory(m_size);
+    }
+
+    AudioPacket::AudioPacket(const AudioFormat& format, size_t size, const std::shared_ptr<AudioPacketPool>& pool)
+        : m_size(size), m_maxSize(0), m_memory(nullptr), m_format(format), m_pool(pool)
+    {
+        if(m_size > 0)
+            allocateMemory(m_size);
     }
 
     AudioPacket::AudioPacket(const AudioPacket& copy) 
-        : m_size(copy.m_size), m_maxSize(copy.m_size), m_memory(nullptr), m_format(copy.m_format)
+        : m_size(copy.m_size), m_maxSize(0), m_memory(nullptr), m_format(copy.m_format), m_pool(copy.m_pool),
+        m_timestamp(copy.m_timestamp)
     {
         assert(copy.m_size > 0);
         if(copy.m_size > 0)
         {
-            m_memory = std::unique_ptr<AudioByte[]>(new AudioByte[copy.m_size]);
+            allocateMemory(copy.m_size);
             assign(copy.m_memory.get(), copy.m_size); 
         }
         assert(m_memory.get() != nullptr);
     }
 
-    AudioPacket::AudioPacket(AudioPacket&& move) : m_size(0), m_memory(nullptr)
+    AudioPacket::AudioPacket(AudioPacket&& move) 
+        : m_size(move.m_size), m_maxSize(move.m_maxSize), m_memory(std::move(move.m_memory)), 
+        m_format(move.m_format), m_pool(std::move(move.m_pool)), m_timestamp(move.m_timestamp)
     {
-        // rely on our operator=(AudioPacket&&)
-        *this = move;
+        // Steal everything, no allocation and no copying
+        move.m_size = 0;
+        move.m_maxSize = 0;
+        move.m_format = AudioFormat();
+        move.m_timestamp = AudioTimestamp();
     }
 
     AudioPacket::~AudioPacket()
     {
+        releaseMemory();
     }
 
     AudioSample AudioPacket::operator[](size_t index)
@@ -152,6 +167,21 @@ namespace Audio {
         m_format = format;
     }
 
+    AudioTimestamp AudioPacket::getTimestamp() const
+    {
+        return m_timestamp;
+    }
+
+    void AudioPacket::setTimestamp(const AudioTimestamp& timestamp)
+    {
+        m_timestamp = timestamp;
+    }
+
+    std::shared_ptr<AudioPacketPool> AudioPacket::getPool() const
+    {
+        return m_pool;
+    }
+
     bool AudioPacket::isValid() const
     {
         // An invalid state is where we don't have any audio (nullptr) or our format isn't set
@@ -161,14 +191,18 @@ namespace Audio {
     AudioPacket& AudioPacket::operator=(const AudioPacket& copy)
     {
         assert(copy.m_size > 0);
-        // Check to see if we have to do any resizing (expensive)
-        if(copy.m_size >= m_maxSize)
+        // Check to see if we have to do any resizing (expensive). Anything that fits reuses our memory
+        if(copy.m_size > m_maxSize)
         {
-            // operator= on unique_ptr takes care of deletion for us
-            m_memory = std::unique_ptr<AudioByte[]>(new AudioByte[copy.m_size]);
-            m_size = copy.m_size;
+            releaseMemory();
+            // With no pool of our own, draw from the same one as the packet we're copying
+            if(!m_pool)
+                m_pool = copy.m_pool;
+            allocateMemory(copy.m_size);
         }
+        m_size = copy.m_size;
         m_format = copy.m_format;
+        m_timestamp = copy.m_timestamp;
         assign(copy.m_memory.get(), copy.m_size);
 
         return *this;
@@ -176,14 +210,21 @@ namespace Audio {
 
     AudioPacket& AudioPacket::operator=(AudioPacket&& move)
     {
+        if(this == &move)
+            return *this;
+
+        releaseMemory();
         m_size = move.m_size;
         m_maxSize = move.m_maxSize;
         m_format = move.m_format;
+        m_timestamp = move.m_timestamp;
         m_memory = std::move(move.m_memory);
+        m_pool = std::move(move.m_pool);
         move.m_memory = nullptr;
         move.m_size = 0;
         move.m_maxSize = 0;
         move.m_format = AudioFormat();
+        move.m_timestamp = AudioTimestamp();
         return *this;
     }
 
@@ -208,7 +249,48 @@ namespace Audio {
 
     void AudioPacket::assign(std::unique_ptr<AudioByte[]>&& data)
     {
-        m_memory = std::move(data);
+        // Whatever we're handed didn't come from our pool, so we're on our own from here on out
+        if(m_pool && m_memory)
+            m_pool->release(std::move(m_memory), m_maxSize);
+        m_pool.reset();
+        // Plain new AudioByte[] memory, so an allocator-less deleter
+        m_memory = AudioMemory(data.release(), AudioMemoryDeleter());
+    }
+
+    void AudioPacket::resize(size_t size)
+    {
+        if(size > m_maxSize)
+        {
+            // Doesn't fit, so move what we have somewhere that does
+            AudioPacket larger(m_format, size, m_pool);
+            if(m_size > 0)
+                larger.assign(m_memory.get(), m_size);
+            larger.m_timestamp = m_timestamp;
+            *this = std::move(larger);
+        }
+        m_size = size;
+    }
+
+    void AudioPacket::allocateMemory(size_t size)
+    {
+        assert(m_memory.get() == nullptr);
+        if(m_pool)
+        {
+            m_memory = m_pool->acquireStorage(size, m_maxSize);
+        }
+        else
+        {
+            m_memory = AudioAllocator::getDefault()->allocate(size);
+            m_maxSize = (m_memory ? size : 0);
+        }
+    }
+
+    void AudioPacket::releaseMemory()
+    {
+        if(m_pool && m_memory)
+            m_pool->release(std::move(m_memory), m_maxSize);
+        m_memory = nullptr;
+        m_maxSize = 0;
     }
 
     size_t AudioPacket::byteSize() const
@@ -231,22 +313,16 @@ namespace Audio {
         assert(in.isValid());
         assert(outFormat != AudioFormat());
 
-        #if defined _DEBUG || defined DEBUG
-            const unsigned int& numInSamples = in.getAudioFormat().samplesPerSecond;
-            const unsigned int& numOutSamples = outFormat.samplesPerSecond;
-
-            const unsigned int& bitsPerInSample = in.getAudioFormat().bitsPerSample / 8 * in.getAudioFormat().channels;
-            const unsigned int& bitsPerOutSample = outFormat.bitsPerSample / 8 * outFormat.channels;
-
-            const double ratio = (double(numOutSamples) / double(numInSamples)) * (double(bitsPerOutSample) / double(bitsPerInSample));
-
-            return size_t(ratio * in.byteSize());
+        const AudioFormat inFormat = in.getAudioFormat();
+        const size_t bytesPerInFrame = inFormat.bitsPerSample / 8 * inFormat.channels;
+        const size_t bytesPerOutFrame = outFormat.bitsPerSample / 8 * outFormat.channels;
+        if(bytesPerInFrame == 0 || inFormat.samplesPerSecond == 0)
+            return 0;
 
-        #else
-            return size_t(double(outFormat.samplesPerSecond)    / double(in.getAudioFormat().bitsPerSample / 8 * in.getAudioFormat().channels) 
-                        * double(outFormat.bitsPerBlock)        / double(outFormat.bitsPerSample / 8 * outFormat.channels)
-                        * double(in.byteSize()));
-        #endif
+        // Whole frames only, so whatever fills the buffer never has to deal with a partial one
+        const uint64_t numInFrames = in.byteSize() / bytesPerInFrame;
+        const uint64_t numOutFrames = numInFrames * outFormat.samplesPerSecond / inFormat.samplesPerSecond;
+        return size_t(numOutFrames) * bytesPerOutFrame;
     }
 
 }
@@ -25,13 +25,17 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 
+#include "AudioAllocator.h"
 #include "AudioFormat.h"
+#include "AudioTimestamp.h"
 
 #include <memory>
 
 namespace DX {
 namespace Audio {
 
+    class AudioPacketPool;
+
     ////////////////////////////////////////////////////////////////////////////////////////////////
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // AudioSample
@@ -78,7 +82,6 @@ namespace Audio {
     // AudioPacket
 
     // TODO: Handle endianess
-    // TODO: Think about adding some kind of framing information?
 
     /*! \brief AudioPacket is designed to hold a chunk of AudioSamples for hardware waveform IO.
         The simplest way of thinking about the class is as an array of AudioSample. AudioPackets
@@ -87,6 +90,13 @@ namespace Audio {
 
         \note operator[] and at() both return AudioSamples as opposed to pure AudioBytes. This is
         for ease of AudioFilter / DSP creation
+
+        \note AudioPackets from capture devices carry an AudioTimestamp saying where in the device's
+        stream, and when, their first frame was captured. It follows the AudioPacket through copies,
+        moves, conversions and filters.
+
+        \note AudioPacket memory comes from AudioAllocator::getDefault() (or the AudioPacketPool the
+        AudioPacket belongs to), and is aligned to DEFAULT_AUDIO_ALIGNMENT AudioBytes by default.
     */
     class AudioPacket
     {
@@ -112,9 +122,13 @@ namespace Audio {
             \note   The size represents the number of AudioBytes, not AudioSamples        
         */
         AudioPacket(const AudioFormat& format, size_t size = DEFAULT_PACKET_SIZE);
+        /*! \brief  Constructs an AudioPacket whose memory comes from, and is returned to, pool.
+            \note   Prefer AudioPacketPool::acquire() over calling this directly
+        */
+        AudioPacket(const AudioFormat& format, size_t size, const std::shared_ptr<AudioPacketPool>& pool);
         AudioPacket(const AudioPacket& copy); /*!< Performs a deep copy on another AudioPacket */
         AudioPacket(AudioPacket&& move); /*!< Transfers ownership of AudioPacket resources */
-        ~AudioPacket(); /*!< Fully destroys all resources held by the AudioPacket*/
+        ~AudioPacket(); /*!< Fully destroys all resources held by the AudioPacket, or hands them back to its pool */
   
         /*! Returns an AudioSample that holds references to memory held by this AudioPacket. Typically
             operator[] would return a T&. However, no AudioSamples are held internally by an AudioPacket,
@@ -131,6 +145,10 @@ namespace Audio {
 
         AudioFormat         getAudioFormat() const; /*!< Accessor for the AudioPacket's AudioFormat */
         void                setAudioFormat(const AudioFormat&); /*!< Mutator for the AudioPacket's AudioFormat */
+        AudioTimestamp      getTimestamp() const; /*!< Accessor for where and when the AudioPacket was captured */
+        void                setTimestamp(const AudioTimestamp&); /*!< Mutator for the AudioPacket's AudioTimestamp */
+        /*! \return The AudioPacketPool this AudioPacket's memory belongs to, nullptr if it isn't pooled */
+        std::shared_ptr<AudioPacketPool>    getPool() const;
 
         /*! \return The current number of AudioBytes that an AudioPacket thinks are valid.
         */
@@ -144,6 +162,13 @@ namespace Audio {
             an allocation
         */
         size_t              maxSize() const;
+        /*! \brief Changes the number of valid AudioBytes to size, keeping as many of the current ones as
+            fit. Only allocates (from the same pool, if any) when size is larger than maxSize().
+
+            \note This is for producers that can't know exactly how much they'll write until they have,
+            resamplers for one.
+        */
+        void                resize(size_t size);
         /*! \return A best-guess estimate of the number of AudioSamples that this AudioPacket currently contains.
 
             \note Due to the nature of AudioSamples, this method should provide reliable data, assuming no
@@ -187,10 +212,17 @@ namespace Audio {
         void                assign(std::unique_ptr<AudioByte[]>&& data);
 
     private:
-        size_t                          m_size;    
-        size_t                          m_maxSize;
-        std::unique_ptr<AudioByte[]>    m_memory;
-        AudioFormat                     m_format;
+        // Allocates at least size AudioBytes from m_pool (or the default AudioAllocator, if there's no pool), updating m_maxSize
+        void                allocateMemory(size_t size);
+        // Gives m_memory back to m_pool (or its AudioAllocator, if there's no pool)
+        void                releaseMemory();
+
+        size_t                              m_size;    
+        size_t                              m_maxSize;
+        AudioMemory                         m_memory;
+        AudioFormat                         m_format;
+        std::shared_ptr<AudioPacketPool>    m_pool;
+        AudioTimestamp                      m_timestamp;
 
     };
 
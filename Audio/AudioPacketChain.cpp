@@ -0,0 +1,184 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "AudioPacketChain.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // AudioPacketChain impl
+
+    AudioPacketChain::AudioPacketChain(size_t maxPackets)
+        : m_packets(new AudioPacket[maxPackets > 0 ? maxPackets : 1]), m_capacity(maxPackets > 0 ? maxPackets : 1),
+        m_head(0), m_count(0), m_headOffset(0), m_numFrames(0), m_bytesPerFrame(0)
+    {
+    }
+
+    AudioPacketChain::~AudioPacketChain()
+    {
+    }
+
+    bool AudioPacketChain::push(AudioPacket&& packet)
+    {
+        if(isFull())
+            return false;
+
+        const AudioFormat format = packet.getAudioFormat();
+        if(format.layout != INTERLEAVED || format.bitsPerBlock == 0)
+            return false;
+        if(m_count > 0 && format.bitsPerBlock != m_bytesPerFrame)
+            return false;
+
+        const size_t frames = packet.byteSize() / format.bitsPerBlock;
+        // Nothing worth holding on to
+        if(frames == 0)
+            return true;
+
+        if(m_count == 0)
+            m_bytesPerFrame = format.bitsPerBlock;
+
+        packetAt(m_count) = std::move(packet);
+        ++m_count;
+        m_numFrames += frames;
+        return true;
+    }
+
+    size_t AudioPacketChain::read(AudioByte* out, size_t numFrames)
+    {
+        Segment segment;
+        size_t framesRead = 0;
+        while(framesRead < numFrames && gather(&segment, 1, numFrames - framesRead) == 1)
+        {
+            std::memcpy(out + framesRead * m_bytesPerFrame, segment.data, segment.numFrames * m_bytesPerFrame);
+            consume(segment.numFrames);
+            framesRead += segment.numFrames;
+        }
+        return framesRead;
+    }
+
+    size_t AudioPacketChain::gather(Segment* segments, size_t maxSegments, size_t numFrames) const
+    {
+        size_t filled = 0;
+        size_t offset = m_headOffset;
+        for(size_t i = 0; i < m_count && filled < maxSegments && numFrames > 0; ++i)
+        {
+            const AudioPacket& packet = packetAt(i);
+            const size_t available = framesIn(packet) - offset;
+            const size_t frames = std::min(available, numFrames);
+
+            segments[filled].data = packet.data() + offset * m_bytesPerFrame;
+            segments[filled].numFrames = frames;
+            ++filled;
+
+            numFrames -= frames;
+            // Only the front packet is partially consumed
+            offset = 0;
+        }
+        return filled;
+    }
+
+    size_t AudioPacketChain::consume(size_t numFrames)
+    {
+        size_t consumed = 0;
+        while(consumed < numFrames && m_count > 0)
+        {
+            AudioPacket& front = packetAt(0);
+            const size_t available = framesIn(front) - m_headOffset;
+            const size_t frames = std::min(available, numFrames - consumed);
+            consumed += frames;
+            m_headOffset += frames;
+
+            if(frames == available)
+            {
+                // Done with it, hand the memory back right away
+                front = AudioPacket();
+                m_head = (m_head + 1) % m_capacity;
+                --m_count;
+                m_headOffset = 0;
+            }
+        }
+
+        m_numFrames -= consumed;
+        if(m_count == 0)
+            m_bytesPerFrame = 0;
+        return consumed;
+    }
+
+    void AudioPacketChain::clear()
+    {
+        consume(m_numFrames);
+    }
+
+    size_t AudioPacketChain::numFrames() const
+    {
+        return m_numFrames;
+    }
+
+    size_t AudioPacketChain::numPackets() const
+    {
+        return m_count;
+    }
+
+    size_t AudioPacketChain::bytesPerFrame() const
+    {
+        return m_bytesPerFrame;
+    }
+
+    AudioTimestamp AudioPacketChain::frontTimestamp() const
+    {
+        if(m_count == 0)
+            return AudioTimestamp();
+
+        const AudioPacket& front = packetAt(0);
+        AudioTimestamp timestamp = front.getTimestamp();
+        timestamp.devicePosition += m_headOffset;
+
+        const unsigned int sampleRate = front.getAudioFormat().samplesPerSecond;
+        if(timestamp.captureTime != 0 && sampleRate > 0)
+            timestamp.captureTime += m_headOffset * AUDIO_CLOCK_FREQUENCY / sampleRate;
+        return timestamp;
+    }
+
+    bool AudioPacketChain::isEmpty() const
+    {
+        return m_count == 0;
+    }
+
+    bool AudioPacketChain::isFull() const
+    {
+        return m_count == m_capacity;
+    }
+
+    AudioPacket& AudioPacketChain::packetAt(size_t index) const
+    {
+        return m_packets[(m_head + index) % m_capacity];
+    }
+
+    size_t AudioPacketChain::framesIn(const AudioPacket& packet) const
+    {
+        return packet.byteSize() / m_bytesPerFrame;
+    }
+
+}
+}
@@ -0,0 +1,142 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX Audio - AudioPacketChain is a frame-granular FIFO of AudioPackets, for filling device periods
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "AudioFormat.h"
+#include "AudioPacket.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // AudioPacketChain
+
+    //! Defines how many AudioPackets an AudioPacketChain can hold at once. Arbitrary for now, best results TBD
+    #ifndef DEFAULT_CHAIN_LENGTH
+        #define DEFAULT_CHAIN_LENGTH 16
+    #endif
+
+    /*! \brief AudioPacketChain strings whole AudioPackets together and hands them back out by the frame,
+        regardless of where one packet ends and the next begins.
+
+        Devices want exactly as many frames as they have room for, which almost never lines up with
+        the packets a stream produces. The chain lets a writer top up with as many packets as it takes
+        and then pull out exactly the frame count it needs: the front packet is consumed partially if
+        need be, and the rest of it goes out next time. Nothing gets dropped, and no period goes out
+        short while there's audio waiting.
+
+        AudioPackets are moved in and kept as they are - read() copies straight from them into the
+        destination (a device buffer, say), and gather() doesn't copy at all, handing back pointers
+        into the packets for a scatter-gather consumer. Packets are released (back to their pool, if
+        they have one) as soon as their last frame has been consumed. The chain itself is a fixed ring,
+        so pushing and consuming never allocate.
+
+        Every AudioPacket in a chain must be INTERLEAVED and share the same frame size.
+
+        \note An AudioPacketChain is meant for a single thread, typically the one driving a device.
+
+        \code
+        while(chain.numFrames() < freeFrames && !chain.isFull() && stream.pop(packet))
+            chain.push(std::move(packet));
+
+        const size_t framesToWrite = std::min(freeFrames, chain.numFrames());
+        chain.read(deviceBuffer, framesToWrite);
+        \endcode
+    */
+    class AudioPacketChain
+    {
+    public:
+        /*! \brief A run of contiguous frames inside one of the chain's AudioPackets */
+        struct Segment
+        {
+            const AudioByte*    data;
+            size_t              numFrames;
+        };
+
+        /*! \param[in] maxPackets   The most AudioPackets the chain will hold at once */
+        explicit AudioPacketChain(size_t maxPackets = DEFAULT_CHAIN_LENGTH);
+        ~AudioPacketChain();
+
+        /*! Appends every frame of packet to the chain.
+            \return False if the chain is full, or packet is PLANAR or doesn't match the chain's frame size
+        */
+        bool            push(AudioPacket&& packet);
+
+        /*! Copies up to numFrames frames off the front of the chain into out, consuming them.
+            \return The number of frames copied
+        */
+        size_t          read(AudioByte* out, size_t numFrames);
+
+        /*! Describes up to numFrames frames off the front of the chain as at most maxSegments
+            Segments, without consuming or copying anything. The Segments are valid until the chain
+            is next modified.
+            \return The number of Segments filled in
+        */
+        size_t          gather(Segment* segments, size_t maxSegments, size_t numFrames) const;
+
+        /*! Drops up to numFrames frames off the front of the chain.
+            \return The number of frames dropped
+        */
+        size_t          consume(size_t numFrames);
+
+        void            clear(); /*!< Drops everything */
+
+        size_t          numFrames() const; /*!< Frames waiting in the chain */
+        size_t          numPackets() const; /*!< AudioPackets (whole or partial) waiting in the chain */
+        size_t          bytesPerFrame() const; /*!< Frame size of the chain's packets, 0 while empty */
+        /*! \return The AudioTimestamp of the front packet, moved up to its first unconsumed frame.
+            A default AudioTimestamp while empty.
+        */
+        AudioTimestamp  frontTimestamp() const;
+        bool            isEmpty() const;
+        bool            isFull() const;
+
+    private:
+        AudioPacket&    packetAt(size_t index) const;
+        size_t          framesIn(const AudioPacket& packet) const;
+
+        std::unique_ptr<AudioPacket[]>  m_packets;
+        const size_t                    m_capacity;
+        size_t                          m_head;
+        size_t                          m_count;
+        size_t                          m_headOffset; // Frames already consumed from the front packet
+        size_t                          m_numFrames;
+        size_t                          m_bytesPerFrame;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        AudioPacketChain(const AudioPacketChain&);
+        AudioPacketChain(AudioPacketChain&&);
+    };
+
+}
+}
@@ -0,0 +1,191 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "AudioPacketPool.h"
+#include "AudioPacket.h"
+
+#include <assert.h>
+#include <thread>
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // AudioPacketPool impl
+
+    // Size classes run from 2^MIN_CLASS_SHIFT up to 2^(MIN_CLASS_SHIFT + NUM_SIZE_CLASSES - 1) AudioBytes
+    static const size_t MIN_CLASS_SHIFT = 6;
+    static const size_t NUM_SIZE_CLASSES = 24;
+
+    // Which size class fits size AudioBytes, NUM_SIZE_CLASSES if none of them do
+    static size_t sizeClassOf(size_t size)
+    {
+        size_t sizeClass = 0;
+        while(sizeClass < NUM_SIZE_CLASSES && (size_t(1) << (sizeClass + MIN_CLASS_SHIFT)) < size)
+            ++sizeClass;
+        return sizeClass;
+    }
+
+    static size_t capacityOf(size_t sizeClass)
+    {
+        return size_t(1) << (sizeClass + MIN_CLASS_SHIFT);
+    }
+
+    // The free lists are only ever held for a push_back or pop_back, so a plain spin is plenty
+    class SizeClassLock
+    {
+    public:
+        SizeClassLock(std::atomic<bool>& lock) : m_lock(lock)
+        {
+            while(m_lock.exchange(true, std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+
+        ~SizeClassLock()
+        {
+            m_lock.store(false, std::memory_order_release);
+        }
+
+    private:
+        std::atomic<bool>& m_lock;
+
+        SizeClassLock(const SizeClassLock&);
+        SizeClassLock& operator=(const SizeClassLock&);
+    };
+
+    AudioPacketPool::SizeClass::SizeClass() : lock(false)
+    {
+    }
+
+    std::shared_ptr<AudioPacketPool> AudioPacketPool::create(size_t maxPerClass, const std::shared_ptr<AudioAllocator>& allocator)
+    {
+        // Constructor is private, so no make_shared
+        return std::shared_ptr<AudioPacketPool>(new AudioPacketPool(maxPerClass, allocator));
+    }
+
+    AudioPacketPool::AudioPacketPool(size_t maxPerClass, const std::shared_ptr<AudioAllocator>& allocator)
+        : m_maxPerClass(maxPerClass), m_allocator(allocator ? allocator : AudioAllocator::getDefault()), m_classes(new SizeClass[NUM_SIZE_CLASSES]), m_heapAllocations(0), m_reuses(0)
+    {
+        // Reserve up front so that handing memory back never has to grow a free list
+        for(size_t i = 0; i < NUM_SIZE_CLASSES; ++i)
+            m_classes[i].free.reserve(m_maxPerClass);
+    }
+
+    AudioPacketPool::~AudioPacketPool()
+    {
+    }
+
+    AudioPacket AudioPacketPool::acquire(const AudioFormat& format, size_t size)
+    {
+        return AudioPacket(format, size, shared_from_this());
+    }
+
+    void AudioPacketPool::reserve(size_t size, size_t count)
+    {
+        const size_t sizeClass = sizeClassOf(size);
+        if(sizeClass >= NUM_SIZE_CLASSES || size == 0)
+            return;
+
+        SizeClass& bucket = m_classes[sizeClass];
+        SizeClassLock lock(bucket.lock);
+        while(bucket.free.size() < count && bucket.free.size() < m_maxPerClass)
+        {
+            AudioMemory storage = m_allocator->allocate(capacityOf(sizeClass));
+            if(!storage)
+                return;
+            bucket.free.push_back(std::move(storage));
+            ++m_heapAllocations;
+        }
+    }
+
+    AudioMemory AudioPacketPool::acquireStorage(size_t size, size_t& capacity)
+    {
+        capacity = 0;
+        if(size == 0)
+            return nullptr;
+
+        const size_t sizeClass = sizeClassOf(size);
+        if(sizeClass >= NUM_SIZE_CLASSES)
+        {
+            // Too big to be worth pooling
+            ++m_heapAllocations;
+            AudioMemory storage = m_allocator->allocate(size);
+            capacity = (storage ? size : 0);
+            return storage;
+        }
+
+        capacity = capacityOf(sizeClass);
+        SizeClass& bucket = m_classes[sizeClass];
+        {
+            SizeClassLock lock(bucket.lock);
+            if(!bucket.free.empty())
+            {
+                AudioMemory storage = std::move(bucket.free.back());
+                bucket.free.pop_back();
+                ++m_reuses;
+                return storage;
+            }
+        }
+
+        ++m_heapAllocations;
+        AudioMemory storage = m_allocator->allocate(capacity);
+        if(!storage)
+            capacity = 0;
+        return storage;
+    }
+
+    void AudioPacketPool::release(AudioMemory&& storage, size_t capacity)
+    {
+        if(!storage)
+            return;
+
+        // Only buffers that exactly match a size class came from us
+        const size_t sizeClass = sizeClassOf(capacity);
+        if(sizeClass >= NUM_SIZE_CLASSES || capacityOf(sizeClass) != capacity)
+        {
+            storage.reset();
+            return;
+        }
+
+        SizeClass& bucket = m_classes[sizeClass];
+        SizeClassLock lock(bucket.lock);
+        if(bucket.free.size() < m_maxPerClass)
+            bucket.free.push_back(std::move(storage));
+        else
+            storage.reset();
+    }
+
+    std::shared_ptr<AudioAllocator> AudioPacketPool::getAllocator() const
+    {
+        return m_allocator;
+    }
+
+    size_t AudioPacketPool::heapAllocations() const
+    {
+        return m_heapAllocations;
+    }
+
+    size_t AudioPacketPool::reuses() const
+    {
+        return m_reuses;
+    }
+
+}
+}
@@ -0,0 +1,136 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX Audio - AudioPacketPool recycles AudioPacket memory so steady-state streaming never allocates
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "AudioAllocator.h"
+#include "AudioFormat.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace DX {
+namespace Audio {
+
+    class AudioPacket;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // AudioPacketPool
+
+    //! Defines how many free buffers each size class holds on to before giving memory back
+    #ifndef DEFAULT_POOL_DEPTH
+        #define DEFAULT_POOL_DEPTH 32
+    #endif
+
+    /*! \brief AudioPacketPool hands out AudioPackets whose memory goes back to the pool, instead of
+        being freed, when the AudioPacket is destroyed.
+
+        Buffers are grouped into power-of-two size classes. Acquiring a packet takes a free buffer
+        from the smallest class that fits (allocating one only if that class is empty), so once a
+        stream has warmed up and every packet size it uses has been seen, capturing, filtering and
+        playing back audio no longer touches the heap.
+
+        Pooled AudioPackets keep their pool alive, so AudioPackets may safely outlive whoever
+        created the pool. Acquiring and releasing are thread safe - a capture thread can acquire
+        packets that a playback thread later releases.
+
+        \note AudioPacketPools can only be created through create(), as AudioPackets need shared
+        ownership of them.
+
+        \code
+        std::shared_ptr<AudioPacketPool> pool = AudioPacketPool::create();
+
+        void capture(AudioStream& out, const AudioFormat& format, const AudioByte* data, size_t numBytes)
+        {
+            AudioPacket packet = pool->acquire(format, numBytes);
+            packet.assign(data, numBytes);
+            out.push(std::move(packet));
+        }
+        \endcode
+    */
+    class AudioPacketPool : public std::enable_shared_from_this<AudioPacketPool>
+    {
+    public:
+        /*! \param[in] maxPerClass  The number of free buffers kept around for each size class
+            \param[in] allocator    Where the pool's buffers come from, AudioAllocator::getDefault() if nullptr
+        */
+        static std::shared_ptr<AudioPacketPool> create(size_t maxPerClass = DEFAULT_POOL_DEPTH,
+                                                    const std::shared_ptr<AudioAllocator>& allocator = nullptr);
+        ~AudioPacketPool();
+
+        /*! \return An AudioPacket of size AudioBytes whose memory will be returned to this pool */
+        AudioPacket                     acquire(const AudioFormat& format, size_t size);
+
+        /*! Allocates up to count buffers big enough for size AudioBytes ahead of time, so the first
+            packets of a stream don't have to
+        */
+        void                            reserve(size_t size, size_t count);
+
+        /*! \brief Takes a buffer of at least size AudioBytes out of the pool.
+            \param[out] capacity    The real size of the returned buffer
+            \note This is largely for AudioPacket's internal use.
+        */
+        AudioMemory                     acquireStorage(size_t size, size_t& capacity);
+        /*! \brief Hands a buffer that came from acquireStorage() back to the pool.
+            \note This is largely for AudioPacket's internal use.
+        */
+        void                            release(AudioMemory&& storage, size_t capacity);
+
+        /*! \return The AudioAllocator the pool's buffers come from */
+        std::shared_ptr<AudioAllocator> getAllocator() const;
+        /*! \return The number of buffers the pool has had to allocate */
+        size_t                          heapAllocations() const;
+        /*! \return The number of buffers that were handed out again instead of being allocated */
+        size_t                          reuses() const;
+
+    private:
+        struct SizeClass
+        {
+            SizeClass();
+
+            std::atomic<bool>           lock;
+            std::vector<AudioMemory>    free;
+        };
+
+        AudioPacketPool(size_t maxPerClass, const std::shared_ptr<AudioAllocator>& allocator);
+
+        const size_t                    m_maxPerClass;
+        std::shared_ptr<AudioAllocator> m_allocator;
+        std::unique_ptr<SizeClass[]>    m_classes;
+        std::atomic<size_t>             m_heapAllocations;
+        std::atomic<size_t>             m_reuses;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        AudioPacketPool(const AudioPacketPool&);
+        AudioPacketPool(AudioPacketPool&&);
+    };
+
+}
+}
@@ -0,0 +1,203 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "AudioPacketView.h"
+#include "AudioPacketPool.h"
+
+#include <algorithm>
+#include <assert.h>
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // AudioPacketView impl
+
+    static size_t framesIn(const AudioPacket& packet)
+    {
+        const size_t bytesPerFrame = packet.getAudioFormat().bitsPerBlock;
+        return (bytesPerFrame > 0 ? packet.byteSize() / bytesPerFrame : 0);
+    }
+
+    AudioPacketView::AudioPacketView() : m_packet(nullptr), m_frameOffset(0), m_numFrames(0), m_readOnly(false)
+    {
+    }
+
+    AudioPacketView::AudioPacketView(AudioPacket&& packet)
+        : m_packet(std::make_shared<AudioPacket>(std::move(packet))), m_frameOffset(0), m_numFrames(0),
+        m_readOnly(false)
+    {
+        m_numFrames = framesIn(*m_packet);
+    }
+
+    AudioPacketView::AudioPacketView(const std::shared_ptr<const AudioPacket>& packet)
+        : m_packet(std::const_pointer_cast<AudioPacket>(packet)), m_frameOffset(0), m_numFrames(0),
+        m_readOnly(true)
+    {
+        if(m_packet)
+            m_numFrames = framesIn(*m_packet);
+    }
+
+    AudioPacketView::AudioPacketView(const AudioPacketView& copy)
+        : m_packet(copy.m_packet), m_frameOffset(copy.m_frameOffset), m_numFrames(copy.m_numFrames),
+        m_readOnly(copy.m_readOnly)
+    {
+    }
+
+    AudioPacketView::AudioPacketView(AudioPacketView&& move)
+        : m_packet(std::move(move.m_packet)), m_frameOffset(move.m_frameOffset), m_numFrames(move.m_numFrames),
+        m_readOnly(move.m_readOnly)
+    {
+        move.m_frameOffset = 0;
+        move.m_numFrames = 0;
+        move.m_readOnly = false;
+    }
+
+    AudioPacketView::~AudioPacketView()
+    {
+    }
+
+    AudioPacketView& AudioPacketView::operator=(const AudioPacketView& copy)
+    {
+        m_packet = copy.m_packet;
+        m_frameOffset = copy.m_frameOffset;
+        m_numFrames = copy.m_numFrames;
+        m_readOnly = copy.m_readOnly;
+        return *this;
+    }
+
+    AudioPacketView& AudioPacketView::operator=(AudioPacketView&& move)
+    {
+        if(this == &move)
+            return *this;
+
+        m_packet = std::move(move.m_packet);
+        m_frameOffset = move.m_frameOffset;
+        m_numFrames = move.m_numFrames;
+        m_readOnly = move.m_readOnly;
+        move.m_frameOffset = 0;
+        move.m_numFrames = 0;
+        move.m_readOnly = false;
+        return *this;
+    }
+
+    AudioPacketView AudioPacketView::slice(size_t frameOffset, size_t numFrames) const
+    {
+        AudioPacketView ret(*this);
+        const size_t offset = std::min(frameOffset, m_numFrames);
+        ret.m_frameOffset = m_frameOffset + offset;
+        ret.m_numFrames = std::min(numFrames, m_numFrames - offset);
+        return ret;
+    }
+
+    AudioFormat AudioPacketView::getAudioFormat() const
+    {
+        return (m_packet ? m_packet->getAudioFormat() : AudioFormat());
+    }
+
+    size_t AudioPacketView::numFrames() const
+    {
+        return m_numFrames;
+    }
+
+    size_t AudioPacketView::byteSize() const
+    {
+        return m_numFrames * bytesPerFrame();
+    }
+
+    bool AudioPacketView::isValid() const
+    {
+        return (m_packet && m_packet->isValid() && m_numFrames > 0);
+    }
+
+    bool AudioPacketView::isUnique() const
+    {
+        return m_packet.use_count() == 1;
+    }
+
+    const AudioByte* AudioPacketView::data() const
+    {
+        if(!m_packet || m_packet->data() == nullptr)
+            return nullptr;
+        return m_packet->data() + m_frameOffset * bytesPerFrame();
+    }
+
+    AudioByte* AudioPacketView::mutableData()
+    {
+        if(!m_packet || m_packet->data() == nullptr)
+            return nullptr;
+
+        /*
+            Nobody else can be holding onto our packet if we're the only reference, and nobody can
+            start to without copying us first - so writing in place is safe. Unless it was handed to
+            us as const, when whoever did may still be looking at it.
+        */
+        if(m_readOnly || m_packet.use_count() != 1)
+        {
+            std::shared_ptr<AudioPacket> detached;
+            const std::shared_ptr<AudioPacketPool> pool = m_packet->getPool();
+            if(pool)
+                detached = std::make_shared<AudioPacket>(pool->acquire(m_packet->getAudioFormat(), byteSize()));
+            else
+                detached = std::make_shared<AudioPacket>(m_packet->getAudioFormat(), byteSize());
+
+            if(byteSize() > 0)
+                detached->assign(data(), byteSize());
+            detached->setTimestamp(timestamp());
+            m_packet = std::move(detached);
+            m_frameOffset = 0;
+            m_readOnly = false;
+        }
+
+        return m_packet->data() + m_frameOffset * bytesPerFrame();
+    }
+
+    AudioPacket AudioPacketView::toPacket() const
+    {
+        if(!m_packet)
+            return AudioPacket();
+
+        const std::shared_ptr<AudioPacketPool> pool = m_packet->getPool();
+        AudioPacket ret = (pool ? pool->acquire(m_packet->getAudioFormat(), byteSize())
+            : AudioPacket(m_packet->getAudioFormat(), byteSize()));
+        if(byteSize() > 0)
+            ret.assign(data(), byteSize());
+        ret.setTimestamp(timestamp());
+        return ret;
+    }
+
+    size_t AudioPacketView::bytesPerFrame() const
+    {
+        return (m_packet ? m_packet->getAudioFormat().bitsPerBlock : 0);
+    }
+
+    AudioTimestamp AudioPacketView::timestamp() const
+    {
+        AudioTimestamp ret = m_packet->getTimestamp();
+        ret.devicePosition += m_frameOffset;
+
+        const unsigned int sampleRate = m_packet->getAudioFormat().samplesPerSecond;
+        if(ret.captureTime != 0 && sampleRate > 0)
+            ret.captureTime += m_frameOffset * AUDIO_CLOCK_FREQUENCY / sampleRate;
+        return ret;
+    }
+
+}
+}
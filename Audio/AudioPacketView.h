@@ -0,0 +1,121 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX Audio - AudioPacketView is a cheap, shareable window onto the frames of an AudioPacket
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "AudioFormat.h"
+#include "AudioPacket.h"
+
+#include <memory>
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // AudioPacketView
+
+    /*! \brief AudioPacketView shares ownership of an immutable AudioPacket and looks at some range of
+        its frames. Copying or slicing a view only bumps a reference count - the audio itself is
+        never copied - so one captured packet can be handed to any number of consumers, or cut up into
+        device-period sized chunks, for free.
+
+        The underlying AudioPacket stays alive (and, if it was pooled, out of its AudioPacketPool)
+        until the last view onto it is gone.
+
+        Views are read-only until mutableData() is called. If the view is the only one left looking at
+        its AudioPacket, mutableData() writes straight into it. Otherwise the view's frames are first
+        copied into an AudioPacket of its own (copy-on-write), so no other view ever sees the change.
+        Views onto a packet handed over as const always copy, as the caller may still be reading it.
+        Copies carry the packet's AudioTimestamp, moved along to the view's first frame.
+
+        \note A frame is one AudioSample across every channel, AudioFormat::bitsPerBlock AudioBytes.
+
+        \code
+        AudioPacketView captured(std::move(packet));
+
+        // Every consumer taking an AudioPacketView gets the same memory
+        meter(captured);
+        recorder(captured);
+
+        // Chunk it up for a device that wants periodFrames at a time
+        for(size_t frame = 0; frame < captured.numFrames(); frame += periodFrames)
+            playback(captured.slice(frame, periodFrames));
+
+        // An AudioStream carries AudioPackets, so the view's frames are copied into one
+        stream.push(captured.toPacket());
+        \endcode
+    */
+    class AudioPacketView
+    {
+    public:
+        AudioPacketView(); /*!< Constructs an empty view, isValid() will be false */
+        /*! Takes ownership of packet and views every frame of it */
+        explicit AudioPacketView(AudioPacket&& packet);
+        /*! Views every frame of an already shared packet, which mutableData() never writes to */
+        explicit AudioPacketView(const std::shared_ptr<const AudioPacket>& packet);
+        AudioPacketView(const AudioPacketView& copy); /*!< Shares copy's packet, no AudioBytes are copied */
+        AudioPacketView(AudioPacketView&& move);
+        ~AudioPacketView();
+
+        AudioPacketView&    operator=(const AudioPacketView& copy);
+        AudioPacketView&    operator=(AudioPacketView&& move);
+
+        /*! \return A view of numFrames frames starting frameOffset frames into this view. The range is
+            clamped to this view, so slicing past the end yields a shorter (or empty) view.
+        */
+        AudioPacketView     slice(size_t frameOffset, size_t numFrames) const;
+
+        AudioFormat         getAudioFormat() const;
+        size_t              numFrames() const; /*!< Number of frames the view covers */
+        size_t              byteSize() const; /*!< Number of AudioBytes the view covers */
+        /*! \return True if the view is looking at a valid AudioPacket and covers at least one frame */
+        bool                isValid() const;
+        /*! \return True if no other view shares this view's AudioPacket */
+        bool                isUnique() const;
+
+        /*! \return A read-only pointer to the first AudioByte of the view */
+        const AudioByte*    data() const;
+        /*! \return A writable pointer to the first AudioByte of the view, copying the view's frames
+            out first if its AudioPacket is shared or was handed over as const
+        */
+        AudioByte*          mutableData();
+
+        /*! \return A standalone AudioPacket holding a copy of the view's frames, for APIs that need one */
+        AudioPacket         toPacket() const;
+
+    private:
+        size_t              bytesPerFrame() const;
+        AudioTimestamp      timestamp() const; // The packet's, moved along to the view's first frame
+
+        // Only ever const to the outside world, non-const so that unique views can write in place
+        std::shared_ptr<AudioPacket>    m_packet;
+        size_t                          m_frameOffset;
+        size_t                          m_numFrames;
+        bool                            m_readOnly; // Viewing a packet handed over as const
+    };
+
+}
+}
@@ -47,6 +47,11 @@ namespace Audio {
         return (m_impl && m_impl->writeToBuffer(in, filter));
     }
 
+    bool AudioPlaybackDevice::writeToBuffer(const AudioPacket& in, FilterProcessor& processor)
+    {
+        return (m_impl && m_impl->writeToBuffer(in, processor));
+    }
+
     bool AudioPlaybackDevice::writeToBuffer(AudioStream& in, const AbstractFilter& filter, TaskCallback* callback)
     {
         return (m_impl && m_impl->writeToBuffer(in, filter, callback));
@@ -39,6 +39,7 @@ namespace Audio {
         virtual bool        isPlaybackDevice() const;
 
         virtual bool        writeToBuffer(const AudioPacket& in, const AbstractFilter& filter);
+        virtual bool        writeToBuffer(const AudioPacket& in, FilterProcessor& processor);
         virtual bool        writeToBuffer(AudioStream& in, const AbstractFilter& filter, TaskCallback* callback = nullptr);
 
         virtual AudioPacket readFromBuffer();
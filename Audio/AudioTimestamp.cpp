@@ -0,0 +1,88 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "AudioTimestamp.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <chrono>
+#endif
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // AudioTimestamp impl
+
+    AudioTimestamp::AudioTimestamp() : devicePosition(0), captureTime(0), flags(NO_PACKET_FLAGS),
+        enqueueTime(0), filteredTime(0)
+    {
+    }
+
+    bool AudioTimestamp::hasFlag(PacketFlags flag) const
+    {
+        return (flags & flag) != 0;
+    }
+
+    bool AudioTimestamp::isValid() const
+    {
+        return hasFlag(TIMESTAMP_VALID) && !hasFlag(TIMESTAMP_ERROR);
+    }
+
+#ifdef WIN32
+    static uint64_t queryPerformanceFrequency()
+    {
+        LARGE_INTEGER value;
+        QueryPerformanceFrequency(&value);
+        return static_cast<uint64_t>(value.QuadPart);
+    }
+
+    /*
+        Read once, before main(). A function static would be set up on first use, which VS2013 doesn't
+        guard - the capture and playback threads could both get there first, and one see it still 0
+    */
+    static const uint64_t s_performanceFrequency = queryPerformanceFrequency();
+#endif
+
+    uint64_t audioClockNow()
+    {
+    #ifdef WIN32
+        // Still 0 if another static initializer gets here first
+        const uint64_t frequency = (s_performanceFrequency != 0 ? s_performanceFrequency : queryPerformanceFrequency());
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        const uint64_t ticks = static_cast<uint64_t>(counter.QuadPart);
+        // Split up so the multiply can't overflow
+        return (ticks / frequency) * AUDIO_CLOCK_FREQUENCY + (ticks % frequency) * AUDIO_CLOCK_FREQUENCY / frequency;
+    #else
+        const std::chrono::steady_clock::duration sinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch).count())
+            / (1000000000ULL / AUDIO_CLOCK_FREQUENCY);
+    #endif
+    }
+
+    double audioClockSeconds(int64_t ticks)
+    {
+        return static_cast<double>(ticks) / AUDIO_CLOCK_FREQUENCY;
+    }
+
+}
+}
@@ -0,0 +1,85 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX Audio - AudioTimestamp records where in a device's stream, and when, audio was captured
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+
+namespace DX {
+namespace Audio {
+
+    //! Ticks per second of the audio clock - 100 nanosecond units, same as WASAPI reports them in
+    #ifndef AUDIO_CLOCK_FREQUENCY
+        #define AUDIO_CLOCK_FREQUENCY 10000000ULL
+    #endif
+
+    /*! \brief PacketFlags describe anything unusual about the audio in an AudioPacket. They can be
+        combined.
+    */
+    enum PacketFlags
+    {
+        NO_PACKET_FLAGS     = 0,
+        DISCONTINUITY       = 1 << 0, /*!< Audio before this packet went missing, a glitch */
+        SILENT              = 1 << 1, /*!< The device said to treat the packet as silence */
+        TIMESTAMP_ERROR     = 1 << 2, /*!< The device couldn't say when the packet was captured */
+        TIMESTAMP_VALID     = 1 << 3  /*!< devicePosition and captureTime were filled in by a device */
+    };
+
+    /*! \brief AudioTimestamp is a lightweight tag structure, much like AudioFormat, that travels with
+        an AudioPacket and says where it came from.
+
+        Capture devices stamp every packet with the stream position of its first frame and the time
+        that frame was captured, straight from the device. Those two numbers are what it takes to
+        measure end-to-end latency (compare captureTime to audioClockNow() when the packet is played)
+        and clock drift (compare how fast devicePosition advances against captureTime) while running.
+
+        Copying or moving an AudioPacket carries its AudioTimestamp along, as do layout and encoding
+        conversions and the filter path of playback devices. A default AudioTimestamp has no flags
+        and no TIMESTAMP_VALID, which is what packets that never came from a device carry.
+    */
+    struct AudioTimestamp
+    {
+        uint64_t        devicePosition; /*!< Frame position of the packet's first frame in the device's stream */
+        uint64_t        captureTime; /*!< When the first frame was captured, in audio clock ticks */
+        unsigned int    flags; /*!< PacketFlags, or'ed together */
+        uint64_t        enqueueTime; /*!< When the packet was pushed onto an AudioStream, 0 if untraced (see LatencyTrace) */
+        uint64_t        filteredTime; /*!< When a playback device finished filtering the packet, 0 if untraced */
+
+        AudioTimestamp();
+
+        bool            hasFlag(PacketFlags flag) const;
+        bool            isValid() const; /*!< True if TIMESTAMP_VALID is set and TIMESTAMP_ERROR isn't */
+    };
+
+    /*! \return The current time on the audio clock, in AUDIO_CLOCK_FREQUENCY ticks per second. On
+        WIN32 this is QueryPerformanceCounter, the same clock WASAPI capture timestamps use.
+    */
+    uint64_t    audioClockNow();
+
+    /*! \return ticks of the audio clock, in seconds */
+    double      audioClockSeconds(int64_t ticks);
+
+}
+}
@@ -0,0 +1,294 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ElasticBuffer.h"
+#include "SampleConversion.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // ElasticBuffer impl
+
+    //! Floats of scratch space pull() converts through, on the stack. Arbitrary for now, best results TBD
+    #ifndef ELASTIC_SCRATCH_SAMPLES
+        #define ELASTIC_SCRATCH_SAMPLES 1024
+    #endif
+
+    // Cubic Hermite interpolation needs two frames either side of the output position
+    static const size_t INTERPOLATION_TAPS = 4;
+
+    static size_t ringSize(size_t targetFrames, size_t capacityFrames)
+    {
+        const size_t minimum = targetFrames * 2 + INTERPOLATION_TAPS;
+        return capacityFrames >= minimum ? capacityFrames : targetFrames * 4 + INTERPOLATION_TAPS;
+    }
+
+    static double nominalRatio(const AudioFormat& inFormat, const AudioFormat& outFormat)
+    {
+        if(inFormat.samplesPerSecond == 0 || outFormat.samplesPerSecond == 0)
+            return 1.0;
+        return static_cast<double>(inFormat.samplesPerSecond) / outFormat.samplesPerSecond;
+    }
+
+    static inline float hermite(float x0, float x1, float x2, float x3, float t)
+    {
+        const float c1 = 0.5f * (x2 - x0);
+        const float c2 = x0 - 2.5f * x1 + 2.0f * x2 - 0.5f * x3;
+        const float c3 = 0.5f * (x3 - x0) + 1.5f * (x1 - x2);
+        return ((c3 * t + c2) * t + c1) * t + x1;
+    }
+
+    ElasticBuffer::ElasticBuffer(const AudioFormat& inFormat, const AudioFormat& outFormat,
+        size_t targetFrames, size_t capacityFrames)
+        : m_inFormat(inFormat), m_outFormat(outFormat), m_inEncoding(encodingOf(inFormat)),
+        m_outEncoding(encodingOf(outFormat)),
+        m_channels(inFormat.channels == outFormat.channels ? inFormat.channels : 0), // 0 refuses every packet
+        m_target(targetFrames > 0 ? targetFrames : 1),
+        m_capacity(ringSize(targetFrames > 0 ? targetFrames : 1, capacityFrames)),
+        m_nominalRatio(nominalRatio(inFormat, outFormat)),
+        m_ring(new float[m_capacity * m_channels]()),
+        m_writeIndex(0), m_overruns(0), m_framesDropped(0), m_framesIn(0), m_dropped(false),
+        m_readIndex(0), m_underruns(0), m_framesOut(0), m_driftPpm(0.0), m_correctionPpm(0.0),
+        m_phase(0.0), m_ratio(m_nominalRatio), m_smoothedFill(0.0), m_integral(0.0), m_primed(false)
+    {
+    }
+
+    ElasticBuffer::~ElasticBuffer()
+    {
+    }
+
+    bool ElasticBuffer::push(const AudioPacket& packet)
+    {
+        const AudioFormat format = packet.getAudioFormat();
+        // Frames are converted as runs of m_channels samples, so they have to be exactly that wide
+        if(format != m_inFormat || format.layout != INTERLEAVED || m_inEncoding == UNKNOWN_ENCODING
+            || m_channels == 0 || format.channels != m_channels
+            || format.bitsPerBlock != m_channels * bytesPerSample(m_inEncoding))
+            return false;
+
+        const size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+        const size_t readIndex = m_readIndex.load(std::memory_order_acquire);
+        const size_t space = m_capacity - (writeIndex - readIndex);
+
+        size_t frames = packet.byteSize() / format.bitsPerBlock;
+        if(frames > space)
+        {
+            ++m_overruns;
+            m_framesDropped += frames - space;
+            m_dropped.store(true, std::memory_order_relaxed);
+            frames = space;
+        }
+        if(frames == 0)
+            return true;
+
+        // At most two runs, either side of the end of the ring
+        const size_t start = writeIndex % m_capacity;
+        const size_t firstRun = std::min(frames, m_capacity - start);
+        SampleConversion::convert(packet.data(), m_inEncoding, &m_ring[start * m_channels], FLOAT32,
+            firstRun * m_channels);
+        if(firstRun < frames)
+            SampleConversion::convert(packet.data() + firstRun * format.bitsPerBlock, m_inEncoding,
+                &m_ring[0], FLOAT32, (frames - firstRun) * m_channels);
+
+        m_writeIndex.store(writeIndex + frames, std::memory_order_release);
+        m_framesIn += frames;
+        return true;
+    }
+
+    size_t ElasticBuffer::pull(AudioPacket& packet)
+    {
+        const AudioFormat format = packet.getAudioFormat();
+        if(format != m_outFormat || format.layout != INTERLEAVED || m_outEncoding == UNKNOWN_ENCODING
+            || m_channels == 0 || m_channels > ELASTIC_SCRATCH_SAMPLES || format.channels != m_channels
+            || format.bitsPerBlock != m_channels * bytesPerSample(m_outEncoding))
+            return 0;
+
+        const size_t frames = packet.byteSize() / format.bitsPerBlock;
+        size_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+        size_t available = m_writeIndex.load(std::memory_order_acquire) - readIndex;
+
+        if(!m_primed && available >= m_target)
+        {
+            m_primed = true;
+            m_phase = 0.0;
+            m_smoothedFill = static_cast<double>(available);
+        }
+        if(m_primed)
+            updateController(available);
+
+        float scratch[ELASTIC_SCRATCH_SAMPLES];
+        const size_t chunkFrames = ELASTIC_SCRATCH_SAMPLES / m_channels;
+        size_t produced = 0;
+        size_t fromCapture = 0;
+        bool discontinuity = m_dropped.exchange(false, std::memory_order_relaxed);
+        while(produced < frames)
+        {
+            const size_t numFrames = std::min(chunkFrames, frames - produced);
+            size_t made = 0;
+            if(m_primed)
+            {
+                size_t consumed = 0;
+                made = resample(scratch, numFrames, readIndex, available, consumed);
+                readIndex += consumed;
+                available -= consumed;
+                // Hand the space back to the writer a chunk at a time
+                m_readIndex.store(readIndex, std::memory_order_release);
+
+                if(made < numFrames)
+                {
+                    // Play silence until the target has built back up
+                    m_primed = false;
+                    ++m_underruns;
+                }
+            }
+
+            std::memset(scratch + made * m_channels, 0, (numFrames - made) * m_channels * sizeof(float));
+            SampleConversion::convert(scratch, FLOAT32, packet.data() + produced * format.bitsPerBlock,
+                m_outEncoding, numFrames * m_channels);
+
+            discontinuity |= made < numFrames;
+            fromCapture += made;
+            produced += numFrames;
+        }
+
+        AudioTimestamp timestamp;
+        timestamp.devicePosition = m_framesOut;
+        timestamp.flags = discontinuity ? DISCONTINUITY : NO_PACKET_FLAGS;
+        packet.setTimestamp(timestamp);
+
+        m_framesOut += frames;
+        return fromCapture;
+    }
+
+    void ElasticBuffer::reset()
+    {
+        m_writeIndex = 0;
+        m_readIndex = 0;
+        m_overruns = 0;
+        m_framesDropped = 0;
+        m_framesIn = 0;
+        m_dropped = false;
+        m_underruns = 0;
+        m_framesOut = 0;
+        m_driftPpm = 0.0;
+        m_correctionPpm = 0.0;
+        m_phase = 0.0;
+        m_ratio = m_nominalRatio;
+        m_smoothedFill = 0.0;
+        m_integral = 0.0;
+        m_primed = false;
+    }
+
+    bool ElasticBuffer::isValid() const
+    {
+        return m_channels > 0;
+    }
+
+    size_t ElasticBuffer::targetFrames() const
+    {
+        return m_target;
+    }
+
+    size_t ElasticBuffer::capacityFrames() const
+    {
+        return m_capacity;
+    }
+
+    size_t ElasticBuffer::latencyFrames() const
+    {
+        const size_t readIndex = m_readIndex.load(std::memory_order_acquire);
+        return m_writeIndex.load(std::memory_order_acquire) - readIndex;
+    }
+
+    ElasticBuffer::Statistics ElasticBuffer::stats() const
+    {
+        Statistics stats;
+        stats.latencyFrames = latencyFrames();
+        stats.latencySeconds = m_inFormat.samplesPerSecond > 0
+            ? static_cast<double>(stats.latencyFrames) / m_inFormat.samplesPerSecond : 0.0;
+        stats.driftPpm = m_driftPpm.load(std::memory_order_relaxed);
+        stats.correctionPpm = m_correctionPpm.load(std::memory_order_relaxed);
+        stats.underruns = m_underruns;
+        stats.overruns = m_overruns;
+        stats.framesDropped = m_framesDropped;
+        stats.framesIn = m_framesIn;
+        stats.framesOut = m_framesOut;
+        return stats;
+    }
+
+    void ElasticBuffer::updateController(size_t fill)
+    {
+        /*
+            The smoothed fill level hides the sawtooth of packets arriving in bursts; its distance from
+            the target, as a fraction of the target, is the error. The integral term is what ends up
+            cancelling the clock drift, so it is also the drift estimate. It is clamped to what the
+            correction can actually use so it can't wind up during long underruns or overruns.
+        */
+        m_smoothedFill += DEFAULT_ELASTIC_SMOOTHING * (static_cast<double>(fill) - m_smoothedFill);
+        const double error = (m_smoothedFill - static_cast<double>(m_target)) / static_cast<double>(m_target);
+
+        const double maxIntegral = DEFAULT_ELASTIC_MAX_CORRECTION / DEFAULT_ELASTIC_INTEGRAL_GAIN;
+        m_integral = std::max(-maxIntegral, std::min(maxIntegral, m_integral + error));
+
+        const double drift = DEFAULT_ELASTIC_INTEGRAL_GAIN * m_integral;
+        const double correction = std::max(-DEFAULT_ELASTIC_MAX_CORRECTION,
+            std::min(DEFAULT_ELASTIC_MAX_CORRECTION, DEFAULT_ELASTIC_PROPORTIONAL_GAIN * error + drift));
+
+        m_ratio = m_nominalRatio * (1.0 + correction);
+        m_driftPpm.store(drift * 1e6, std::memory_order_relaxed);
+        m_correctionPpm.store(correction * 1e6, std::memory_order_relaxed);
+    }
+
+    size_t ElasticBuffer::resample(float* out, size_t numFrames, size_t readIndex, size_t available,
+        size_t& consumed)
+    {
+        size_t made = 0;
+        double phase = m_phase;
+        while(made < numFrames)
+        {
+            const size_t base = static_cast<size_t>(phase);
+            if(base + INTERPOLATION_TAPS > available)
+                break;
+
+            const float t = static_cast<float>(phase - static_cast<double>(base));
+            const float* x0 = &m_ring[((readIndex + base) % m_capacity) * m_channels];
+            const float* x1 = &m_ring[((readIndex + base + 1) % m_capacity) * m_channels];
+            const float* x2 = &m_ring[((readIndex + base + 2) % m_capacity) * m_channels];
+            const float* x3 = &m_ring[((readIndex + base + 3) % m_capacity) * m_channels];
+            for(size_t channel = 0; channel < m_channels; ++channel)
+                out[channel] = hermite(x0[channel], x1[channel], x2[channel], x3[channel], t);
+
+            out += m_channels;
+            ++made;
+            phase += m_ratio;
+        }
+
+        // Whole frames behind the position are done with; keep the fraction for next time
+        consumed = std::min(static_cast<size_t>(phase), available);
+        m_phase = phase - static_cast<double>(consumed);
+        return made;
+    }
+
+}
+}
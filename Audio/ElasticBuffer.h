@@ -0,0 +1,207 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX Audio - ElasticBuffer absorbs clock drift between a capture device and a playback device
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "AudioFormat.h"
+#include "AudioPacket.h"
+
+#include <LockFree/CacheLine.h>
+//#include <DX/LockFree/CacheLine.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // ElasticBuffer
+
+    //! Defines how far (as a fraction) an ElasticBuffer may bend its resampling ratio. Arbitrary for now, best results TBD
+    #ifndef DEFAULT_ELASTIC_MAX_CORRECTION
+        #define DEFAULT_ELASTIC_MAX_CORRECTION 0.001
+    #endif
+
+    //! Defines the proportional gain of an ElasticBuffer's fill controller. Arbitrary for now, best results TBD
+    #ifndef DEFAULT_ELASTIC_PROPORTIONAL_GAIN
+        #define DEFAULT_ELASTIC_PROPORTIONAL_GAIN 0.001
+    #endif
+
+    //! Defines the integral gain of an ElasticBuffer's fill controller. Arbitrary for now, best results TBD
+    #ifndef DEFAULT_ELASTIC_INTEGRAL_GAIN
+        #define DEFAULT_ELASTIC_INTEGRAL_GAIN 0.000002
+    #endif
+
+    //! Defines how quickly an ElasticBuffer's smoothed fill level follows the real one, per pull. Arbitrary for now, best results TBD
+    #ifndef DEFAULT_ELASTIC_SMOOTHING
+        #define DEFAULT_ELASTIC_SMOOTHING 0.02
+    #endif
+
+    /*! \brief ElasticBuffer sits between a capture device and a playback device and keeps the
+        latency between them constant, even though the two run off different clocks.
+
+        Two devices that both claim 48 KHz never quite agree - one will be a few dozen parts per
+        million faster than the other. Through a plain AudioStream that shows up, hours in, as either
+        an ever-growing queue or a steady stream of underruns. An ElasticBuffer holds a configurable
+        target number of frames instead, and watches how far its (smoothed) fill level is from that
+        target every time frames are pulled out. A PI controller turns the error into a tiny
+        correction of the resampling ratio, at most DEFAULT_ELASTIC_MAX_CORRECTION either way, so the
+        reader consumes captured frames just a little faster or slower than it plays them. The
+        integral term settles on the actual drift between the clocks, which is reported as driftPpm.
+
+        The same resampling covers devices running at different nominal rates (44.1 KHz capture into
+        48 KHz playback, say) - the correction is applied on top of the nominal ratio. Resampling is
+        4-point cubic Hermite interpolation, which is plenty for ratios this close to fixed.
+
+        Frames are held as FLOAT32 in a fixed ring sized up front; captured packets of any known
+        encoding are converted on the way in, and pulled packets are converted to their own encoding
+        on the way out. Neither side allocates, and memory stays flat however long it runs. Until the
+        ring first reaches its target, and again after an underrun, pull() hands out silence so the
+        fill level can build back up rather than stuttering.
+
+        If the writer gets so far ahead that the ring is full, the newest frames are dropped and
+        counted as overruns.
+
+        \note Exactly one thread may push() and exactly one thread may pull(). stats() and
+        latencyFrames() may be called from anywhere.
+
+        \code
+        // Capture thread
+        while(captureStream.pop(packet))
+            elastic.push(packet);
+
+        // Playback thread, one period at a time
+        elastic.pull(period);
+        playbackStream.push(std::move(period));
+        \endcode
+    */
+    class ElasticBuffer
+    {
+    public:
+        /*! \brief A snapshot of how an ElasticBuffer is doing */
+        struct Statistics
+        {
+            size_t  latencyFrames; /*!< Captured frames waiting to be played */
+            double  latencySeconds; /*!< latencyFrames, at the capture rate */
+            double  driftPpm; /*!< Estimated clock drift, positive when capture runs fast */
+            double  correctionPpm; /*!< Correction currently applied to the resampling ratio */
+            size_t  underruns; /*!< Pulls that ran out of frames */
+            size_t  overruns; /*!< Pushes that found the ring full */
+            size_t  framesDropped; /*!< Captured frames lost to overruns */
+            size_t  framesIn; /*!< Captured frames accepted in total */
+            size_t  framesOut; /*!< Frames pulled out in total, silence included */
+        };
+
+        /*! \param[in] inFormat         Format of the packets that will be pushed
+            \param[in] outFormat        Format the packets will be pulled in. Must have the same
+                                        number of channels as inFormat, or isValid() is false
+            \param[in] targetFrames     Latency to hold, in captured frames
+            \param[in] capacityFrames   Size of the ring, in captured frames. 0 (and anything too small
+                                        to ride out jitter) becomes four times targetFrames
+        */
+        ElasticBuffer(const AudioFormat& inFormat, const AudioFormat& outFormat, size_t targetFrames,
+            size_t capacityFrames = 0);
+        ~ElasticBuffer();
+
+        /*! Converts and appends every frame of packet. Writer side only.
+            \return False if packet's format doesn't match inFormat, or !isValid(). Frames that don't fit are dropped
+            and counted as an overrun, but still return true.
+        */
+        bool            push(const AudioPacket& packet);
+
+        /*! Fills every frame of packet, resampling captured frames at the current ratio. Reader side
+            only.
+            \return The number of frames that came from captured audio; the rest are silence. 0 if
+            packet's format doesn't match outFormat, or !isValid().
+
+            \note packet's AudioTimestamp gets its position in the pulled stream, and DISCONTINUITY if
+            it holds any silence or captured frames were dropped since the last pull.
+        */
+        size_t          pull(AudioPacket& packet);
+
+        /*! \return False if the formats given to the constructor differ in channels, in which case
+            push() and pull() refuse every packet
+        */
+        bool            isValid() const;
+
+        /*! Drops everything buffered and restarts the controller. Only safe while neither side is
+            pushing or pulling.
+        */
+        void            reset();
+
+        size_t          targetFrames() const;
+        size_t          capacityFrames() const;
+        size_t          latencyFrames() const; /*!< Captured frames waiting to be played */
+        Statistics      stats() const;
+
+    private:
+        void            updateController(size_t fill);
+        size_t          resample(float* out, size_t numFrames, size_t readIndex, size_t available,
+                            size_t& consumed);
+
+        const AudioFormat               m_inFormat;
+        const AudioFormat               m_outFormat;
+        const SampleEncoding            m_inEncoding;
+        const SampleEncoding            m_outEncoding;
+        const size_t                    m_channels;
+        const size_t                    m_target;
+        const size_t                    m_capacity;
+        const double                    m_nominalRatio; // Captured frames per played frame
+        std::unique_ptr<float[]>        m_ring;
+
+        // Writer side
+        std::atomic<size_t>             m_writeIndex;
+        std::atomic<size_t>             m_overruns;
+        std::atomic<size_t>             m_framesDropped;
+        std::atomic<size_t>             m_framesIn;
+        std::atomic<bool>               m_dropped; // Frames were dropped since the last pull
+        char                            pad_0[CACHE_LINE_SIZE];
+
+        // Reader side
+        std::atomic<size_t>             m_readIndex;
+        std::atomic<size_t>             m_underruns;
+        std::atomic<size_t>             m_framesOut;
+        std::atomic<double>             m_driftPpm;
+        std::atomic<double>             m_correctionPpm;
+        double                          m_phase; // Fractional position past m_readIndex
+        double                          m_ratio;
+        double                          m_smoothedFill;
+        double                          m_integral;
+        bool                            m_primed;
+        char                            pad_1[CACHE_LINE_SIZE];
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        ElasticBuffer(const ElasticBuffer&);
+        ElasticBuffer(ElasticBuffer&&);
+    };
+
+}
+}
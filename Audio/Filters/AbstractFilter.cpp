@@ -1,7 +1,11 @@
 
 #include "../AudioPacket.h"
 #include "AbstractFilter.h"
+#include "FilterProcessor.h"
 #include "FilterRepository.h"
+#include "../SampleSpan.h"
+
+#include <memory>
 
 namespace DX {
 namespace Audio {
@@ -15,5 +19,32 @@ namespace Audio {
     {
     }
 
+    SampleLayout AbstractFilter::preferredLayout() const
+    {
+        return INTERLEAVED;
+    }
+
+    std::shared_ptr<FilterProcessor> AbstractFilter::createProcessor() const
+    {
+        return std::make_shared<StatelessProcessor>(*this);
+    }
+
+    bool AbstractFilter::supportsInPlace() const
+    {
+        return false;
+    }
+
+    bool AbstractFilter::processInPlace(SampleSpan<float>) const
+    {
+        return false;
+    }
+
+    bool AbstractFilter::processInto(SampleSpan<const float> in, SampleSpan<float> out) const
+    {
+        if(!supportsInPlace() || !copySamples(in, out))
+            return false;
+        return processInPlace(out);
+    }
+
 }
 }
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include "../AudioFormat.h"
 #include "../DXAudioExport.h"
 
 #include <string>
@@ -33,6 +34,9 @@ namespace DX {
 namespace Audio {
 
     class AudioPacket;
+    class FilterProcessor;
+    template <typename T>
+    class SampleSpan;
 
     enum FilterType
     {
@@ -50,6 +54,41 @@ namespace Audio {
 
         virtual bool            transformPacket(const AudioPacket& in, AudioPacket& out) const = 0;
         virtual std::string     name() const = 0;
+
+        /*! \return The SampleLayout the filter would like its packets in. Whoever drives the filter
+            converts to it once, before the filter runs (see Interleaving). Defaults to INTERLEAVED,
+            which is what devices use and so costs nothing.
+        */
+        virtual SampleLayout    preferredLayout() const;
+
+        /*! \return A new FilterProcessor for one stream through the filter. Defaults to a
+            StatelessProcessor that calls transformPacket(); filters that need to carry anything from
+            one packet to the next override this. Prefer FilterRepository::createProcessor(), which
+            also keeps the filter alive for as long as the FilterProcessor.
+
+            \note The filter must outlive the FilterProcessor.
+        */
+        virtual std::shared_ptr<FilterProcessor> createProcessor() const;
+
+        /*! \return True if the filter can run in place (see processInPlace()). Only filters that
+            leave the format alone - gain, EQ, dynamics - can. Defaults to false.
+        */
+        virtual bool            supportsInPlace() const;
+
+        /*! Filters FLOAT32 samples where they lie, in whatever layout their strides describe. No
+            second buffer, no allocations, so a chain of these keeps running over memory that's
+            already in cache.
+            \return False if the filter doesn't support it (the default)
+        */
+        virtual bool            processInPlace(SampleSpan<float> samples) const;
+
+        /*! Filters in into out, caller-provided and the same shape as in, without allocating. in and
+            out may be the same samples. Defaults to copying in to out and running processInPlace()
+            there.
+            \return False if the filter doesn't support in place processing, or the spans differ in
+            frames or channels
+        */
+        virtual bool            processInto(SampleSpan<const float> in, SampleSpan<float> out) const;
     };
 
 #define DECLARE_FILTER(filter) static const filter s_ ## filter; 
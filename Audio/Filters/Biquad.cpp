@@ -0,0 +1,93 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Biquad.h"
+
+#include <cmath>
+
+namespace DX {
+namespace Audio {
+
+    static const double PI = 3.14159265358979323846;
+
+    // Divides everything through by a0
+    static BiquadCoefficients normalized(double b0, double b1, double b2, double a0, double a1, double a2)
+    {
+        BiquadCoefficients coefficients =
+        {
+            static_cast<float>(b0 / a0), static_cast<float>(b1 / a0), static_cast<float>(b2 / a0),
+            static_cast<float>(a1 / a0), static_cast<float>(a2 / a0)
+        };
+        return coefficients;
+    }
+
+    // The cookbook's w0 as its cosine, and alpha
+    static void prewarp(float sampleRate, float frequency, float q, double& cosine, double& alpha)
+    {
+        const double w0 = 2.0 * PI * double(frequency) / double(sampleRate);
+        cosine = std::cos(w0);
+        alpha = std::sin(w0) / (2.0 * double(q));
+    }
+
+    BiquadCoefficients BiquadCoefficients::lowPass(float sampleRate, float frequency, float q)
+    {
+        double cosine, alpha;
+        prewarp(sampleRate, frequency, q, cosine, alpha);
+        return normalized((1.0 - cosine) / 2.0, 1.0 - cosine, (1.0 - cosine) / 2.0, 1.0 + alpha, -2.0 * cosine, 1.0 - alpha);
+    }
+
+    BiquadCoefficients BiquadCoefficients::highPass(float sampleRate, float frequency, float q)
+    {
+        double cosine, alpha;
+        prewarp(sampleRate, frequency, q, cosine, alpha);
+        return normalized((1.0 + cosine) / 2.0, -(1.0 + cosine), (1.0 + cosine) / 2.0, 1.0 + alpha, -2.0 * cosine, 1.0 - alpha);
+    }
+
+    BiquadCoefficients BiquadCoefficients::peaking(float sampleRate, float frequency, float q, float gainDecibels)
+    {
+        double cosine, alpha;
+        prewarp(sampleRate, frequency, q, cosine, alpha);
+        const double a = std::pow(10.0, double(gainDecibels) / 40.0);
+        return normalized(1.0 + alpha * a, -2.0 * cosine, 1.0 - alpha * a, 1.0 + alpha / a, -2.0 * cosine, 1.0 - alpha / a);
+    }
+
+    BiquadCoefficients BiquadCoefficients::lowShelf(float sampleRate, float frequency, float gainDecibels, float q)
+    {
+        double cosine, alpha;
+        prewarp(sampleRate, frequency, q, cosine, alpha);
+        const double a = std::pow(10.0, double(gainDecibels) / 40.0);
+        const double root = 2.0 * std::sqrt(a) * alpha;
+        return normalized(a * ((a + 1.0) - (a - 1.0) * cosine + root), 2.0 * a * ((a - 1.0) - (a + 1.0) * cosine),
+            a * ((a + 1.0) - (a - 1.0) * cosine - root), (a + 1.0) + (a - 1.0) * cosine + root,
+            -2.0 * ((a - 1.0) + (a + 1.0) * cosine), (a + 1.0) + (a - 1.0) * cosine - root);
+    }
+
+    BiquadCoefficients BiquadCoefficients::highShelf(float sampleRate, float frequency, float gainDecibels, float q)
+    {
+        double cosine, alpha;
+        prewarp(sampleRate, frequency, q, cosine, alpha);
+        const double a = std::pow(10.0, double(gainDecibels) / 40.0);
+        const double root = 2.0 * std::sqrt(a) * alpha;
+        return normalized(a * ((a + 1.0) + (a - 1.0) * cosine + root), -2.0 * a * ((a - 1.0) + (a + 1.0) * cosine),
+            a * ((a + 1.0) + (a - 1.0) * cosine - root), (a + 1.0) - (a - 1.0) * cosine + root,
+            2.0 * ((a - 1.0) - (a + 1.0) * cosine), (a + 1.0) - (a - 1.0) * cosine - root);
+    }
+
+}
+}
@@ -0,0 +1,68 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../DXAudioExport.h"
+
+namespace DX {
+namespace Audio {
+
+    /*! \brief BiquadCoefficients are one second order IIR section, normalized so a0 is 1:
+
+            y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+
+        They're run in transposed direct form II, which needs two state values per channel and
+        keeps its accuracy in floating point.
+
+        The design helpers follow Robert Bristow-Johnson's Audio EQ Cookbook. Frequencies are in Hz
+        and gains in dB; q sets the bandwidth (the slope, for shelves), and the default of 1 / sqrt(2)
+        gives Butterworth low and high passes.
+
+        \code
+        BiquadCoefficients presence = BiquadCoefficients::peaking(48000.0f, 3000.0f, 1.0f, 4.0f);
+        \endcode
+    */
+    struct DXAUDIO_EXPORT BiquadCoefficients
+    {
+        float   b0;
+        float   b1;
+        float   b2;
+        float   a1;
+        float   a2;
+
+        /*! \return Coefficients that pass everything through untouched */
+        static BiquadCoefficients passThrough()
+        {
+            BiquadCoefficients coefficients = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+            return coefficients;
+        }
+
+        static BiquadCoefficients lowPass(float sampleRate, float frequency, float q = 0.70710678f);
+        static BiquadCoefficients highPass(float sampleRate, float frequency, float q = 0.70710678f);
+        /*! Boosts or cuts gainDecibels around frequency */
+        static BiquadCoefficients peaking(float sampleRate, float frequency, float q, float gainDecibels);
+        /*! Boosts or cuts gainDecibels below frequency */
+        static BiquadCoefficients lowShelf(float sampleRate, float frequency, float gainDecibels, float q = 0.70710678f);
+        /*! Boosts or cuts gainDecibels above frequency */
+        static BiquadCoefficients highShelf(float sampleRate, float frequency, float gainDecibels, float q = 0.70710678f);
+    };
+
+}
+}
@@ -0,0 +1,504 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "BiquadCascade.h"
+#include "../AudioPacket.h"
+#include "../SampleSpan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#if defined(__AVX__)
+    #define DX_BIQUAD_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define DX_BIQUAD_SSE
+#endif
+
+#if defined(DX_BIQUAD_AVX)
+    #include <immintrin.h>
+#elif defined(DX_BIQUAD_SSE)
+    #include <xmmintrin.h>
+#endif
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Lanes
+
+    // One vector of channels, and the handful of operations the filters need on it
+#if defined(DX_BIQUAD_AVX)
+    typedef __m256 Lanes;
+    static const size_t LANES = 8;
+
+    static inline Lanes load(const float* from) { return _mm256_loadu_ps(from); }
+    static inline void store(float* to, Lanes value) { _mm256_storeu_ps(to, value); }
+    static inline Lanes add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+    static inline Lanes subtract(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+    static inline Lanes multiply(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+
+    // Zeroes lanes smaller in magnitude than threshold
+    static inline Lanes flushed(Lanes value, float threshold)
+    {
+        const Lanes magnitude = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value);
+        return _mm256_and_ps(value, _mm256_cmp_ps(magnitude, _mm256_set1_ps(threshold), _CMP_GE_OQ));
+    }
+#elif defined(DX_BIQUAD_SSE)
+    typedef __m128 Lanes;
+    static const size_t LANES = 4;
+
+    static inline Lanes load(const float* from) { return _mm_loadu_ps(from); }
+    static inline void store(float* to, Lanes value) { _mm_storeu_ps(to, value); }
+    static inline Lanes add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+    static inline Lanes subtract(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+    static inline Lanes multiply(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+
+    static inline Lanes flushed(Lanes value, float threshold)
+    {
+        const Lanes magnitude = _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+        return _mm_and_ps(value, _mm_cmpge_ps(magnitude, _mm_set1_ps(threshold)));
+    }
+#else
+    static const size_t LANES = 4;
+
+    struct Lanes
+    {
+        float   lane[LANES];
+    };
+
+    static inline Lanes load(const float* from)
+    {
+        Lanes ret;
+        std::memcpy(ret.lane, from, sizeof(ret.lane));
+        return ret;
+    }
+
+    static inline void store(float* to, Lanes value)
+    {
+        std::memcpy(to, value.lane, sizeof(value.lane));
+    }
+
+    static inline Lanes add(Lanes a, Lanes b)
+    {
+        for(size_t i = 0; i < LANES; ++i)
+            a.lane[i] += b.lane[i];
+        return a;
+    }
+
+    static inline Lanes subtract(Lanes a, Lanes b)
+    {
+        for(size_t i = 0; i < LANES; ++i)
+            a.lane[i] -= b.lane[i];
+        return a;
+    }
+
+    static inline Lanes multiply(Lanes a, Lanes b)
+    {
+        for(size_t i = 0; i < LANES; ++i)
+            a.lane[i] *= b.lane[i];
+        return a;
+    }
+
+    static inline Lanes flushed(Lanes value, float threshold)
+    {
+        for(size_t i = 0; i < LANES; ++i)
+        {
+            if(value.lane[i] < threshold && value.lane[i] > -threshold)
+                value.lane[i] = 0.0f;
+        }
+        return value;
+    }
+#endif
+
+    // Frames filtered at a time, which bounds the scratch buffer
+    static const size_t RUN_FRAMES = 256;
+    // State below this is ~400 dB down, well on its way to denormals, and zeroed
+    static const float FLUSH_THRESHOLD = 1e-20f;
+    // Floats per section of a group: b0, b1, b2, a1 and a2
+    static const size_t COEFFICIENT_STRIDE = 5 * LANES;
+    // Floats per section of a group: z1 and z2
+    static const size_t STATE_STRIDE = 2 * LANES;
+
+    /*
+        Runs one section over numFrames frames of one group, lanes interleaved, where they lie. While
+        Gliding, every frame steps the coefficients first, so the last frame of a glide lands on its
+        target.
+    */
+    template <bool Gliding>
+    static void runSection(float* samples, size_t numFrames, float* coefficients, const float* steps, float* state)
+    {
+        Lanes b0 = load(coefficients);
+        Lanes b1 = load(coefficients + LANES);
+        Lanes b2 = load(coefficients + 2 * LANES);
+        Lanes a1 = load(coefficients + 3 * LANES);
+        Lanes a2 = load(coefficients + 4 * LANES);
+        Lanes z1 = load(state);
+        Lanes z2 = load(state + LANES);
+
+        for(size_t frame = 0; frame < numFrames; ++frame)
+        {
+            if(Gliding)
+            {
+                b0 = add(b0, load(steps));
+                b1 = add(b1, load(steps + LANES));
+                b2 = add(b2, load(steps + 2 * LANES));
+                a1 = add(a1, load(steps + 3 * LANES));
+                a2 = add(a2, load(steps + 4 * LANES));
+            }
+
+            float* sample = samples + frame * LANES;
+            const Lanes x = load(sample);
+            const Lanes y = add(multiply(b0, x), z1);
+            z1 = add(subtract(multiply(b1, x), multiply(a1, y)), z2);
+            z2 = subtract(multiply(b2, x), multiply(a2, y));
+            store(sample, y);
+        }
+
+        store(state, flushed(z1, FLUSH_THRESHOLD));
+        store(state + LANES, flushed(z2, FLUSH_THRESHOLD));
+        if(Gliding)
+        {
+            store(coefficients, b0);
+            store(coefficients + LANES, b1);
+            store(coefficients + 2 * LANES, b2);
+            store(coefficients + 3 * LANES, a1);
+            store(coefficients + 4 * LANES, a2);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // BiquadSettings
+
+    /*
+        The coefficients a BiquadCascade was last given, shared with its streams. Writers wait their
+        turn on a spin lock; streams only try it, so the audio thread never waits on the one setting
+        coefficients. The version moves on with every change.
+    */
+    class BiquadSettings
+    {
+    public:
+        BiquadSettings(size_t numChannels, size_t numSections);
+
+        void                set(size_t channel, size_t section, const BiquadCoefficients& coefficients);
+        void                setAll(size_t section, const BiquadCoefficients& coefficients);
+        BiquadCoefficients  get(size_t channel, size_t section) const;
+
+        size_t              version() const { return m_version.load(std::memory_order_acquire); }
+        // Copies every channel's coefficients into to, unless a writer's busy with them
+        bool                tryCopy(std::vector<BiquadCoefficients>& to, size_t& version) const;
+
+        size_t              numChannels() const { return m_numChannels; }
+        size_t              numSections() const { return m_numSections; }
+
+    private:
+        void                lock() const;
+        void                unlock() const;
+
+        const size_t                    m_numChannels;
+        const size_t                    m_numSections;
+        std::vector<BiquadCoefficients> m_coefficients; // Per channel then section
+        std::atomic<size_t>             m_version;
+        mutable std::atomic<bool>       m_lock;
+    };
+
+    BiquadSettings::BiquadSettings(size_t numChannels, size_t numSections)
+        : m_numChannels(numChannels), m_numSections(numSections),
+        m_coefficients(numChannels * numSections, BiquadCoefficients::passThrough()), m_version(0), m_lock(false)
+    {
+    }
+
+    void BiquadSettings::set(size_t channel, size_t section, const BiquadCoefficients& coefficients)
+    {
+        lock();
+        m_coefficients[channel * m_numSections + section] = coefficients;
+        m_version.fetch_add(1, std::memory_order_release);
+        unlock();
+    }
+
+    void BiquadSettings::setAll(size_t section, const BiquadCoefficients& coefficients)
+    {
+        lock();
+        for(size_t channel = 0; channel < m_numChannels; ++channel)
+            m_coefficients[channel * m_numSections + section] = coefficients;
+        m_version.fetch_add(1, std::memory_order_release);
+        unlock();
+    }
+
+    BiquadCoefficients BiquadSettings::get(size_t channel, size_t section) const
+    {
+        lock();
+        const BiquadCoefficients ret = m_coefficients[channel * m_numSections + section];
+        unlock();
+        return ret;
+    }
+
+    bool BiquadSettings::tryCopy(std::vector<BiquadCoefficients>& to, size_t& version) const
+    {
+        if(m_lock.exchange(true, std::memory_order_acquire))
+            return false;
+
+        to.assign(m_coefficients.begin(), m_coefficients.end());
+        version = m_version.load(std::memory_order_relaxed);
+        unlock();
+        return true;
+    }
+
+    void BiquadSettings::lock() const
+    {
+        while(m_lock.exchange(true, std::memory_order_acquire))
+            std::this_thread::yield();
+    }
+
+    void BiquadSettings::unlock() const
+    {
+        m_lock.store(false, std::memory_order_release);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // BiquadCascadeProcessor impl
+
+    BiquadCascadeProcessor::BiquadCascadeProcessor(const std::shared_ptr<const BiquadSettings>& settings)
+        : m_settings(settings), m_numGroups((settings->numChannels() + LANES - 1) / LANES),
+        m_version(static_cast<size_t>(-1)), m_pending(settings->numChannels() * settings->numSections()),
+        m_coefficients(m_numGroups * settings->numSections() * COEFFICIENT_STRIDE),
+        m_targets(m_coefficients.size()), m_steps(m_coefficients.size()), m_rampRemaining(0),
+        m_state(m_numGroups * settings->numSections() * STATE_STRIDE), m_scratch(RUN_FRAMES * LANES)
+    {
+        // Padding lanes, past the last channel, pass through whatever happens
+        const BiquadCoefficients passThrough = BiquadCoefficients::passThrough();
+        for(size_t i = 0; i < m_coefficients.size(); i += LANES)
+        {
+            const size_t coefficient = (i % COEFFICIENT_STRIDE) / LANES;
+            std::fill(&m_coefficients[i], &m_coefficients[i] + LANES, coefficient == 0 ? passThrough.b0 : 0.0f);
+        }
+        m_targets = m_coefficients;
+        update();
+    }
+
+    BiquadCascadeProcessor::~BiquadCascadeProcessor()
+    {
+    }
+
+    bool BiquadCascadeProcessor::process(const AudioPacket& in, AudioPacket& out)
+    {
+        const AudioFormat format = in.getAudioFormat();
+        if(format != out.getAudioFormat() || encodingOf(format) != FLOAT32)
+            return false;
+
+        out.resize(in.byteSize());
+        return processInto(makeSampleSpan<float>(in), makeSampleSpan<float>(out));
+    }
+
+    void BiquadCascadeProcessor::reset()
+    {
+        std::fill(m_state.begin(), m_state.end(), 0.0f);
+        m_coefficients = m_targets;
+        m_rampRemaining = 0;
+    }
+
+    bool BiquadCascadeProcessor::supportsInPlace() const
+    {
+        return true;
+    }
+
+    bool BiquadCascadeProcessor::processInPlace(SampleSpan<float> samples)
+    {
+        return processInto(samples, samples);
+    }
+
+    bool BiquadCascadeProcessor::processInto(SampleSpan<const float> in, SampleSpan<float> out)
+    {
+        const size_t numChannels = m_settings->numChannels();
+        const size_t numSections = m_settings->numSections();
+        if(in.numChannels() != numChannels || out.numChannels() != numChannels || in.numFrames() != out.numFrames())
+            return false;
+
+        update();
+
+        float* scratch = &m_scratch[0];
+        for(size_t first = 0; first < in.numFrames(); first += RUN_FRAMES)
+        {
+            const size_t numFrames = std::min(RUN_FRAMES, in.numFrames() - first);
+            const size_t gliding = std::min(m_rampRemaining, numFrames);
+            for(size_t group = 0; group < m_numGroups; ++group)
+            {
+                const size_t firstChannel = group * LANES;
+                const size_t numLanes = std::min(LANES, numChannels - firstChannel);
+                if(numLanes < LANES)
+                    std::fill(m_scratch.begin(), m_scratch.end(), 0.0f);
+                for(size_t frame = 0; frame < numFrames; ++frame)
+                {
+                    for(size_t lane = 0; lane < numLanes; ++lane)
+                        scratch[frame * LANES + lane] = in(first + frame, firstChannel + lane);
+                }
+
+                for(size_t section = 0; section < numSections; ++section)
+                {
+                    const size_t index = group * numSections + section;
+                    float* coefficients = &m_coefficients[index * COEFFICIENT_STRIDE];
+                    float* state = &m_state[index * STATE_STRIDE];
+                    if(gliding > 0)
+                        runSection<true>(scratch, gliding, coefficients, &m_steps[index * COEFFICIENT_STRIDE], state);
+                    runSection<false>(scratch + gliding * LANES, numFrames - gliding, coefficients, nullptr, state);
+                }
+
+                for(size_t frame = 0; frame < numFrames; ++frame)
+                {
+                    for(size_t lane = 0; lane < numLanes; ++lane)
+                        out(first + frame, firstChannel + lane) = scratch[frame * LANES + lane];
+                }
+            }
+
+            m_rampRemaining -= gliding;
+            // Land exactly on the targets, whatever rounding the steps picked up along the way
+            if(gliding > 0 && m_rampRemaining == 0)
+                m_coefficients = m_targets;
+        }
+        return true;
+    }
+
+    void BiquadCascadeProcessor::update()
+    {
+        const bool first = (m_version == static_cast<size_t>(-1));
+        if(!first && m_settings->version() == m_version)
+            return;
+
+        size_t version;
+        if(!m_settings->tryCopy(m_pending, version))
+            return;
+        m_version = version;
+
+        const size_t numChannels = m_settings->numChannels();
+        const size_t numSections = m_settings->numSections();
+        for(size_t channel = 0; channel < numChannels; ++channel)
+        {
+            const size_t group = channel / LANES;
+            const size_t lane = channel % LANES;
+            for(size_t section = 0; section < numSections; ++section)
+            {
+                const BiquadCoefficients& coefficients = m_pending[channel * numSections + section];
+                float* target = &m_targets[(group * numSections + section) * COEFFICIENT_STRIDE + lane];
+                target[0] = coefficients.b0;
+                target[LANES] = coefficients.b1;
+                target[2 * LANES] = coefficients.b2;
+                target[3 * LANES] = coefficients.a1;
+                target[4 * LANES] = coefficients.a2;
+            }
+        }
+
+        // Glide from wherever the coefficients are now, even partway through an earlier glide
+        if(first || BIQUAD_RAMP_FRAMES == 0)
+        {
+            m_coefficients = m_targets;
+            m_rampRemaining = 0;
+            return;
+        }
+
+        const float scale = 1.0f / static_cast<float>(BIQUAD_RAMP_FRAMES);
+        for(size_t i = 0; i < m_steps.size(); ++i)
+            m_steps[i] = (m_targets[i] - m_coefficients[i]) * scale;
+        m_rampRemaining = BIQUAD_RAMP_FRAMES;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // BiquadCascade impl
+
+    BiquadCascade::BiquadCascade(size_t numChannels, size_t numSections)
+        : AbstractFilter(nullptr, EFFECTS), m_settings(std::make_shared<BiquadSettings>(numChannels, numSections)),
+        m_processor(std::make_shared<BiquadCascadeProcessor>(m_settings))
+    {
+    }
+
+    BiquadCascade::~BiquadCascade()
+    {
+    }
+
+    bool BiquadCascade::transformPacket(const AudioPacket& in, AudioPacket& out) const
+    {
+        return m_processor->process(in, out);
+    }
+
+    std::string BiquadCascade::name() const
+    {
+        static const std::string name("Biquad cascade");
+        return name;
+    }
+
+    std::shared_ptr<FilterProcessor> BiquadCascade::createProcessor() const
+    {
+        return std::make_shared<BiquadCascadeProcessor>(m_settings);
+    }
+
+    bool BiquadCascade::supportsInPlace() const
+    {
+        return true;
+    }
+
+    bool BiquadCascade::processInPlace(SampleSpan<float> samples) const
+    {
+        return m_processor->processInPlace(samples);
+    }
+
+    bool BiquadCascade::processInto(SampleSpan<const float> in, SampleSpan<float> out) const
+    {
+        return m_processor->processInto(in, out);
+    }
+
+    void BiquadCascade::reset()
+    {
+        m_processor->reset();
+    }
+
+    void BiquadCascade::setCoefficients(size_t section, const BiquadCoefficients& coefficients)
+    {
+        if(section < m_settings->numSections())
+            m_settings->setAll(section, coefficients);
+    }
+
+    void BiquadCascade::setCoefficients(size_t channel, size_t section, const BiquadCoefficients& coefficients)
+    {
+        if(channel < m_settings->numChannels() && section < m_settings->numSections())
+            m_settings->set(channel, section, coefficients);
+    }
+
+    BiquadCoefficients BiquadCascade::coefficients(size_t channel, size_t section) const
+    {
+        if(channel >= m_settings->numChannels() || section >= m_settings->numSections())
+            return BiquadCoefficients::passThrough();
+        return m_settings->get(channel, section);
+    }
+
+    size_t BiquadCascade::numChannels() const
+    {
+        return m_settings->numChannels();
+    }
+
+    size_t BiquadCascade::numSections() const
+    {
+        return m_settings->numSections();
+    }
+
+}
+}
@@ -0,0 +1,141 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AbstractFilter.h"
+#include "Biquad.h"
+#include "FilterProcessor.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace DX {
+namespace Audio {
+
+    class BiquadSettings;
+
+    //! Defines how many frames a BiquadCascade takes to glide to new coefficients. Arbitrary for now, best results TBD
+    #ifndef BIQUAD_RAMP_FRAMES
+        #define BIQUAD_RAMP_FRAMES 256
+    #endif
+
+    /*! \brief BiquadCascadeProcessor is one stream through a BiquadCascade, see FilterProcessor */
+    class DXAUDIO_EXPORT BiquadCascadeProcessor : public FilterProcessor
+    {
+    public:
+        explicit BiquadCascadeProcessor(const std::shared_ptr<const BiquadSettings>& settings);
+        ~BiquadCascadeProcessor();
+
+        /*! \return False if the packets differ in format, aren't FLOAT32 or have the wrong channels */
+        bool            process(const AudioPacket& in, AudioPacket& out);
+        /*! Forgets the filters' state, and finishes any glide at once */
+        void            reset();
+        bool            supportsInPlace() const;
+        bool            processInPlace(SampleSpan<float> samples);
+        bool            processInto(SampleSpan<const float> in, SampleSpan<float> out);
+
+    private:
+        void            update(); // Picks up coefficients set since the last block, if it can without waiting
+
+        const std::shared_ptr<const BiquadSettings> m_settings;
+        const size_t                                m_numGroups; // Of channels, one per vector
+        size_t                                      m_version; // Of the settings last picked up
+        std::vector<BiquadCoefficients>             m_pending; // Per channel then section, as picked up
+        // Per group then section: b0, b1, b2, a1, a2, each as one vector's worth of channels
+        std::vector<float>                          m_coefficients;
+        std::vector<float>                          m_targets;
+        std::vector<float>                          m_steps; // Added to m_coefficients each frame of a glide
+        size_t                                      m_rampRemaining; // Frames left in the glide
+        std::vector<float>                          m_state; // Per group then section: z1, z2
+        std::vector<float>                          m_scratch; // A run of frames of one group
+    };
+
+    /*! \brief BiquadCascade runs every channel through its own chain of biquads - the building
+        block of parametric EQ, high and low passes, shelves and crossovers - built for many
+        channels at once.
+
+        Channels are filtered side by side, a vector at a time: eight channels per AVX vector when
+        built with AVX, four per SSE vector otherwise (or four at a time in plain code, where there's
+        no SSE). Each group of channels is gathered out of the packet once, run through every section
+        in turn in transposed direct form II - coefficients and state held in registers for a whole
+        run of frames - and scattered back. Filter state is flushed to zero when it decays far below
+        audibility, so silence never drags the filters into denormals.
+
+        Coefficients may be changed at any time, from any thread. Rather than jumping, which clicks
+        and "zippers" when a control is swept, each stream glides from the coefficients it has to the
+        new ones over BIQUAD_RAMP_FRAMES frames. Streams pick changes up at the start of a packet,
+        and never wait for one to finish being made: a packet that starts mid-change keeps the old
+        coefficients, and the next picks the new ones up.
+
+        Samples are FLOAT32, in either layout, with numChannels() channels, and a BiquadCascade runs
+        in place (see AbstractFilter::processInPlace()). Every section starts out passing everything
+        through. Filter state lives in a BiquadCascadeProcessor per stream, from createProcessor();
+        transformPacket() runs through one built in, which makes calling it directly good for one
+        stream at a time.
+
+        \code
+        BiquadCascade equalizer(32, 3);
+        equalizer.setCoefficients(0, BiquadCoefficients::highPass(48000.0f, 40.0f));
+        equalizer.setCoefficients(1, BiquadCoefficients::peaking(48000.0f, 250.0f, 1.0f, -3.0f));
+        equalizer.setCoefficients(2, BiquadCoefficients::highShelf(48000.0f, 8000.0f, 2.0f));
+        playbackDevice->writeToBuffer(captureStream, equalizer, callback);
+        \endcode
+    */
+    struct DXAUDIO_EXPORT BiquadCascade : public AbstractFilter
+    {
+        BiquadCascade(size_t numChannels, size_t numSections);
+        ~BiquadCascade();
+
+        /*! \return False if the packets differ in format, aren't FLOAT32 or have the wrong channels */
+        bool                transformPacket(const AudioPacket& in, AudioPacket& out) const;
+        std::string         name() const;
+        std::shared_ptr<FilterProcessor> createProcessor() const;
+        bool                supportsInPlace() const;
+        bool                processInPlace(SampleSpan<float> samples) const;
+        bool                processInto(SampleSpan<const float> in, SampleSpan<float> out) const;
+
+        /*! Forgets any state transformPacket() carried over from earlier packets */
+        void                reset();
+
+        /*! Sets section of every channel. Does nothing if section is out of range. */
+        void                setCoefficients(size_t section, const BiquadCoefficients& coefficients);
+        /*! Sets section of channel. Does nothing if either is out of range. */
+        void                setCoefficients(size_t channel, size_t section, const BiquadCoefficients& coefficients);
+        /*! \return What section of channel was last set to */
+        BiquadCoefficients  coefficients(size_t channel, size_t section) const;
+
+        size_t              numChannels() const;
+        size_t              numSections() const;
+
+    private:
+        const std::shared_ptr<BiquadSettings>           m_settings;
+        const std::shared_ptr<BiquadCascadeProcessor>   m_processor; // What transformPacket() streams through
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        BiquadCascade(const BiquadCascade&);
+        BiquadCascade(BiquadCascade&&);
+    };
+
+}
+}
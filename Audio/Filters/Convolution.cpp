@@ -0,0 +1,475 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Convolution.h"
+#include "FFT.h"
+#include "../AudioPacket.h"
+#include "../SampleSpan.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define DX_CONVOLUTION_SSE
+#endif
+
+#if defined(DX_CONVOLUTION_SSE)
+    #include <xmmintrin.h>
+#endif
+
+namespace DX {
+namespace Audio {
+
+    // sum += x * h, over count complex numbers in split form
+    static void multiplyAdd(const float* xRe, const float* xIm, const float* hRe, const float* hIm, float* sumRe,
+        float* sumIm, size_t count)
+    {
+        size_t i = 0;
+    #if defined(DX_CONVOLUTION_SSE)
+        for(; i + 4 <= count; i += 4)
+        {
+            const __m128 ar = _mm_loadu_ps(xRe + i);
+            const __m128 ai = _mm_loadu_ps(xIm + i);
+            const __m128 br = _mm_loadu_ps(hRe + i);
+            const __m128 bi = _mm_loadu_ps(hIm + i);
+            const __m128 re = _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi));
+            const __m128 im = _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br));
+            _mm_storeu_ps(sumRe + i, _mm_add_ps(_mm_loadu_ps(sumRe + i), re));
+            _mm_storeu_ps(sumIm + i, _mm_add_ps(_mm_loadu_ps(sumIm + i), im));
+        }
+    #endif
+        for(; i < count; ++i)
+        {
+            sumRe[i] += xRe[i] * hRe[i] - xIm[i] * hIm[i];
+            sumIm[i] += xRe[i] * hIm[i] + xIm[i] * hRe[i];
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // ConvolutionKernel
+
+    /*
+        An impulse response cut into partitions of blockSize taps, each zero padded to twice that
+        and transformed: numPartitions runs of blockSize + 1 bins
+    */
+    struct Partitions
+    {
+        size_t              blockSize;
+        size_t              numPartitions;
+        std::vector<float>  re;
+        std::vector<float>  im;
+    };
+
+    /*
+        Everything a Convolution's streams share: the head partitions of every response and, when
+        non-uniform, the tail partitions. The tail is the response from twice its block size on, with
+        a block of zeros in front - see ConvolutionProcessor::runBlock() for why.
+    */
+    class ConvolutionKernel
+    {
+    public:
+        ConvolutionKernel(const std::vector<std::vector<float>>& responses, size_t blockSize, ConvolutionMode mode);
+
+        size_t              blockSize() const { return m_blockSize; }
+        size_t              tailBlockSize() const { return m_tailBlockSize; } // 0 without a tail
+        size_t              numResponses() const { return m_heads.size(); }
+        ConvolutionMode     mode() const { return m_mode; }
+        const Partitions&   head(size_t response) const { return m_heads[response]; }
+        const Partitions&   tail(size_t response) const { return m_tails[response]; }
+
+    private:
+        static Partitions   partition(const std::vector<float>& response, size_t begin, size_t end, size_t leadingZeros,
+                                size_t blockSize);
+
+        const size_t            m_blockSize;
+        size_t                  m_tailBlockSize;
+        const ConvolutionMode   m_mode;
+        std::vector<Partitions> m_heads;
+        std::vector<Partitions> m_tails;
+    };
+
+    ConvolutionKernel::ConvolutionKernel(const std::vector<std::vector<float>>& responses, size_t blockSize,
+        ConvolutionMode mode)
+        : m_blockSize(FFT::roundUp(blockSize)), m_tailBlockSize(0), m_mode(mode)
+    {
+        std::vector<std::vector<float>> all(responses);
+        if(all.empty())
+            all.push_back(std::vector<float>());
+
+        size_t longest = 0;
+        for(const std::vector<float>& response : all)
+            longest = std::max(longest, response.size());
+
+        // The head has to reach twice the tail's block size; any shorter and there's no tail to speak of
+        const size_t tailBlockSize = m_blockSize * FFT::roundUp(CONVOLUTION_TAIL_BLOCKS);
+        if(mode == CONVOLUTION_NON_UNIFORM && tailBlockSize > m_blockSize && longest > 2 * tailBlockSize)
+            m_tailBlockSize = tailBlockSize;
+
+        for(const std::vector<float>& response : all)
+        {
+            if(m_tailBlockSize == 0)
+            {
+                m_heads.push_back(partition(response, 0, response.size(), 0, m_blockSize));
+            }
+            else
+            {
+                const size_t split = std::min(response.size(), 2 * m_tailBlockSize);
+                m_heads.push_back(partition(response, 0, split, 0, m_blockSize));
+                m_tails.push_back(partition(response, split, response.size(), m_blockSize, m_tailBlockSize));
+            }
+        }
+    }
+
+    Partitions ConvolutionKernel::partition(const std::vector<float>& response, size_t begin, size_t end,
+        size_t leadingZeros, size_t blockSize)
+    {
+        const size_t length = leadingZeros + (end - begin);
+        Partitions partitions;
+        partitions.blockSize = blockSize;
+        partitions.numPartitions = std::max(size_t(1), (length + blockSize - 1) / blockSize);
+
+        RealFFT fft(2 * blockSize);
+        const size_t bins = fft.numBins();
+        partitions.re.resize(partitions.numPartitions * bins);
+        partitions.im.resize(partitions.numPartitions * bins);
+
+        // Taps of the padded response, then as many zeros again, per partition
+        std::vector<float> padded(leadingZeros, 0.0f);
+        padded.insert(padded.end(), response.begin() + begin, response.begin() + end);
+        padded.resize(partitions.numPartitions * blockSize, 0.0f);
+        std::vector<float> time(2 * blockSize, 0.0f);
+        for(size_t p = 0; p < partitions.numPartitions; ++p)
+        {
+            std::memcpy(&time[0], &padded[p * blockSize], blockSize * sizeof(float));
+            fft.forward(&time[0], &partitions.re[p * bins], &partitions.im[p * bins]);
+        }
+        return partitions;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // UniformConvolver
+
+    /*
+        Uniformly partitioned overlap-save convolution of one channel: the last two blocks of input,
+        the frequency-domain delay line of the spectra of each, and the sum of their products with
+        the partitions that's building up. Kept in steps so the tail can spread its work out.
+    */
+    class UniformConvolver
+    {
+    public:
+        explicit UniformConvolver(const Partitions& partitions);
+
+        // Writes count samples, offset frames into the newest block
+        void            write(const float* samples, size_t offset, size_t count);
+        // Transforms the last two blocks into the delay line, makes room for the next block, and starts a new sum
+        void            transform(RealFFT& fft);
+        // Adds partitions [first, last) times the input blocks they line up with to the sum
+        void            accumulate(size_t first, size_t last);
+        // Transforms the sum back, the last block of which is the output
+        void            finish(RealFFT& fft);
+        void            reset();
+
+        const float*    output() const { return &m_time[m_partitions.blockSize]; }
+        size_t          numPartitions() const { return m_partitions.numPartitions; }
+
+    private:
+        const Partitions&   m_partitions;
+        const size_t        m_bins;
+        std::vector<float>  m_input; // The previous block then the newest one
+        std::vector<float>  m_delayRe; // numPartitions() spectra, the newest at m_newest, older ones before it
+        std::vector<float>  m_delayIm;
+        size_t              m_newest;
+        std::vector<float>  m_sumRe;
+        std::vector<float>  m_sumIm;
+        std::vector<float>  m_time;
+    };
+
+    UniformConvolver::UniformConvolver(const Partitions& partitions)
+        : m_partitions(partitions), m_bins(partitions.blockSize + 1), m_input(2 * partitions.blockSize),
+        m_delayRe(partitions.numPartitions * m_bins), m_delayIm(partitions.numPartitions * m_bins), m_newest(0),
+        m_sumRe(m_bins), m_sumIm(m_bins), m_time(2 * partitions.blockSize)
+    {
+    }
+
+    void UniformConvolver::write(const float* samples, size_t offset, size_t count)
+    {
+        std::memcpy(&m_input[m_partitions.blockSize + offset], samples, count * sizeof(float));
+    }
+
+    void UniformConvolver::transform(RealFFT& fft)
+    {
+        const size_t blockSize = m_partitions.blockSize;
+        m_newest = (m_newest + 1) % m_partitions.numPartitions;
+        fft.forward(&m_input[0], &m_delayRe[m_newest * m_bins], &m_delayIm[m_newest * m_bins]);
+        std::memcpy(&m_input[0], &m_input[blockSize], blockSize * sizeof(float));
+
+        std::fill(m_sumRe.begin(), m_sumRe.end(), 0.0f);
+        std::fill(m_sumIm.begin(), m_sumIm.end(), 0.0f);
+    }
+
+    void UniformConvolver::accumulate(size_t first, size_t last)
+    {
+        const size_t numPartitions = m_partitions.numPartitions;
+        for(size_t p = first; p < last; ++p)
+        {
+            // Partition p lines up with the input from p blocks ago
+            const size_t slot = (m_newest + numPartitions - p) % numPartitions;
+            multiplyAdd(&m_delayRe[slot * m_bins], &m_delayIm[slot * m_bins], &m_partitions.re[p * m_bins],
+                &m_partitions.im[p * m_bins], &m_sumRe[0], &m_sumIm[0], m_bins);
+        }
+    }
+
+    void UniformConvolver::finish(RealFFT& fft)
+    {
+        // The first block wrapped around from the end of the circular convolution, the last is what's wanted
+        fft.inverse(&m_sumRe[0], &m_sumIm[0], &m_time[0]);
+    }
+
+    void UniformConvolver::reset()
+    {
+        m_newest = 0;
+        std::fill(m_input.begin(), m_input.end(), 0.0f);
+        std::fill(m_delayRe.begin(), m_delayRe.end(), 0.0f);
+        std::fill(m_delayIm.begin(), m_delayIm.end(), 0.0f);
+        std::fill(m_sumRe.begin(), m_sumRe.end(), 0.0f);
+        std::fill(m_sumIm.begin(), m_sumIm.end(), 0.0f);
+        std::fill(m_time.begin(), m_time.end(), 0.0f);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // ConvolutionProcessor impl
+
+    ConvolutionProcessor::ConvolutionProcessor(const std::shared_ptr<const ConvolutionKernel>& kernel)
+        : m_kernel(kernel), m_headFFT(std::make_shared<RealFFT>(2 * kernel->blockSize())), m_channels(0), m_position(0),
+        m_tailStep(0)
+    {
+        if(m_kernel->tailBlockSize() != 0)
+            m_tailFFT = std::make_shared<RealFFT>(2 * m_kernel->tailBlockSize());
+    }
+
+    ConvolutionProcessor::~ConvolutionProcessor()
+    {
+    }
+
+    bool ConvolutionProcessor::process(const AudioPacket& in, AudioPacket& out)
+    {
+        const AudioFormat format = in.getAudioFormat();
+        if(format != out.getAudioFormat() || encodingOf(format) != FLOAT32)
+            return false;
+
+        out.resize(in.byteSize());
+        return processInto(makeSampleSpan<float>(in), makeSampleSpan<float>(out));
+    }
+
+    void ConvolutionProcessor::reset()
+    {
+        for(size_t channel = 0; channel < m_channels; ++channel)
+        {
+            m_heads[channel]->reset();
+            if(m_tailFFT)
+                m_tails[channel]->reset();
+        }
+        std::fill(m_input.begin(), m_input.end(), 0.0f);
+        std::fill(m_ready.begin(), m_ready.end(), 0.0f);
+        m_position = 0;
+        m_tailStep = 0;
+    }
+
+    bool ConvolutionProcessor::supportsInPlace() const
+    {
+        return true;
+    }
+
+    bool ConvolutionProcessor::processInPlace(SampleSpan<float> samples)
+    {
+        return processInto(samples, samples);
+    }
+
+    bool ConvolutionProcessor::processInto(SampleSpan<const float> in, SampleSpan<float> out)
+    {
+        if(in.numChannels() == 0 || in.numChannels() != out.numChannels() || in.numFrames() != out.numFrames())
+            return false;
+        if(in.numChannels() != m_channels)
+            configure(in.numChannels());
+
+        const size_t blockSize = m_kernel->blockSize();
+        for(size_t frame = 0; frame < in.numFrames(); ++frame)
+        {
+            // Read every channel before writing any, in case in and out are the same samples
+            for(size_t channel = 0; channel < m_channels; ++channel)
+                m_input[channel * blockSize + m_position] = in(frame, channel);
+            for(size_t channel = 0; channel < m_channels; ++channel)
+                out(frame, channel) = m_ready[channel * blockSize + m_position];
+
+            if(++m_position == blockSize)
+            {
+                m_position = 0;
+                runBlock();
+            }
+        }
+        return true;
+    }
+
+    void ConvolutionProcessor::configure(size_t channels)
+    {
+        m_channels = channels;
+        m_heads.clear();
+        m_tails.clear();
+        for(size_t channel = 0; channel < channels; ++channel)
+        {
+            const size_t response = channel % m_kernel->numResponses();
+            m_heads.push_back(std::make_shared<UniformConvolver>(m_kernel->head(response)));
+            if(m_tailFFT)
+                m_tails.push_back(std::make_shared<UniformConvolver>(m_kernel->tail(response)));
+        }
+
+        const size_t blockSize = m_kernel->blockSize();
+        m_input.assign(channels * blockSize, 0.0f);
+        m_ready.assign(channels * blockSize, 0.0f);
+        m_position = 0;
+        m_tailStep = 0;
+    }
+
+    void ConvolutionProcessor::runBlock()
+    {
+        const size_t blockSize = m_kernel->blockSize();
+        const size_t steps = (m_tailFFT ? m_kernel->tailBlockSize() / blockSize : 1);
+        for(size_t channel = 0; channel < m_channels; ++channel)
+        {
+            const float* input = &m_input[channel * blockSize];
+            float* ready = &m_ready[channel * blockSize];
+
+            UniformConvolver& head = *m_heads[channel];
+            head.write(input, 0, blockSize);
+            head.transform(*m_headFFT);
+            head.accumulate(0, head.numPartitions());
+            head.finish(*m_headFFT);
+            std::memcpy(ready, head.output(), blockSize * sizeof(float));
+
+            if(!m_tailFFT)
+                continue;
+
+            /*
+                The tail takes a step of its work every block. Its input is only complete once all of
+                its blocks are in, so the first step transforms the one before, and the last step
+                finishes the output played during the next tail block: two tail blocks after the
+                input that went into it. The block of zeros in front of the tail's partitions takes
+                the head's one block of latency back off that, so it lines up exactly.
+
+                Those two steps carry both of the tail's transforms, so channels are staggered over
+                the steps: each starts its tail blocks at a different block, and every block only
+                transforms its share of the channels. Before a channel's first tail block its input
+                was silence, so where it starts doesn't change what comes out.
+            */
+            UniformConvolver& tail = *m_tails[channel];
+            const size_t numPartitions = tail.numPartitions();
+            const size_t step = (m_tailStep + channel * steps / m_channels) % steps;
+            const size_t nextStep = (step + 1) % steps;
+            if(step == 0)
+                tail.transform(*m_tailFFT);
+            tail.write(input, step * blockSize, blockSize);
+            tail.accumulate(step * numPartitions / steps, (step + 1) * numPartitions / steps);
+            if(nextStep == 0)
+                tail.finish(*m_tailFFT);
+
+            const float* tailOutput = tail.output() + nextStep * blockSize;
+            for(size_t i = 0; i < blockSize; ++i)
+                ready[i] += tailOutput[i];
+        }
+        m_tailStep = (m_tailStep + 1) % steps;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Convolution impl
+
+    Convolution::Convolution(const std::vector<float>& impulseResponse, size_t blockSize, ConvolutionMode mode)
+        : AbstractFilter(nullptr, EFFECTS),
+        m_kernel(std::make_shared<ConvolutionKernel>(std::vector<std::vector<float>>(1, impulseResponse), blockSize, mode)),
+        m_processor(std::make_shared<ConvolutionProcessor>(m_kernel))
+    {
+    }
+
+    Convolution::Convolution(const std::vector<std::vector<float>>& impulseResponses, size_t blockSize,
+        ConvolutionMode mode)
+        : AbstractFilter(nullptr, EFFECTS), m_kernel(std::make_shared<ConvolutionKernel>(impulseResponses, blockSize, mode)),
+        m_processor(std::make_shared<ConvolutionProcessor>(m_kernel))
+    {
+    }
+
+    Convolution::~Convolution()
+    {
+    }
+
+    bool Convolution::transformPacket(const AudioPacket& in, AudioPacket& out) const
+    {
+        return m_processor->process(in, out);
+    }
+
+    std::string Convolution::name() const
+    {
+        static const std::string name("Partitioned convolution");
+        return name;
+    }
+
+    std::shared_ptr<FilterProcessor> Convolution::createProcessor() const
+    {
+        return std::make_shared<ConvolutionProcessor>(m_kernel);
+    }
+
+    bool Convolution::supportsInPlace() const
+    {
+        return true;
+    }
+
+    bool Convolution::processInPlace(SampleSpan<float> samples) const
+    {
+        return m_processor->processInPlace(samples);
+    }
+
+    bool Convolution::processInto(SampleSpan<const float> in, SampleSpan<float> out) const
+    {
+        return m_processor->processInto(in, out);
+    }
+
+    void Convolution::reset()
+    {
+        m_processor->reset();
+    }
+
+    size_t Convolution::blockSize() const
+    {
+        return m_kernel->blockSize();
+    }
+
+    size_t Convolution::latency() const
+    {
+        return m_kernel->blockSize();
+    }
+
+    ConvolutionMode Convolution::mode() const
+    {
+        return m_kernel->mode();
+    }
+
+}
+}
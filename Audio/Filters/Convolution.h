@@ -0,0 +1,154 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AbstractFilter.h"
+#include "FilterProcessor.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace DX {
+namespace Audio {
+
+    class ConvolutionKernel;
+    class UniformConvolver;
+    class RealFFT;
+
+    //! Defines how many blocks long the partitions of CONVOLUTION_NON_UNIFORM's tail are. Arbitrary for now, best results TBD
+    #ifndef CONVOLUTION_TAIL_BLOCKS
+        #define CONVOLUTION_TAIL_BLOCKS 16
+    #endif
+
+    /*! \brief ConvolutionMode picks how a Convolution cuts up its impulse response */
+    enum ConvolutionMode
+    {
+        CONVOLUTION_UNIFORM     = 0, /*!< Every partition is one block long */
+        CONVOLUTION_NON_UNIFORM = 1  /*!< Block long partitions up front, CONVOLUTION_TAIL_BLOCKS long ones after */
+    };
+
+    /*! \brief ConvolutionProcessor is one stream through a Convolution, see FilterProcessor */
+    class DXAUDIO_EXPORT ConvolutionProcessor : public FilterProcessor
+    {
+    public:
+        explicit ConvolutionProcessor(const std::shared_ptr<const ConvolutionKernel>& kernel);
+        ~ConvolutionProcessor();
+
+        /*! \return False if the packets differ in format or aren't FLOAT32 */
+        bool            process(const AudioPacket& in, AudioPacket& out);
+        /*! Forgets every sample carried over from earlier packets */
+        void            reset();
+        bool            supportsInPlace() const;
+        bool            processInPlace(SampleSpan<float> samples);
+        bool            processInto(SampleSpan<const float> in, SampleSpan<float> out);
+
+    private:
+        void            configure(size_t channels);
+        void            runBlock(); // Once a block of every channel is in
+
+        const std::shared_ptr<const ConvolutionKernel>  m_kernel;
+        std::shared_ptr<RealFFT>                        m_headFFT;
+        std::shared_ptr<RealFFT>                        m_tailFFT; // Null without a tail
+        std::vector<std::shared_ptr<UniformConvolver>>  m_heads; // Per channel
+        std::vector<std::shared_ptr<UniformConvolver>>  m_tails; // Per channel, if there's a tail
+        size_t                                          m_channels;
+        std::vector<float>                              m_input; // Per channel, the block being filled
+        std::vector<float>                              m_ready; // Per channel, the block being played out
+        size_t                                          m_position; // Frames into the current block
+        size_t                                          m_tailStep; // Blocks into channel 0's tail block, the rest are staggered
+    };
+
+    /*! \brief Convolution filters audio through impulse responses of any length - reverbs,
+        speaker and room correction - with uniformly partitioned overlap-save FFT convolution.
+
+        The impulse response is cut into partitions one block long, each transformed once up front.
+        Every block of input is transformed once too, and goes into a frequency-domain delay line of
+        the spectra of the blocks before it; a block of output is then the inverse transform of the
+        sum of each partition's spectrum times the spectrum of the input block that lines up with it.
+        That's O(log blockSize) work per sample for the transforms, where a direct form FIR would do
+        one multiply per tap, and the complex multiply-adds run four bins at a time with SSE where
+        it's available. Latency is one block.
+
+        The multiply-adds still grow with the impulse response, by one block's worth per partition.
+        CONVOLUTION_NON_UNIFORM keeps block long partitions for the start of the response only, and
+        covers the rest with partitions CONVOLUTION_TAIL_BLOCKS blocks long, which need that many
+        times fewer multiply-adds per sample. The tail's multiply-adds are worked on a slice at a
+        time, every block, and latency is still one block. Its transforms come once per tail block,
+        so each channel's tail starts at a different block: given at least CONVOLUTION_TAIL_BLOCKS
+        channels every block transforms its share and costs about the same, and with fewer the
+        blocks that transform cost more than the rest. For room correction length responses (64k
+        taps) at a 256 frame block that's several times less work than CONVOLUTION_UNIFORM; how
+        much depends on the machine, which "DXTest convolution" measures.
+
+        Each channel is filtered by its own impulse response, wrapping around when there are more
+        channels than responses - one response filters every channel the same. Samples are FLOAT32,
+        in either layout, and a Convolution runs in place (see AbstractFilter::processInPlace()).
+
+        Partitions are shared by every stream, and each stream keeps its delay lines in a
+        ConvolutionProcessor, from createProcessor(). transformPacket() runs through one built in,
+        which makes calling it directly good for one stream at a time.
+
+        \code
+        Convolution roomCorrection(impulseResponses, 256, CONVOLUTION_NON_UNIFORM);
+        playbackDevice->writeToBuffer(captureStream, roomCorrection, callback);
+        \endcode
+    */
+    struct DXAUDIO_EXPORT Convolution : public AbstractFilter
+    {
+        /*! \param[in] impulseResponse  Filters every channel
+            \param[in] blockSize        Frames per partition, rounded up to a power of two. Also the latency.
+        */
+        explicit Convolution(const std::vector<float>& impulseResponse, size_t blockSize = 256,
+            ConvolutionMode mode = CONVOLUTION_UNIFORM);
+        /*! \param[in] impulseResponses One per channel */
+        explicit Convolution(const std::vector<std::vector<float>>& impulseResponses, size_t blockSize = 256,
+            ConvolutionMode mode = CONVOLUTION_UNIFORM);
+        ~Convolution();
+
+        /*! \return False if the packets differ in format or aren't FLOAT32 */
+        bool            transformPacket(const AudioPacket& in, AudioPacket& out) const;
+        std::string     name() const;
+        std::shared_ptr<FilterProcessor> createProcessor() const;
+        bool            supportsInPlace() const;
+        bool            processInPlace(SampleSpan<float> samples) const;
+        bool            processInto(SampleSpan<const float> in, SampleSpan<float> out) const;
+
+        /*! Forgets any samples transformPacket() carried over from earlier packets */
+        void            reset();
+
+        size_t          blockSize() const;
+        size_t          latency() const; /*!< In frames, one block */
+        ConvolutionMode mode() const;
+
+    private:
+        const std::shared_ptr<const ConvolutionKernel>  m_kernel;
+        const std::shared_ptr<ConvolutionProcessor>     m_processor; // What transformPacket() streams through
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        Convolution(const Convolution&);
+        Convolution(Convolution&&);
+    };
+
+}
+}
@@ -0,0 +1,335 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FFT.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <thread>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define DX_FFT_SSE
+#endif
+
+#if defined(DX_FFT_SSE)
+    #include <xmmintrin.h>
+#endif
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // FFTTwiddles
+
+    static const double PI = 3.14159265358979323846;
+
+    /*
+        The twiddle factors W^k = e^(-2 pi i k / size) for k in [0, size / 2), split like everything
+        else. Every pass of a Stockham FFT of this size indexes into the same table.
+    */
+    class FFTTwiddles
+    {
+    public:
+        explicit FFTTwiddles(size_t size);
+
+        static std::shared_ptr<const FFTTwiddles> get(size_t size);
+
+        const float*    re() const { return m_re.empty() ? nullptr : &m_re[0]; }
+        const float*    im() const { return m_im.empty() ? nullptr : &m_im[0]; }
+
+    private:
+        std::vector<float>  m_re;
+        std::vector<float>  m_im;
+    };
+
+    FFTTwiddles::FFTTwiddles(size_t size) : m_re(size / 2), m_im(size / 2)
+    {
+        for(size_t k = 0; k < size / 2; ++k)
+        {
+            const double angle = 2.0 * PI * double(k) / double(size);
+            m_re[k] = static_cast<float>(std::cos(angle));
+            m_im[k] = static_cast<float>(-std::sin(angle));
+        }
+    }
+
+    // Twiddles are built when an FFT is constructed, never while it runs, a plain spin is plenty
+    static std::atomic<bool> s_twiddleLock(false);
+    static std::map<size_t, std::shared_ptr<const FFTTwiddles>> s_twiddles;
+
+    std::shared_ptr<const FFTTwiddles> FFTTwiddles::get(size_t size)
+    {
+        while(s_twiddleLock.exchange(true, std::memory_order_acquire))
+            std::this_thread::yield();
+
+        std::shared_ptr<const FFTTwiddles>& twiddles = s_twiddles[size];
+        if(!twiddles)
+            twiddles = std::make_shared<FFTTwiddles>(size);
+        const std::shared_ptr<const FFTTwiddles> ret = twiddles;
+
+        s_twiddleLock.store(false, std::memory_order_release);
+        return ret;
+    }
+
+    /*
+        One radix-2 Stockham pass. x holds stride interleaved transforms of length n; each is split
+        into its even and odd halves, which land in y as stride * 2 interleaved transforms of length
+        n / 2. n * stride is always the full size, so butterfly p of every one of them shares the
+        twiddle W^(p * stride).
+    */
+    static void stockhamPass(const float* xRe, const float* xIm, float* yRe, float* yIm, size_t n, size_t stride,
+        const float* twiddleRe, const float* twiddleIm)
+    {
+        const size_t half = n / 2;
+        for(size_t p = 0; p < half; ++p)
+        {
+            const float wRe = twiddleRe[p * stride];
+            const float wIm = twiddleIm[p * stride];
+            const float* aRe = xRe + stride * p;
+            const float* aIm = xIm + stride * p;
+            const float* bRe = xRe + stride * (p + half);
+            const float* bIm = xIm + stride * (p + half);
+            float* sumRe = yRe + stride * (2 * p);
+            float* sumIm = yIm + stride * (2 * p);
+            float* differenceRe = yRe + stride * (2 * p + 1);
+            float* differenceIm = yIm + stride * (2 * p + 1);
+
+            size_t q = 0;
+        #if defined(DX_FFT_SSE)
+            const __m128 vwRe = _mm_set1_ps(wRe);
+            const __m128 vwIm = _mm_set1_ps(wIm);
+            for(; q + 4 <= stride; q += 4)
+            {
+                const __m128 ar = _mm_loadu_ps(aRe + q);
+                const __m128 ai = _mm_loadu_ps(aIm + q);
+                const __m128 br = _mm_loadu_ps(bRe + q);
+                const __m128 bi = _mm_loadu_ps(bIm + q);
+                const __m128 dr = _mm_sub_ps(ar, br);
+                const __m128 di = _mm_sub_ps(ai, bi);
+                _mm_storeu_ps(sumRe + q, _mm_add_ps(ar, br));
+                _mm_storeu_ps(sumIm + q, _mm_add_ps(ai, bi));
+                _mm_storeu_ps(differenceRe + q, _mm_sub_ps(_mm_mul_ps(dr, vwRe), _mm_mul_ps(di, vwIm)));
+                _mm_storeu_ps(differenceIm + q, _mm_add_ps(_mm_mul_ps(dr, vwIm), _mm_mul_ps(di, vwRe)));
+            }
+        #endif
+            for(; q < stride; ++q)
+            {
+                const float dr = aRe[q] - bRe[q];
+                const float di = aIm[q] - bIm[q];
+                sumRe[q] = aRe[q] + bRe[q];
+                sumIm[q] = aIm[q] + bIm[q];
+                differenceRe[q] = dr * wRe - di * wIm;
+                differenceIm[q] = dr * wIm + di * wRe;
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // FFT impl
+
+    FFT::FFT(size_t size)
+        : m_size(roundUp(size)), m_twiddles(FFTTwiddles::get(m_size)), m_workRe(m_size), m_workIm(m_size)
+    {
+    }
+
+    FFT::~FFT()
+    {
+    }
+
+    void FFT::forward(const float* inRe, const float* inIm, float* outRe, float* outIm)
+    {
+        transform(inRe, inIm, outRe, outIm);
+    }
+
+    void FFT::inverse(const float* inRe, const float* inIm, float* outRe, float* outIm)
+    {
+        // Swapping the real and imaginary parts on the way in and out turns the forward transform into
+        // the inverse one, unscaled
+        transform(inIm, inRe, outIm, outRe);
+
+        const float scale = 1.0f / static_cast<float>(m_size);
+        for(size_t i = 0; i < m_size; ++i)
+        {
+            outRe[i] *= scale;
+            outIm[i] *= scale;
+        }
+    }
+
+    size_t FFT::size() const
+    {
+        return m_size;
+    }
+
+    size_t FFT::roundUp(size_t size)
+    {
+        size_t ret = 1;
+        while(ret < size)
+            ret <<= 1;
+        return ret;
+    }
+
+    void FFT::transform(const float* inRe, const float* inIm, float* outRe, float* outIm)
+    {
+        size_t passes = 0;
+        for(size_t n = m_size; n > 1; n >>= 1)
+            ++passes;
+
+        float* workRe = &m_workRe[0];
+        float* workIm = &m_workIm[0];
+        const float* fromRe = inRe;
+        const float* fromIm = inIm;
+        float* toRe = outRe;
+        float* toIm = outIm;
+        if(inRe == outRe)
+        {
+            // Working in place, so the first pass reads a copy
+            std::memcpy(workRe, inRe, m_size * sizeof(float));
+            std::memcpy(workIm, inIm, m_size * sizeof(float));
+            fromRe = workRe;
+            fromIm = workIm;
+        }
+        else if(passes % 2 == 0)
+        {
+            // Passes alternate between out and the work buffer; start wherever ends up in out
+            toRe = workRe;
+            toIm = workIm;
+        }
+
+        for(size_t n = m_size, stride = 1; n > 1; n >>= 1, stride <<= 1)
+        {
+            stockhamPass(fromRe, fromIm, toRe, toIm, n, stride, m_twiddles->re(), m_twiddles->im());
+            fromRe = toRe;
+            fromIm = toIm;
+            toRe = (toRe == outRe ? workRe : outRe);
+            toIm = (toIm == outIm ? workIm : outIm);
+        }
+
+        if(fromRe != outRe)
+        {
+            std::memcpy(outRe, fromRe, m_size * sizeof(float));
+            std::memcpy(outIm, fromIm, m_size * sizeof(float));
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // RealFFT impl
+
+    RealFFT::RealFFT(size_t size)
+        : m_size(FFT::roundUp(size < 2 ? 2 : size)), m_half(m_size / 2), m_twiddles(FFTTwiddles::get(m_size)),
+        m_packedRe(m_size / 2), m_packedIm(m_size / 2)
+    {
+    }
+
+    RealFFT::~RealFFT()
+    {
+    }
+
+    void RealFFT::forward(const float* in, float* outRe, float* outIm)
+    {
+        // Even samples as the real parts, odd ones as the imaginary parts, through a half size FFT
+        const size_t half = m_size / 2;
+        float* zRe = &m_packedRe[0];
+        float* zIm = &m_packedIm[0];
+        for(size_t k = 0; k < half; ++k)
+        {
+            zRe[k] = in[2 * k];
+            zIm[k] = in[2 * k + 1];
+        }
+        m_half.forward(zRe, zIm, zRe, zIm);
+
+        /*
+            Untangle the spectra of the even (E) and odd (O) samples from Z, using the symmetry of real
+            signals' spectra, then combine them: X[k] = E[k] + W^k O[k]
+        */
+        const float* twiddleRe = m_twiddles->re();
+        const float* twiddleIm = m_twiddles->im();
+        for(size_t k = 0; k <= half; ++k)
+        {
+            const size_t index = (k == half ? 0 : k);
+            const size_t mirror = (k == 0 ? 0 : half - k);
+            const float re = zRe[index];
+            const float im = zIm[index];
+            const float mirrorRe = zRe[mirror];
+            const float mirrorIm = -zIm[mirror];
+
+            const float evenRe = 0.5f * (re + mirrorRe);
+            const float evenIm = 0.5f * (im + mirrorIm);
+            const float oddRe = 0.5f * (im - mirrorIm);
+            const float oddIm = -0.5f * (re - mirrorRe);
+
+            const float wRe = (k == half ? -1.0f : twiddleRe[k]);
+            const float wIm = (k == half ? 0.0f : twiddleIm[k]);
+            outRe[k] = evenRe + wRe * oddRe - wIm * oddIm;
+            outIm[k] = evenIm + wRe * oddIm + wIm * oddRe;
+        }
+        outIm[0] = 0.0f;
+        outIm[half] = 0.0f;
+    }
+
+    void RealFFT::inverse(const float* inRe, const float* inIm, float* out)
+    {
+        // The forward untangling run backwards: E[k] and O[k] from X[k] and X[half - k], then Z = E + iO
+        const size_t half = m_size / 2;
+        float* zRe = &m_packedRe[0];
+        float* zIm = &m_packedIm[0];
+        const float* twiddleRe = m_twiddles->re();
+        const float* twiddleIm = m_twiddles->im();
+        for(size_t k = 0; k < half; ++k)
+        {
+            const float re = inRe[k];
+            const float im = inIm[k];
+            const float mirrorRe = inRe[half - k];
+            const float mirrorIm = -inIm[half - k];
+
+            const float evenRe = 0.5f * (re + mirrorRe);
+            const float evenIm = 0.5f * (im + mirrorIm);
+            const float differenceRe = 0.5f * (re - mirrorRe);
+            const float differenceIm = 0.5f * (im - mirrorIm);
+            // Divided by W^k, which is multiplied by its conjugate
+            const float oddRe = differenceRe * twiddleRe[k] + differenceIm * twiddleIm[k];
+            const float oddIm = differenceIm * twiddleRe[k] - differenceRe * twiddleIm[k];
+
+            zRe[k] = evenRe - oddIm;
+            zIm[k] = evenIm + oddRe;
+        }
+        m_half.inverse(zRe, zIm, zRe, zIm);
+
+        for(size_t k = 0; k < half; ++k)
+        {
+            out[2 * k] = zRe[k];
+            out[2 * k + 1] = zIm[k];
+        }
+    }
+
+    size_t RealFFT::size() const
+    {
+        return m_size;
+    }
+
+    size_t RealFFT::numBins() const
+    {
+        return m_size / 2 + 1;
+    }
+
+}
+}
@@ -0,0 +1,136 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../DXAudioExport.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace DX {
+namespace Audio {
+
+    class FFTTwiddles;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // FFT
+
+    /*! \brief FFT is a complex fast Fourier transform of a fixed power of two size.
+
+        Stockham's autosort formulation: every pass reads one buffer and writes the other, in order,
+        so there's no bit-reversal pass and every access is sequential. Passes with four or more
+        butterflies sharing a twiddle run four at a time with SSE where it's available.
+
+        Complex numbers are split - real parts in one array, imaginary parts in another - which is
+        what lets the passes vectorize without shuffling. forward() is unscaled, inverse() scales by
+        1 / size(), so one after the other gives back what went in.
+
+        Twiddle factors are computed once per size and shared by every FFT (and RealFFT) of that size;
+        an FFT itself only owns its work buffer, so it's cheap to have one per thread or stream. Each
+        FFT must be used by one thread at a time.
+
+        \code
+        FFT fft(1024);
+        fft.forward(re, im, spectrumRe, spectrumIm);
+        // ...
+        fft.inverse(spectrumRe, spectrumIm, re, im);
+        \endcode
+    */
+    class DXAUDIO_EXPORT FFT
+    {
+    public:
+        /*! \param[in] size A power of two, rounded up to one if it isn't */
+        explicit FFT(size_t size);
+        ~FFT();
+
+        /*! Transforms size() complex samples. in and out may be the same arrays. */
+        void    forward(const float* inRe, const float* inIm, float* outRe, float* outIm);
+        /*! Inverse transform, scaled by 1 / size(). in and out may be the same arrays. */
+        void    inverse(const float* inRe, const float* inIm, float* outRe, float* outIm);
+
+        size_t  size() const;
+
+        /*! \return size rounded up to a power of two */
+        static size_t roundUp(size_t size);
+
+    private:
+        void    transform(const float* inRe, const float* inIm, float* outRe, float* outIm);
+
+        const size_t                        m_size;
+        std::shared_ptr<const FFTTwiddles>  m_twiddles;
+        std::vector<float>                  m_workRe;
+        std::vector<float>                  m_workIm;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        FFT(const FFT&);
+        FFT(FFT&&);
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // RealFFT
+
+    /*! \brief RealFFT transforms size() real samples into the size() / 2 + 1 bins that describe them
+        (the rest mirror those), and back.
+
+        It packs the real samples into a complex FFT of half the size and untangles the result, so
+        it costs about half what a complex FFT of the full size would. Bin 0 is DC and bin size() / 2
+        is Nyquist; both have zero imaginary parts. forward() is unscaled, inverse() scales by
+        1 / size(), just like FFT.
+
+        \note A RealFFT must be used by one thread at a time.
+    */
+    class DXAUDIO_EXPORT RealFFT
+    {
+    public:
+        /*! \param[in] size A power of two, at least 2, rounded up to one if it isn't */
+        explicit RealFFT(size_t size);
+        ~RealFFT();
+
+        /*! Transforms size() samples into numBins() bins */
+        void    forward(const float* in, float* outRe, float* outIm);
+        /*! Turns numBins() bins back into size() samples, scaled by 1 / size() */
+        void    inverse(const float* inRe, const float* inIm, float* out);
+
+        size_t  size() const;
+        size_t  numBins() const; /*!< size() / 2 + 1 */
+
+    private:
+        const size_t                        m_size;
+        FFT                                 m_half;
+        std::shared_ptr<const FFTTwiddles>  m_twiddles; // For the full size, to untangle the halves
+        std::vector<float>                  m_packedRe;
+        std::vector<float>                  m_packedIm;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        RealFFT(const RealFFT&);
+        RealFFT(RealFFT&&);
+    };
+
+}
+}
@@ -0,0 +1,598 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FilterGraph.h"
+#include "FilterProcessor.h"
+#include "../AudioPacket.h"
+#include "../SampleConversion.h"
+#include "../SampleSpan.h"
+
+#include <LockFree/Mutex/SenseReversingBarrier.h>
+//#include <DX/LockFree/Mutex/SenseReversingBarrier.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // FilterGraphProcessor
+
+    // Slots of nodes that don't have one (the input, dead nodes), and of the output, which is out itself
+    static const size_t NO_SLOT = static_cast<size_t>(-1);
+    static const size_t OUTPUT_SLOT = static_cast<size_t>(-2);
+
+    /*! \brief FilterGraphProcessor is one stream through a FilterGraph, see FilterProcessor */
+    class FilterGraphProcessor : public FilterProcessor
+    {
+    public:
+        typedef FilterGraph::NodeId NodeId;
+
+        FilterGraphProcessor(const FilterGraph& graph);
+        ~FilterGraphProcessor();
+
+        bool            process(const AudioPacket& in, AudioPacket& out);
+        void            reset();
+
+    private:
+        void            schedule();
+        bool            configure(const AudioFormat& inFormat, const AudioFormat& outFormat);
+        bool            runsInPlace(NodeId node) const;
+        bool            runLevel(size_t level, size_t thread);
+        bool            runNode(NodeId node);
+        bool            runFilter(NodeId node);
+        bool            runMix(NodeId node);
+        void            work(size_t thread);
+
+        const AudioPacket&  result(NodeId node) const;
+        AudioPacket&        target(NodeId node);
+
+        const std::vector<FilterGraph::Node>            m_nodes;
+        const NodeId                                    m_output;
+        std::vector<std::shared_ptr<FilterProcessor>>   m_processors; // Per filter node, null for dead ones
+        std::vector<std::vector<NodeId>>                m_levels; // Live nodes by distance from the input
+        std::vector<size_t>                             m_lastUse; // Per node, the last level that reads it
+        std::vector<size_t>                             m_readers; // Per node, how many live nodes read it
+
+        // Planned by configure(), for the formats last seen
+        bool                                            m_configured;
+        AudioFormat                                     m_inFormat;
+        AudioFormat                                     m_outFormat;
+        std::vector<AudioFormat>                        m_formats; // Per node
+        std::vector<size_t>                             m_slotOf; // Per node, which of m_slots its output is in
+        std::vector<bool>                               m_inPlace; // Per node, runs over its source's slot
+        std::vector<AudioPacket>                        m_slots;
+
+        // Only valid during process()
+        const AudioPacket*                              m_in;
+        AudioPacket*                                    m_out;
+
+        // Worker threads, one less than the threads running a level (the caller's is the other)
+        size_t                                          m_numThreads;
+        std::unique_ptr<LockFree::SenseReversingBarrier> m_barrier;
+        std::vector<std::thread>                        m_workers;
+        std::atomic<size_t>                             m_level;
+        std::atomic<bool>                               m_failed;
+        std::atomic<bool>                               m_stopping;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        FilterGraphProcessor(const FilterGraphProcessor&);
+        FilterGraphProcessor(FilterGraphProcessor&&);
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // FilterGraph impl
+
+    FilterGraph::FilterGraph(size_t numThreads)
+        : AbstractFilter(nullptr, UNKNOWN), m_output(0), m_hasOutput(false),
+        m_numThreads(numThreads > 0 ? numThreads : 1)
+    {
+        Node input;
+        input.kind = INPUT_NODE;
+        input.hasFormat = false;
+        input.format = AudioFormat();
+        m_nodes.push_back(input);
+    }
+
+    FilterGraph::~FilterGraph()
+    {
+    }
+
+    FilterGraph::NodeId FilterGraph::input() const
+    {
+        return 0;
+    }
+
+    FilterGraph::NodeId FilterGraph::addFilter(const std::shared_ptr<AbstractFilter>& filter, NodeId source)
+    {
+        if(!filter)
+            return INVALID_NODE;
+
+        Node node;
+        node.kind = FILTER_NODE;
+        node.filter = filter;
+        node.sources.push_back(source);
+        node.hasFormat = false;
+        node.format = AudioFormat();
+        return addNode(node);
+    }
+
+    FilterGraph::NodeId FilterGraph::addFilter(const std::shared_ptr<AbstractFilter>& filter, NodeId source,
+        const AudioFormat& format)
+    {
+        if(!filter)
+            return INVALID_NODE;
+
+        Node node;
+        node.kind = FILTER_NODE;
+        node.filter = filter;
+        node.sources.push_back(source);
+        node.hasFormat = true;
+        node.format = format;
+        return addNode(node);
+    }
+
+    FilterGraph::NodeId FilterGraph::addMix(const std::vector<NodeId>& sources, const std::vector<float>& gains)
+    {
+        if(sources.empty())
+            return INVALID_NODE;
+
+        Node node;
+        node.kind = MIX_NODE;
+        node.sources = sources;
+        node.gains = gains;
+        node.gains.resize(sources.size(), 1.0f);
+        node.hasFormat = false;
+        node.format = AudioFormat();
+        return addNode(node);
+    }
+
+    bool FilterGraph::setOutput(NodeId node)
+    {
+        if(node >= m_nodes.size())
+            return false;
+
+        m_output = node;
+        m_hasOutput = true;
+        m_processor.reset();
+        return true;
+    }
+
+    FilterGraph::NodeId FilterGraph::output() const
+    {
+        return m_output;
+    }
+
+    size_t FilterGraph::numNodes() const
+    {
+        return m_nodes.size();
+    }
+
+    size_t FilterGraph::numThreads() const
+    {
+        return m_numThreads;
+    }
+
+    bool FilterGraph::transformPacket(const AudioPacket& in, AudioPacket& out) const
+    {
+        if(!m_processor)
+            m_processor = createProcessor();
+        return m_processor->process(in, out);
+    }
+
+    std::string FilterGraph::name() const
+    {
+        static const std::string name("Filter graph");
+        return name;
+    }
+
+    std::shared_ptr<FilterProcessor> FilterGraph::createProcessor() const
+    {
+        return std::make_shared<FilterGraphProcessor>(*this);
+    }
+
+    void FilterGraph::reset()
+    {
+        m_processor.reset();
+    }
+
+    FilterGraph::NodeId FilterGraph::addNode(const Node& node)
+    {
+        // Sources must already exist, which is what keeps the graph acyclic
+        for(NodeId source : node.sources)
+        {
+            if(source >= m_nodes.size())
+                return INVALID_NODE;
+        }
+
+        m_nodes.push_back(node);
+        if(!m_hasOutput)
+            m_output = m_nodes.size() - 1;
+        m_processor.reset();
+        return m_nodes.size() - 1;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // FilterGraphProcessor impl
+
+    FilterGraphProcessor::FilterGraphProcessor(const FilterGraph& graph)
+        : m_nodes(graph.m_nodes), m_output(graph.m_output), m_configured(false), m_in(nullptr),
+        m_out(nullptr), m_numThreads(1), m_level(0), m_failed(false), m_stopping(false)
+    {
+        schedule();
+
+        size_t widest = 0;
+        for(const std::vector<NodeId>& level : m_levels)
+            widest = std::max(widest, level.size());
+        m_numThreads = std::min(graph.numThreads(), widest);
+        if(m_numThreads > 1)
+        {
+            m_barrier.reset(new LockFree::SenseReversingBarrier(m_numThreads));
+            for(size_t thread = 1; thread < m_numThreads; ++thread)
+                m_workers.push_back(std::thread(&FilterGraphProcessor::work, this, thread));
+        }
+        else
+        {
+            m_numThreads = 1;
+        }
+    }
+
+    FilterGraphProcessor::~FilterGraphProcessor()
+    {
+        if(!m_workers.empty())
+        {
+            m_stopping.store(true, std::memory_order_release);
+            m_barrier->wait();
+            for(std::thread& worker : m_workers)
+                worker.join();
+        }
+    }
+
+    bool FilterGraphProcessor::process(const AudioPacket& in, AudioPacket& out)
+    {
+        if(!m_configured || in.getAudioFormat() != m_inFormat || out.getAudioFormat() != m_outFormat)
+        {
+            if(!configure(in.getAudioFormat(), out.getAudioFormat()))
+                return false;
+        }
+
+        if(m_output == 0)
+        {
+            // Nothing but the input, which only needs converting
+            out.resize(in.byteSize() / m_inFormat.bitsPerBlock * m_outFormat.bitsPerBlock);
+            return SampleConversion::convert(in, out);
+        }
+
+        m_in = &in;
+        m_out = &out;
+        m_failed.store(false, std::memory_order_relaxed);
+        for(size_t level = 1; level < m_levels.size(); ++level)
+        {
+            if(m_numThreads == 1 || m_levels[level].size() == 1)
+            {
+                if(!runLevel(level, 0))
+                    m_failed.store(true, std::memory_order_relaxed);
+            }
+            else
+            {
+                // Start the workers on this level, run our share and wait for theirs
+                m_level.store(level, std::memory_order_relaxed);
+                m_barrier->wait();
+                if(!runLevel(level, 0))
+                    m_failed.store(true, std::memory_order_relaxed);
+                m_barrier->wait();
+            }
+
+            if(m_failed.load(std::memory_order_relaxed))
+                break;
+        }
+        m_in = nullptr;
+        m_out = nullptr;
+
+        if(m_failed.load(std::memory_order_relaxed))
+            return false;
+        out.setTimestamp(in.getTimestamp());
+        return true;
+    }
+
+    void FilterGraphProcessor::reset()
+    {
+        for(const std::shared_ptr<FilterProcessor>& processor : m_processors)
+        {
+            if(processor)
+                processor->reset();
+        }
+    }
+
+    void FilterGraphProcessor::schedule()
+    {
+        const size_t numNodes = m_nodes.size();
+
+        // Only nodes the output depends on are run. Sources always come before their readers, so one
+        // backwards pass finds them all.
+        std::vector<bool> live(numNodes, false);
+        live[m_output] = true;
+        for(size_t node = numNodes; node-- > 0;)
+        {
+            if(!live[node])
+                continue;
+            for(NodeId source : m_nodes[node].sources)
+                live[source] = true;
+        }
+
+        // A node's level is one past its furthest source, so everything in a level can run at once
+        std::vector<size_t> levelOf(numNodes, 0);
+        m_processors.assign(numNodes, nullptr);
+        m_lastUse.assign(numNodes, 0);
+        m_readers.assign(numNodes, 0);
+        m_levels.assign(1, std::vector<NodeId>(1, 0));
+        for(NodeId node = 1; node < numNodes; ++node)
+        {
+            if(!live[node])
+                continue;
+
+            const FilterGraph::Node& description = m_nodes[node];
+            for(NodeId source : description.sources)
+                levelOf[node] = std::max(levelOf[node], levelOf[source] + 1);
+            for(NodeId source : description.sources)
+            {
+                m_lastUse[source] = std::max(m_lastUse[source], levelOf[node]);
+                ++m_readers[source];
+            }
+
+            if(m_levels.size() <= levelOf[node])
+                m_levels.resize(levelOf[node] + 1);
+            m_levels[levelOf[node]].push_back(node);
+
+            if(description.kind == FilterGraph::FILTER_NODE)
+                m_processors[node] = description.filter->createProcessor();
+        }
+    }
+
+    bool FilterGraphProcessor::configure(const AudioFormat& inFormat, const AudioFormat& outFormat)
+    {
+        m_configured = false;
+        if(inFormat.bitsPerBlock == 0 || outFormat.bitsPerBlock == 0)
+            return false;
+
+        // What each node produces
+        const size_t numNodes = m_nodes.size();
+        m_formats.assign(numNodes, AudioFormat());
+        m_formats[0] = inFormat;
+        for(size_t level = 1; level < m_levels.size(); ++level)
+        {
+            for(NodeId node : m_levels[level])
+            {
+                const FilterGraph::Node& description = m_nodes[node];
+                if(description.kind == FilterGraph::FILTER_NODE && !m_processors[node])
+                    return false;
+
+                AudioFormat& format = m_formats[node];
+                format = description.hasFormat ? description.format : m_formats[description.sources.front()];
+                if(node == m_output)
+                {
+                    if(description.hasFormat && description.format != outFormat)
+                        return false;
+                    format = outFormat;
+                }
+                if(format.bitsPerBlock == 0)
+                    return false;
+
+                if(description.kind == FilterGraph::MIX_NODE)
+                {
+                    if(encodingOf(format) != FLOAT32)
+                        return false;
+                    for(NodeId source : description.sources)
+                    {
+                        const AudioFormat& sourceFormat = m_formats[source];
+                        if(encodingOf(sourceFormat) != FLOAT32 || sourceFormat.channels != format.channels
+                            || sourceFormat.samplesPerSecond != format.samplesPerSecond)
+                            return false;
+                    }
+                }
+            }
+        }
+
+        /*
+            Hand out slots level by level, like registers. A node's slot is free again once the last
+            level reading it is done - but not before, since everything within a level may run at
+            once. In place filters take their source's slot over instead of getting one of their own.
+        */
+        m_slotOf.assign(numNodes, NO_SLOT);
+        m_inPlace.assign(numNodes, false);
+        std::vector<size_t> freeSlots;
+        size_t numSlots = 0;
+        for(size_t level = 1; level < m_levels.size(); ++level)
+        {
+            for(NodeId node : m_levels[level])
+            {
+                if(node == m_output)
+                {
+                    m_slotOf[node] = OUTPUT_SLOT;
+                }
+                else if(runsInPlace(node))
+                {
+                    m_slotOf[node] = m_slotOf[m_nodes[node].sources.front()];
+                    m_inPlace[node] = true;
+                }
+                else if(!freeSlots.empty())
+                {
+                    m_slotOf[node] = freeSlots.back();
+                    freeSlots.pop_back();
+                }
+                else
+                {
+                    m_slotOf[node] = numSlots++;
+                }
+            }
+
+            for(NodeId node : m_levels[level])
+            {
+                if(m_inPlace[node])
+                    continue;
+                for(NodeId source : m_nodes[node].sources)
+                {
+                    const size_t slot = m_slotOf[source];
+                    if(m_lastUse[source] != level || slot == NO_SLOT || slot == OUTPUT_SLOT)
+                        continue;
+                    if(std::find(freeSlots.begin(), freeSlots.end(), slot) == freeSlots.end())
+                        freeSlots.push_back(slot);
+                }
+            }
+        }
+
+        m_slots.reserve(numSlots);
+        while(m_slots.size() < numSlots)
+            m_slots.push_back(AudioPacket(AudioFormat(), 0));
+
+        m_inFormat = inFormat;
+        m_outFormat = outFormat;
+        m_configured = true;
+        return true;
+    }
+
+    bool FilterGraphProcessor::runsInPlace(NodeId node) const
+    {
+        const FilterGraph::Node& description = m_nodes[node];
+        if(description.kind != FilterGraph::FILTER_NODE || !m_processors[node]->supportsInPlace())
+            return false;
+
+        // Only the sole reader of an intermediate result may write over it
+        const NodeId source = description.sources.front();
+        return source != 0 && m_readers[source] == 1 && m_formats[node] == m_formats[source]
+            && encodingOf(m_formats[node]) == FLOAT32;
+    }
+
+    bool FilterGraphProcessor::runLevel(size_t level, size_t thread)
+    {
+        const std::vector<NodeId>& nodes = m_levels[level];
+        bool ok = true;
+        for(size_t i = thread; i < nodes.size(); i += m_numThreads)
+            ok = runNode(nodes[i]) && ok;
+        return ok;
+    }
+
+    bool FilterGraphProcessor::runNode(NodeId node)
+    {
+        if(m_nodes[node].kind == FilterGraph::MIX_NODE)
+            return runMix(node);
+        return runFilter(node);
+    }
+
+    bool FilterGraphProcessor::runFilter(NodeId node)
+    {
+        FilterProcessor& processor = *m_processors[node];
+        if(m_inPlace[node])
+            return processor.processInPlace(makeSampleSpan<float>(target(node)));
+
+        const NodeId source = m_nodes[node].sources.front();
+        const AudioPacket& in = result(source);
+        const AudioFormat& inFormat = m_formats[source];
+        const AudioFormat& outFormat = m_formats[node];
+        AudioPacket& out = target(node);
+
+        // Room for what the filter should make; filters that decide for themselves resize it
+        const size_t inFrames = in.byteSize() / inFormat.bitsPerBlock;
+        size_t outFrames = inFrames;
+        if(inFormat.samplesPerSecond != outFormat.samplesPerSecond && inFormat.samplesPerSecond > 0)
+            outFrames = static_cast<size_t>((static_cast<unsigned long long>(inFrames) * outFormat.samplesPerSecond
+                + inFormat.samplesPerSecond - 1) / inFormat.samplesPerSecond);
+        out.setAudioFormat(outFormat);
+        out.resize(outFrames * outFormat.bitsPerBlock);
+        out.setTimestamp(in.getTimestamp());
+
+        if(processor.supportsInPlace() && inFormat == outFormat && encodingOf(outFormat) == FLOAT32)
+            return processor.processInto(makeSampleSpan<float>(in), makeSampleSpan<float>(out));
+        return processor.process(in, out);
+    }
+
+    bool FilterGraphProcessor::runMix(NodeId node)
+    {
+        const FilterGraph::Node& description = m_nodes[node];
+        const AudioFormat& format = m_formats[node];
+
+        // Only the frames every source has
+        size_t frames = static_cast<size_t>(-1);
+        for(NodeId source : description.sources)
+            frames = std::min(frames, result(source).byteSize() / m_formats[source].bitsPerBlock);
+
+        AudioPacket& out = target(node);
+        out.setAudioFormat(format);
+        out.resize(frames * format.bitsPerBlock);
+        out.setTimestamp(result(description.sources.front()).getTimestamp());
+
+        const SampleSpan<float> mixed = makeSampleSpan<float>(out);
+        for(size_t i = 0; i < description.sources.size(); ++i)
+        {
+            const SampleSpan<const float> source = makeSampleSpan<float>(result(description.sources[i])).frames(0, frames);
+            const float gain = description.gains[i];
+            for(size_t frame = 0; frame < frames; ++frame)
+            {
+                for(size_t channel = 0; channel < format.channels; ++channel)
+                {
+                    if(i == 0)
+                        mixed(frame, channel) = gain * source(frame, channel);
+                    else
+                        mixed(frame, channel) += gain * source(frame, channel);
+                }
+            }
+        }
+        return true;
+    }
+
+    void FilterGraphProcessor::work(size_t thread)
+    {
+        while(true)
+        {
+            // Wait to be handed a level, run our share, and let the caller know it's done
+            m_barrier->wait();
+            if(m_stopping.load(std::memory_order_acquire))
+                return;
+            if(!runLevel(m_level.load(std::memory_order_relaxed), thread))
+                m_failed.store(true, std::memory_order_relaxed);
+            m_barrier->wait();
+        }
+    }
+
+    const AudioPacket& FilterGraphProcessor::result(NodeId node) const
+    {
+        if(node == 0)
+            return *m_in;
+        if(m_slotOf[node] == OUTPUT_SLOT)
+            return *m_out;
+        return m_slots[m_slotOf[node]];
+    }
+
+    AudioPacket& FilterGraphProcessor::target(NodeId node)
+    {
+        if(m_slotOf[node] == OUTPUT_SLOT)
+            return *m_out;
+        return m_slots[m_slotOf[node]];
+    }
+
+}
+}
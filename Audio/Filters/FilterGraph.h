@@ -0,0 +1,150 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AbstractFilter.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace DX {
+namespace Audio {
+
+    class FilterGraphProcessor;
+
+    /*! \brief FilterGraph composes filters into a directed acyclic graph - chains, splits (any node
+        may feed any number of others) and mixes - that runs as a single AbstractFilter, so it can be
+        handed to AudioPlaybackDevice::writeToBuffer() like any other.
+
+        Nodes can only be fed by nodes that already exist, which keeps the graph acyclic and the
+        order they were added in a valid order to run them. Each filter node runs through its own
+        FilterProcessor per stream, so stateful filters (PolyphaseResampler) stream correctly.
+
+        Before the first packet (and whenever the formats change) each stream plans its buffers the
+        way a compiler allocates registers: nodes are grouped into levels by their distance from the
+        input, every intermediate result gets a buffer for just the levels it's alive, and buffers
+        whose last reader has run are handed to later nodes. A filter that runs in place (see
+        AbstractFilter::supportsInPlace()) and is the only reader of its source simply takes the
+        source's buffer over, so gain / EQ / dynamics chains run in one buffer. The graph's input is
+        read where it is and its output is written straight into out. Nodes that don't lead to the
+        output are never run. Once the buffers have grown to fit, nothing allocates.
+
+        Nodes in the same level don't depend on each other. Given more than one thread, each stream
+        runs those levels in parallel, on worker threads of its own that meet at a
+        LockFree::SenseReversingBarrier after every level. That only pays off for heavy branches;
+        a single thread (the default) runs everything on the caller's thread.
+
+        Filter nodes get their source's packets as they are, and their output is in the format
+        given when they were added - the source's format if none was. The output node's format is
+        always out's. Mixes sum FLOAT32 sources of the same channels and rate, frame by frame, over
+        the frames every source has.
+
+        \code
+        FilterGraph graph;
+        FilterGraph::NodeId resampled = graph.addFilter(resampler, graph.input(), resampledFormat);
+        FilterGraph::NodeId mapped = graph.addFilter(channelMap, resampled, deviceFormat);
+        FilterGraph::NodeId equalized = graph.addFilter(equalizer, mapped);
+        graph.addFilter(limiter, equalized);
+        playbackDevice->writeToBuffer(captureStream, graph, callback);
+        \endcode
+    */
+    struct DXAUDIO_EXPORT FilterGraph : public AbstractFilter
+    {
+        typedef size_t NodeId;
+
+        //! Returned in place of a NodeId when a node couldn't be added
+        static const NodeId INVALID_NODE = static_cast<NodeId>(-1);
+
+        /*! \param[in] numThreads   How many threads (the caller's included) each stream may run
+                                    independent nodes on
+        */
+        explicit FilterGraph(size_t numThreads = 1);
+        ~FilterGraph();
+
+        /*! \return The node the graph's input comes out of */
+        NodeId          input() const;
+
+        /*! Adds a node running filter over source's output, in source's format.
+            \return The new node, or INVALID_NODE if filter is null or source doesn't exist
+        */
+        NodeId          addFilter(const std::shared_ptr<AbstractFilter>& filter, NodeId source);
+        /*! Adds a node running filter over source's output, producing format */
+        NodeId          addFilter(const std::shared_ptr<AbstractFilter>& filter, NodeId source, const AudioFormat& format);
+        /*! Adds a node summing sources, each scaled by its gain (1 for any not given).
+            \return The new node, or INVALID_NODE if there are no sources or any doesn't exist
+        */
+        NodeId          addMix(const std::vector<NodeId>& sources, const std::vector<float>& gains = std::vector<float>());
+
+        /*! Makes node the graph's output. Until this is called, the last node added is.
+            \return False if node doesn't exist
+        */
+        bool            setOutput(NodeId node);
+        NodeId          output() const;
+
+        size_t          numNodes() const; /*!< The input included */
+        size_t          numThreads() const;
+
+        /*! \return False if any node fails, or the graph can't run between in's and out's formats */
+        bool            transformPacket(const AudioPacket& in, AudioPacket& out) const;
+        std::string     name() const;
+        std::shared_ptr<FilterProcessor> createProcessor() const;
+
+        /*! Forgets any state transformPacket() carried over from earlier packets */
+        void            reset();
+
+    private:
+        friend class FilterGraphProcessor;
+
+        enum NodeKind
+        {
+            INPUT_NODE  = 0,
+            FILTER_NODE = 1,
+            MIX_NODE    = 2
+        };
+
+        struct Node
+        {
+            NodeKind                        kind;
+            std::shared_ptr<AbstractFilter> filter;
+            std::vector<NodeId>             sources;
+            std::vector<float>              gains; // Per source, mixes only
+            bool                            hasFormat;
+            AudioFormat                     format;
+        };
+
+        NodeId          addNode(const Node& node);
+
+        std::vector<Node>                       m_nodes;
+        NodeId                                  m_output;
+        bool                                    m_hasOutput; // setOutput() was called
+        const size_t                            m_numThreads;
+        mutable std::shared_ptr<FilterProcessor> m_processor; // What transformPacket() streams through, made on first use
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        FilterGraph(const FilterGraph&);
+        FilterGraph(FilterGraph&&);
+    };
+
+}
+}
@@ -0,0 +1,93 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FilterProcessor.h"
+
+namespace DX {
+namespace Audio {
+
+    FilterProcessor::FilterProcessor()
+    {
+    }
+
+    FilterProcessor::~FilterProcessor()
+    {
+    }
+
+    SampleLayout FilterProcessor::preferredLayout() const
+    {
+        return INTERLEAVED;
+    }
+
+    bool FilterProcessor::supportsInPlace() const
+    {
+        return false;
+    }
+
+    bool FilterProcessor::processInPlace(SampleSpan<float>)
+    {
+        return false;
+    }
+
+    bool FilterProcessor::processInto(SampleSpan<const float> in, SampleSpan<float> out)
+    {
+        if(!supportsInPlace() || !copySamples(in, out))
+            return false;
+        return processInPlace(out);
+    }
+
+    StatelessProcessor::StatelessProcessor(const AbstractFilter& filter) : m_filter(filter)
+    {
+    }
+
+    StatelessProcessor::~StatelessProcessor()
+    {
+    }
+
+    bool StatelessProcessor::process(const AudioPacket& in, AudioPacket& out)
+    {
+        return m_filter.transformPacket(in, out);
+    }
+
+    void StatelessProcessor::reset()
+    {
+    }
+
+    SampleLayout StatelessProcessor::preferredLayout() const
+    {
+        return m_filter.preferredLayout();
+    }
+
+    bool StatelessProcessor::supportsInPlace() const
+    {
+        return m_filter.supportsInPlace();
+    }
+
+    bool StatelessProcessor::processInPlace(SampleSpan<float> samples)
+    {
+        return m_filter.processInPlace(samples);
+    }
+
+    bool StatelessProcessor::processInto(SampleSpan<const float> in, SampleSpan<float> out)
+    {
+        return m_filter.processInto(in, out);
+    }
+
+}
+}
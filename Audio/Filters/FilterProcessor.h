@@ -0,0 +1,123 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AbstractFilter.h"
+#include "../SampleSpan.h"
+
+namespace DX {
+namespace Audio {
+
+    class AudioPacket;
+
+    /*! \brief FilterProcessor is one stream's pass through a filter. Whatever the filter has to
+        remember from one packet to the next - FIR history, IIR state, a resampler's phase - lives
+        in the FilterProcessor, so a stream comes out exactly as if it had been filtered in one go,
+        with nothing recomputed at packet edges.
+
+        AbstractFilters describe what to do and stay shared (see FilterRepository); each stream
+        through one gets its own FilterProcessor, from FilterRepository::createProcessor() or
+        AbstractFilter::createProcessor(). Filters without any state hand out a StatelessProcessor,
+        which just calls transformPacket() (and the filter's in place processing, if it has any).
+
+        \note A FilterProcessor is meant for a single thread at a time, typically the one driving a
+        device.
+
+        \code
+        std::shared_ptr<FilterProcessor> processor = FilterRepository::createProcessor(filter);
+        while(stream.pop(packet))
+        {
+            processor->process(packet, out);
+            // ...
+        }
+        processor->reset(); // Before reusing it for an unrelated stream
+        \endcode
+    */
+    class DXAUDIO_EXPORT FilterProcessor
+    {
+    public:
+        virtual ~FilterProcessor();
+
+        /*! Filters in into out, carrying on from the packets before it.
+            \return False if in couldn't be filtered into out
+        */
+        virtual bool            process(const AudioPacket& in, AudioPacket& out) = 0;
+
+        /*! Forgets everything, as though no packets had been processed */
+        virtual void            reset() = 0;
+
+        /*! \return The SampleLayout process() would like its packets in, see
+            AbstractFilter::preferredLayout(). Defaults to INTERLEAVED.
+        */
+        virtual SampleLayout    preferredLayout() const;
+
+        /*! \return True if the processor can run in place, see AbstractFilter::supportsInPlace().
+            Defaults to false.
+        */
+        virtual bool            supportsInPlace() const;
+
+        /*! Filters FLOAT32 samples where they lie, carrying on from the blocks before them. See
+            AbstractFilter::processInPlace().
+            \return False if the processor doesn't support it (the default)
+        */
+        virtual bool            processInPlace(SampleSpan<float> samples);
+
+        /*! Filters in into out, caller-provided and the same shape as in, without allocating. See
+            AbstractFilter::processInto(). Defaults to copying in to out and running processInPlace()
+            there.
+        */
+        virtual bool            processInto(SampleSpan<const float> in, SampleSpan<float> out);
+
+    protected:
+        FilterProcessor();
+
+    private:
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        FilterProcessor(const FilterProcessor&);
+        FilterProcessor(FilterProcessor&&);
+    };
+
+    /*! \brief StatelessProcessor is the FilterProcessor for filters with nothing to carry between
+        packets: process() is the filter's transformPacket(), and reset() does nothing.
+
+        \note The filter must outlive the StatelessProcessor.
+    */
+    class DXAUDIO_EXPORT StatelessProcessor : public FilterProcessor
+    {
+    public:
+        explicit StatelessProcessor(const AbstractFilter& filter);
+        ~StatelessProcessor();
+
+        bool            process(const AudioPacket& in, AudioPacket& out);
+        void            reset();
+        SampleLayout    preferredLayout() const;
+        bool            supportsInPlace() const;
+        bool            processInPlace(SampleSpan<float> samples);
+        bool            processInto(SampleSpan<const float> in, SampleSpan<float> out);
+
+    private:
+        const AbstractFilter&   m_filter;
+    };
+
+}
+}
@@ -30,6 +30,9 @@ namespace FilterRepository {
 
     void registerFilter(std::shared_ptr<AbstractFilter> filter, FilterType type)
     {
+        // Filters that carry per-stream state are made one per stream, and have nothing to share
+        if(!filter)
+            return;
         FilterRepo[filter] = type;
     }
 
@@ -45,6 +48,18 @@ namespace FilterRepository {
         return ret;
     }
 
+    std::shared_ptr<FilterProcessor> createProcessor(const std::shared_ptr<AbstractFilter>& filter)
+    {
+        if(!filter)
+            return nullptr;
+
+        // Share ownership of the processor with the filter, so the filter can't go away underneath it
+        const std::shared_ptr<FilterProcessor> processor = filter->createProcessor();
+        if(!processor)
+            return nullptr;
+        return std::shared_ptr<FilterProcessor>(processor.get(), [processor, filter](FilterProcessor*) {});
+    }
+
 }
 }
 }
\ No newline at end of file
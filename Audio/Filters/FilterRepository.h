@@ -20,6 +20,7 @@
 #pragma once
 
 #include "AbstractFilter.h"
+#include "FilterProcessor.h"
 
 #include <vector>
 
@@ -37,6 +38,13 @@ namespace FilterRepository {
 
     DXAUDIO_EXPORT std::vector<std::shared_ptr<AbstractFilter>> getFiltersOfType(FilterType type);
 
+    /*! Creates a FilterProcessor for one stream through filter (see AbstractFilter::createProcessor()).
+        The FilterProcessor holds on to filter for as long as it lives.
+
+        \return nullptr if filter is null
+    */
+    DXAUDIO_EXPORT std::shared_ptr<FilterProcessor> createProcessor(const std::shared_ptr<AbstractFilter>& filter);
+
 }
 }
 }
\ No newline at end of file
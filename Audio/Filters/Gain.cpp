@@ -0,0 +1,160 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Gain.h"
+#include "../AudioPacket.h"
+#include "../SampleSpan.h"
+
+#include <cmath>
+
+namespace DX {
+namespace Audio {
+
+    template <typename T>
+    static inline T scaled(T sample, float gain)
+    {
+        return static_cast<T>(sample * gain);
+    }
+
+    // Integer samples are rounded and clipped to their range
+    static inline int32_t clipped(double value, double lowest, double highest)
+    {
+        value = std::floor(value + 0.5);
+        if(value < lowest)
+            return static_cast<int32_t>(lowest);
+        if(value > highest)
+            return static_cast<int32_t>(highest);
+        return static_cast<int32_t>(value);
+    }
+
+    template <>
+    inline int16_t scaled(int16_t sample, float gain)
+    {
+        return static_cast<int16_t>(clipped(static_cast<double>(sample) * gain, -32768.0, 32767.0));
+    }
+
+    template <>
+    inline int32_t scaled(int32_t sample, float gain)
+    {
+        return clipped(static_cast<double>(sample) * gain, -2147483648.0, 2147483647.0);
+    }
+
+    template <typename T>
+    static void applyGain(SampleSpan<const T> in, SampleSpan<T> out, float gain)
+    {
+        for(size_t frame = 0; frame < in.numFrames(); ++frame)
+        {
+            for(size_t channel = 0; channel < in.numChannels(); ++channel)
+                out(frame, channel) = scaled(in(frame, channel), gain);
+        }
+    }
+
+    static void applyGain(SampleSpan<const Int24> in, SampleSpan<Int24> out, float gain)
+    {
+        for(size_t frame = 0; frame < in.numFrames(); ++frame)
+        {
+            for(size_t channel = 0; channel < in.numChannels(); ++channel)
+                out(frame, channel) = clipped(static_cast<double>(int32_t(in(frame, channel))) * gain, -8388608.0, 8388607.0);
+        }
+    }
+
+    Gain::Gain(float gain) : AbstractFilter(nullptr, EFFECTS), m_gain(gain)
+    {
+    }
+
+    Gain::~Gain()
+    {
+    }
+
+    bool Gain::transformPacket(const AudioPacket& in, AudioPacket& out) const
+    {
+        const AudioFormat format = in.getAudioFormat();
+        if(format != out.getAudioFormat() || format.channels == 0 || format.bitsPerBlock == 0)
+            return false;
+
+        out.resize(in.byteSize());
+        const float gain = m_gain.load(std::memory_order_relaxed);
+        switch(encodingOf(format))
+        {
+        case PCM_INT16:
+            applyGain(makeSampleSpan<int16_t>(in), makeSampleSpan<int16_t>(out), gain);
+            return true;
+        case PCM_INT24:
+            applyGain(makeSampleSpan<Int24>(in), makeSampleSpan<Int24>(out), gain);
+            return true;
+        case PCM_INT32:
+            applyGain(makeSampleSpan<int32_t>(in), makeSampleSpan<int32_t>(out), gain);
+            return true;
+        case FLOAT32:
+            return processInto(makeSampleSpan<float>(in), makeSampleSpan<float>(out));
+        case FLOAT64:
+            applyGain(makeSampleSpan<double>(in), makeSampleSpan<double>(out), gain);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    std::string Gain::name() const
+    {
+        static const std::string name("Gain");
+        return name;
+    }
+
+    bool Gain::supportsInPlace() const
+    {
+        return true;
+    }
+
+    bool Gain::processInPlace(SampleSpan<float> samples) const
+    {
+        const float gain = m_gain.load(std::memory_order_relaxed);
+        if(samples.isContiguous())
+        {
+            // One straight run the compiler can vectorize
+            for(float* it = samples.begin(); it != samples.end(); ++it)
+                *it *= gain;
+            return true;
+        }
+
+        for(size_t frame = 0; frame < samples.numFrames(); ++frame)
+        {
+            for(size_t channel = 0; channel < samples.numChannels(); ++channel)
+                samples(frame, channel) *= gain;
+        }
+        return true;
+    }
+
+    float Gain::gain() const
+    {
+        return m_gain.load(std::memory_order_relaxed);
+    }
+
+    void Gain::setGain(float gain)
+    {
+        m_gain.store(gain, std::memory_order_relaxed);
+    }
+
+    float Gain::fromDecibels(float decibels)
+    {
+        return std::pow(10.0f, decibels / 20.0f);
+    }
+
+}
+}
@@ -0,0 +1,73 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AbstractFilter.h"
+
+#include <atomic>
+
+namespace DX {
+namespace Audio {
+
+    /*! \brief Gain scales every sample by a constant factor - the simplest of the format-preserving
+        effects, and so one that runs in place (see AbstractFilter::processInPlace()).
+
+        transformPacket() takes packets of any known SampleEncoding, as long as in and out share a
+        format; integer samples are rounded and clipped to their range. In place processing is on
+        FLOAT32 samples.
+
+        The gain may be changed at any time, from any thread; each block picks up whatever it is
+        when the block starts.
+
+        \code
+        Gain gain(Gain::fromDecibels(-6.0f));
+        playbackDevice->writeToBuffer(captureStream, gain, callback);
+        \endcode
+    */
+    struct DXAUDIO_EXPORT Gain : public AbstractFilter
+    {
+        explicit Gain(float gain = 1.0f);
+        ~Gain();
+
+        /*! \return False if the packets differ in format or the encoding is unknown */
+        bool            transformPacket(const AudioPacket& in, AudioPacket& out) const;
+        std::string     name() const;
+        bool            supportsInPlace() const;
+        bool            processInPlace(SampleSpan<float> samples) const;
+
+        float           gain() const; /*!< As a linear factor */
+        void            setGain(float gain);
+
+        /*! \return decibels as a linear factor */
+        static float    fromDecibels(float decibels);
+
+    private:
+        std::atomic<float>  m_gain;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        Gain(const Gain&);
+        Gain(Gain&&);
+    };
+
+}
+}
@@ -0,0 +1,385 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AbstractFilter.h"
+#include "Biquad.h"
+#include "FilterProcessor.h"
+#include "../AudioPacket.h"
+#include "../SampleSpan.h"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Pipeline stages
+
+    /*
+        A Pipeline stage is any copyable type with
+
+            void reset();
+            template <unsigned Channels>
+            void process(float* frame);
+
+        process() filters one frame of Channels samples where it lies. Stages are plain members, not
+        AbstractFilters, so every call is inlined into the Pipeline's loop.
+    */
+
+    /*! \brief GainStage scales every sample by gain */
+    struct GainStage
+    {
+        float   gain; /*!< As a linear factor */
+
+        GainStage() : gain(1.0f)
+        {
+        }
+
+        void reset()
+        {
+        }
+
+        template <unsigned Channels>
+        void process(float* frame)
+        {
+            for(unsigned int channel = 0; channel < Channels; ++channel)
+                frame[channel] *= gain;
+        }
+    };
+
+    /*! \brief BiquadStage runs Sections biquads in series over each of Channels channels, in
+        transposed direct form II. Every section starts out passing everything through.
+    */
+    template <unsigned Channels, unsigned Sections>
+    struct BiquadStage
+    {
+        BiquadCoefficients  coefficients[Sections];
+        float               state[Sections][2][Channels]; // Per section, z1 then z2 for each channel
+
+        BiquadStage()
+        {
+            for(unsigned int section = 0; section < Sections; ++section)
+                coefficients[section] = BiquadCoefficients::passThrough();
+            reset();
+        }
+
+        void reset()
+        {
+            std::memset(state, 0, sizeof(state));
+        }
+
+        template <unsigned PipelineChannels>
+        void process(float* frame)
+        {
+            static_assert(PipelineChannels == Channels, "BiquadStage must have as many channels as its Pipeline");
+            for(unsigned int section = 0; section < Sections; ++section)
+            {
+                const BiquadCoefficients& k = coefficients[section];
+                float* z1 = state[section][0];
+                float* z2 = state[section][1];
+                for(unsigned int channel = 0; channel < Channels; ++channel)
+                {
+                    const float x = frame[channel];
+                    const float y = k.b0 * x + z1[channel];
+                    z1[channel] = k.b1 * x - k.a1 * y + z2[channel];
+                    z2[channel] = k.b2 * x - k.a2 * y;
+                    frame[channel] = y;
+                }
+            }
+        }
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // StageChain
+
+    /*! \brief StageChain holds a Pipeline's stages and runs them one after another, all inlined */
+    template <typename... Stages>
+    struct StageChain;
+
+    template <>
+    struct StageChain<>
+    {
+        void reset()
+        {
+        }
+
+        template <unsigned Channels>
+        void process(float*)
+        {
+        }
+    };
+
+    template <typename First, typename... Rest>
+    struct StageChain<First, Rest...>
+    {
+        First                   first;
+        StageChain<Rest...>     rest;
+
+        void reset()
+        {
+            first.reset();
+            rest.reset();
+        }
+
+        template <unsigned Channels>
+        void process(float* frame)
+        {
+            first.template process<Channels>(frame);
+            rest.template process<Channels>(frame);
+        }
+    };
+
+    /*! \brief StageAt finds the Index'th stage of a StageChain */
+    template <size_t Index, typename Chain>
+    struct StageAt;
+
+    template <typename First, typename... Rest>
+    struct StageAt<0, StageChain<First, Rest...>>
+    {
+        typedef First type;
+
+        static type& get(StageChain<First, Rest...>& chain)
+        {
+            return chain.first;
+        }
+    };
+
+    template <size_t Index, typename First, typename... Rest>
+    struct StageAt<Index, StageChain<First, Rest...>>
+    {
+        typedef typename StageAt<Index - 1, StageChain<Rest...>>::type type;
+
+        static type& get(StageChain<First, Rest...>& chain)
+        {
+            return StageAt<Index - 1, StageChain<Rest...>>::get(chain.rest);
+        }
+    };
+
+    /*! Runs stages over every frame of in, writing to out (which may be in). Runs on a copy of
+        stages that goes back once the block is done, so the compiler is free to keep every stage's
+        state in registers for the whole block.
+        \return False if either span doesn't have Channels channels, or they differ in frames
+    */
+    template <unsigned Channels, typename Chain>
+    bool runStages(Chain& stages, SampleSpan<const float> in, SampleSpan<float> out)
+    {
+        if(in.numChannels() != Channels || out.numChannels() != Channels || in.numFrames() != out.numFrames())
+            return false;
+
+        Chain local(stages);
+        const size_t numFrames = in.numFrames();
+        float frame[Channels];
+        if(in.frameStride() == Channels && in.channelStride() == 1 && out.frameStride() == Channels
+            && out.channelStride() == 1)
+        {
+            // Interleaved, the common case, as flat loops
+            const float* from = in.data();
+            float* to = out.data();
+            for(size_t i = 0; i < numFrames; ++i)
+            {
+                for(unsigned int channel = 0; channel < Channels; ++channel)
+                    frame[channel] = from[i * Channels + channel];
+                local.template process<Channels>(frame);
+                for(unsigned int channel = 0; channel < Channels; ++channel)
+                    to[i * Channels + channel] = frame[channel];
+            }
+        }
+        else
+        {
+            for(size_t i = 0; i < numFrames; ++i)
+            {
+                for(unsigned int channel = 0; channel < Channels; ++channel)
+                    frame[channel] = in(i, channel);
+                local.template process<Channels>(frame);
+                for(unsigned int channel = 0; channel < Channels; ++channel)
+                    out(i, channel) = frame[channel];
+            }
+        }
+
+        stages = local;
+        return true;
+    }
+
+    /*! runStages() from packet to packet, which must share a FLOAT32 format of Channels channels */
+    template <unsigned Channels, typename Chain>
+    bool runStages(Chain& stages, const AudioPacket& in, AudioPacket& out)
+    {
+        const AudioFormat format = in.getAudioFormat();
+        if(format != out.getAudioFormat() || format.channels != Channels || encodingOf(format) != FLOAT32)
+            return false;
+
+        out.resize(in.byteSize());
+        return runStages<Channels>(stages, makeSampleSpan<float>(in), makeSampleSpan<float>(out));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Pipeline
+
+    /*! \brief PipelineProcessor is one stream through a Pipeline, see FilterProcessor */
+    template <unsigned Channels, typename... Stages>
+    class PipelineProcessor : public FilterProcessor
+    {
+    public:
+        typedef StageChain<Stages...> Chain;
+
+        /*! Takes stages' settings, with none of their state */
+        explicit PipelineProcessor(const Chain& stages) : m_stages(stages)
+        {
+            m_stages.reset();
+        }
+
+        bool process(const AudioPacket& in, AudioPacket& out)
+        {
+            return runStages<Channels>(m_stages, in, out);
+        }
+
+        void reset()
+        {
+            m_stages.reset();
+        }
+
+        bool supportsInPlace() const
+        {
+            return true;
+        }
+
+        bool processInPlace(SampleSpan<float> samples)
+        {
+            return runStages<Channels>(m_stages, samples, samples);
+        }
+
+        bool processInto(SampleSpan<const float> in, SampleSpan<float> out)
+        {
+            return runStages<Channels>(m_stages, in, out);
+        }
+
+    private:
+        Chain   m_stages;
+    };
+
+    /*! \brief Pipeline fuses a chain of filter stages, fixed at compile time, into a single
+        AbstractFilter that makes one pass over each block.
+
+        Where a FilterGraph calls each filter in turn through virtual calls, each pass reading and
+        writing a whole block, a Pipeline loads one frame, runs it through every stage while it's in
+        registers and stores it once. The stages and the channel count are template parameters, so
+        the compiler sees straight through to the arithmetic: no virtual calls, no intermediate
+        buffers, and per channel loops of known length it can unroll or vectorize.
+
+        Samples are FLOAT32, in either layout, and a Pipeline always runs in place (see
+        AbstractFilter::processInPlace()). Stages can't change the number of frames, so resampling
+        belongs in front of a Pipeline (in a FilterGraph, say) rather than in it.
+
+        Stages keep their state, so each stream should have its own PipelineProcessor, from
+        createProcessor(). Set the stages up through stage() first - processors copy them as they
+        are when created. transformPacket() runs through stages of its own, which makes calling it
+        directly good for one stream at a time.
+
+        \code
+        typedef Pipeline<2, GainStage, BiquadStage<2, 4>> StereoEq;
+
+        StereoEq equalizer;
+        equalizer.stage<0>().gain = 0.5f;
+        equalizer.stage<1>().coefficients[0] = ...;
+        playbackDevice->writeToBuffer(captureStream, equalizer, callback);
+        \endcode
+    */
+    template <unsigned Channels, typename... Stages>
+    struct Pipeline : public AbstractFilter
+    {
+        static_assert(Channels > 0, "A Pipeline needs at least one channel");
+
+        typedef StageChain<Stages...> Chain;
+
+        static const unsigned int NUM_CHANNELS = Channels;
+
+        Pipeline() : AbstractFilter(nullptr, EFFECTS)
+        {
+        }
+
+        ~Pipeline()
+        {
+        }
+
+        /*! \return The Index'th stage, to set it up */
+        template <size_t Index>
+        typename StageAt<Index, Chain>::type& stage()
+        {
+            return StageAt<Index, Chain>::get(m_stages);
+        }
+
+        /*! \return False if the packets differ in format, or aren't FLOAT32 with Channels channels */
+        bool transformPacket(const AudioPacket& in, AudioPacket& out) const
+        {
+            return runStages<Channels>(m_stages, in, out);
+        }
+
+        std::string name() const
+        {
+            static const std::string name("Fused pipeline");
+            return name;
+        }
+
+        std::shared_ptr<FilterProcessor> createProcessor() const
+        {
+            return std::make_shared<PipelineProcessor<Channels, Stages...>>(m_stages);
+        }
+
+        bool supportsInPlace() const
+        {
+            return true;
+        }
+
+        bool processInPlace(SampleSpan<float> samples) const
+        {
+            return runStages<Channels>(m_stages, samples, samples);
+        }
+
+        bool processInto(SampleSpan<const float> in, SampleSpan<float> out) const
+        {
+            return runStages<Channels>(m_stages, in, out);
+        }
+
+        /*! Forgets any state transformPacket() carried over from earlier packets */
+        void reset()
+        {
+            m_stages.reset();
+        }
+
+    private:
+        mutable Chain   m_stages;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        Pipeline(const Pipeline&);
+        Pipeline(Pipeline&&);
+    };
+
+}
+}
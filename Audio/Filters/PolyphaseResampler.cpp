@@ -0,0 +1,451 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PolyphaseResampler.h"
+#include "../AudioPacket.h"
+#include "../SampleConversion.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <utility>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define DX_RESAMPLER_SSE
+#endif
+
+#if defined(DX_RESAMPLER_SSE)
+    #include <xmmintrin.h>
+#endif
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // PolyphaseBank
+
+    struct QualityPreset
+    {
+        double  attenuation; // Stopband, in dB
+        double  passband; // Passband edge, as a fraction of the lower rate
+    };
+
+    static const QualityPreset QUALITY_PRESETS[] =
+    {
+        { 60.0,  0.40 },
+        { 90.0,  0.44 },
+        { 120.0, 0.46 }
+    };
+
+    static const double PI = 3.14159265358979323846;
+
+    // Zeroth order modified Bessel function of the first kind, for the Kaiser window
+    static double besselI0(double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+        for(int k = 1; k < 64; ++k)
+        {
+            const double factor = x / (2.0 * k);
+            term *= factor * factor;
+            sum += term;
+            if(term < sum * 1e-16)
+                break;
+        }
+        return sum;
+    }
+
+    static double kaiserBeta(double attenuation)
+    {
+        if(attenuation > 50.0)
+            return 0.1102 * (attenuation - 8.7);
+        if(attenuation >= 21.0)
+            return 0.5842 * std::pow(attenuation - 21.0, 0.4) + 0.07886 * (attenuation - 21.0);
+        return 0.0;
+    }
+
+    static unsigned int greatestCommonDivisor(unsigned int a, unsigned int b)
+    {
+        while(b != 0)
+        {
+            const unsigned int remainder = a % b;
+            a = b;
+            b = remainder;
+        }
+        return a;
+    }
+
+    /*
+        Every phase of the anti-aliasing filter for one (up, down, quality), each stored back to front
+        so it lines up with input read oldest to newest, padded with zeros to a multiple of 4 taps
+    */
+    class PolyphaseBank
+    {
+    public:
+        PolyphaseBank(unsigned int up, unsigned int down, ResamplerQuality quality);
+
+        static std::shared_ptr<const PolyphaseBank> get(unsigned int up, unsigned int down, ResamplerQuality quality);
+
+        // upPhase is in [0, up); banks with fewer phases than up round it down to the nearest they have
+        const float*    phase(unsigned int upPhase) const
+        {
+            const size_t index = static_cast<size_t>(static_cast<unsigned long long>(upPhase) * m_phases / m_up);
+            return &m_coefficients[index * m_taps];
+        }
+
+        unsigned int    up() const { return m_up; }
+        unsigned int    down() const { return m_down; }
+        size_t          taps() const { return m_taps; }
+
+    private:
+        const unsigned int  m_up;
+        const unsigned int  m_down;
+        const unsigned int  m_phases;
+        size_t              m_taps;
+        std::vector<float>  m_coefficients;
+    };
+
+    PolyphaseBank::PolyphaseBank(unsigned int up, unsigned int down, ResamplerQuality quality)
+        : m_up(up), m_down(down), m_phases(up < POLYPHASE_MAX_PHASES ? up : POLYPHASE_MAX_PHASES), m_taps(0)
+    {
+        const QualityPreset& preset = QUALITY_PRESETS[quality];
+
+        // Everything relative to the input rate; downsampling narrows the filter, so it needs more taps
+        const double lowerRate = (up < down ? double(up) / double(down) : 1.0);
+        const double transition = (0.5 - preset.passband) * lowerRate;
+        const double cutoff = (preset.passband + 0.5) * 0.5 * lowerRate;
+
+        const double idealTaps = (preset.attenuation - 8.0) / (2.285 * 2.0 * PI * transition);
+        m_taps = (static_cast<size_t>(std::ceil(idealTaps)) + 3) & ~size_t(3);
+
+        const size_t length = m_taps * m_phases;
+        const double center = (double(length) - 1.0) * 0.5;
+        const double beta = kaiserBeta(preset.attenuation);
+        const double normalizer = besselI0(beta);
+        // Cutoff at the upsampled rate, as a fraction of it
+        const double upCutoff = cutoff / m_phases;
+
+        std::vector<double> prototype(length);
+        for(size_t n = 0; n < length; ++n)
+        {
+            const double x = double(n) - center;
+            const double sinc = (x == 0.0 ? 1.0 : std::sin(2.0 * PI * upCutoff * x) / (2.0 * PI * upCutoff * x));
+            const double ratio = (length > 1 ? 2.0 * double(n) / double(length - 1) - 1.0 : 0.0);
+            const double window = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / normalizer;
+            prototype[n] = 2.0 * upCutoff * sinc * window;
+        }
+
+        // Scaled so the phases average unity gain at DC. Scaling each phase to exactly unity would
+        // modulate the gain from one output sample to the next, which is worse than the ripple it removes
+        double sum = 0.0;
+        for(size_t n = 0; n < length; ++n)
+            sum += prototype[n];
+        const double gain = (sum != 0.0 ? double(m_phases) / sum : 0.0);
+
+        m_coefficients.assign(length, 0.0f);
+        for(size_t p = 0; p < m_phases; ++p)
+        {
+            // Tap k of phase p is prototype[k * phases + p]
+            float* coefficients = &m_coefficients[p * m_taps];
+            for(size_t k = 0; k < m_taps; ++k)
+                coefficients[m_taps - 1 - k] = static_cast<float>(prototype[k * m_phases + p] * gain);
+        }
+    }
+
+    // Banks are built outside the audio path (on the first packet at a new rate), a plain spin is plenty
+    static std::atomic<bool> s_bankLock(false);
+    static std::map<std::pair<std::pair<unsigned int, unsigned int>, int>, std::shared_ptr<const PolyphaseBank>> s_banks;
+
+    std::shared_ptr<const PolyphaseBank> PolyphaseBank::get(unsigned int up, unsigned int down, ResamplerQuality quality)
+    {
+        const std::pair<std::pair<unsigned int, unsigned int>, int> key(std::make_pair(up, down), quality);
+
+        while(s_bankLock.exchange(true, std::memory_order_acquire))
+            std::this_thread::yield();
+
+        std::shared_ptr<const PolyphaseBank>& bank = s_banks[key];
+        if(!bank)
+            bank = std::make_shared<PolyphaseBank>(up, down, quality);
+        const std::shared_ptr<const PolyphaseBank> ret = bank;
+
+        s_bankLock.store(false, std::memory_order_release);
+        return ret;
+    }
+
+    // numTaps is always a multiple of 4
+    static inline float dotProduct(const float* coefficients, const float* samples, size_t numTaps)
+    {
+    #if defined(DX_RESAMPLER_SSE)
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+        size_t i = 0;
+        for(; i + 8 <= numTaps; i += 8)
+        {
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(coefficients + i), _mm_loadu_ps(samples + i)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(coefficients + i + 4), _mm_loadu_ps(samples + i + 4)));
+        }
+        if(i < numTaps)
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(coefficients + i), _mm_loadu_ps(samples + i)));
+
+        sum0 = _mm_add_ps(sum0, sum1);
+        sum0 = _mm_add_ps(sum0, _mm_movehl_ps(sum0, sum0));
+        sum0 = _mm_add_ss(sum0, _mm_shuffle_ps(sum0, sum0, 1));
+        return _mm_cvtss_f32(sum0);
+    #else
+        float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for(size_t i = 0; i < numTaps; i += 4)
+        {
+            sum[0] += coefficients[i] * samples[i];
+            sum[1] += coefficients[i + 1] * samples[i + 1];
+            sum[2] += coefficients[i + 2] * samples[i + 2];
+            sum[3] += coefficients[i + 3] * samples[i + 3];
+        }
+        return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+    #endif
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // PolyphaseResampler impl
+
+    PolyphaseResampler::PolyphaseResampler(ResamplerQuality quality)
+        : AbstractFilter(nullptr, FREQUENCY_TRANSFORM), m_quality(quality),
+        m_processor(std::make_shared<PolyphaseProcessor>(quality))
+    {
+    }
+
+    PolyphaseResampler::~PolyphaseResampler()
+    {
+    }
+
+    bool PolyphaseResampler::transformPacket(const AudioPacket& in, AudioPacket& out) const
+    {
+        return m_processor->process(in, out);
+    }
+
+    std::string PolyphaseResampler::name() const
+    {
+        static const std::string name("Polyphase windowed-sinc resampler");
+        return name;
+    }
+
+    SampleLayout PolyphaseResampler::preferredLayout() const
+    {
+        return PLANAR;
+    }
+
+    std::shared_ptr<FilterProcessor> PolyphaseResampler::createProcessor() const
+    {
+        return std::make_shared<PolyphaseProcessor>(m_quality);
+    }
+
+    void PolyphaseResampler::reset()
+    {
+        m_processor->reset();
+    }
+
+    ResamplerQuality PolyphaseResampler::quality() const
+    {
+        return m_quality;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // PolyphaseProcessor impl
+
+    PolyphaseProcessor::PolyphaseProcessor(ResamplerQuality quality)
+        : m_quality(quality), m_inRate(0), m_outRate(0), m_channels(0), m_historyStride(0),
+        m_outputStride(0), m_position(0), m_phase(0)
+    {
+    }
+
+    PolyphaseProcessor::~PolyphaseProcessor()
+    {
+    }
+
+    bool PolyphaseProcessor::process(const AudioPacket& in, AudioPacket& out)
+    {
+        const AudioFormat inFormat = in.getAudioFormat();
+        const AudioFormat outFormat = out.getAudioFormat();
+        if(inFormat.channels == 0 || inFormat.channels != outFormat.channels || inFormat.layout != outFormat.layout)
+            return false;
+        if(inFormat.samplesPerSecond == 0 || outFormat.samplesPerSecond == 0)
+            return false;
+
+        const SampleEncoding inEncoding = encodingOf(inFormat);
+        const SampleEncoding outEncoding = encodingOf(outFormat);
+        const size_t inBytes = bytesPerSample(inEncoding);
+        const size_t outBytes = bytesPerSample(outEncoding);
+        if(inBytes == 0 || outBytes == 0 || in.byteSize() == 0)
+            return false;
+
+        const size_t channels = inFormat.channels;
+        const size_t frames = in.byteSize() / (inBytes * channels);
+
+        if(inFormat.samplesPerSecond == outFormat.samplesPerSecond)
+        {
+            // Nothing to resample, at most the encoding changes
+            out.resize(frames * channels * outBytes);
+            return SampleConversion::convert(in, out);
+        }
+
+        if(!m_bank || inFormat.samplesPerSecond != m_inRate || outFormat.samplesPerSecond != m_outRate
+            || channels != m_channels)
+            configure(inFormat.samplesPerSecond, outFormat.samplesPerSecond, channels);
+        reserve(frames);
+
+        const size_t taps = m_bank->taps();
+        const size_t carried = taps - 1;
+        const unsigned int up = m_bank->up();
+        const unsigned int down = m_bank->down();
+
+        // Stage the input as floats, then spread it over the end of each channel's history
+        if(m_scratch.size() < frames * channels)
+            m_scratch.resize(frames * channels);
+        SampleConversion::convert(in.data(), inEncoding, &m_scratch[0], FLOAT32, frames * channels);
+        for(size_t channel = 0; channel < channels; ++channel)
+        {
+            float* history = &m_history[channel * m_historyStride + carried];
+            if(inFormat.layout == PLANAR)
+            {
+                std::memcpy(history, &m_scratch[channel * frames], frames * sizeof(float));
+            }
+            else
+            {
+                for(size_t i = 0; i < frames; ++i)
+                    history[i] = m_scratch[i * channels + channel];
+            }
+        }
+
+        // Every channel steps through the same positions and phases
+        const size_t end = carried + frames;
+        size_t produced = 0;
+        size_t position = m_position;
+        unsigned int phase = m_phase;
+        for(size_t channel = 0; channel < channels; ++channel)
+        {
+            const float* history = &m_history[channel * m_historyStride];
+            float* output = &m_output[channel * m_outputStride];
+            position = m_position;
+            phase = m_phase;
+            produced = 0;
+            while(position < end)
+            {
+                output[produced++] = dotProduct(m_bank->phase(phase), history + position - carried, taps);
+                phase += down;
+                position += phase / up;
+                phase %= up;
+            }
+        }
+
+        // Carry the last taps - 1 frames over to the next packet
+        for(size_t channel = 0; channel < channels; ++channel)
+        {
+            float* history = &m_history[channel * m_historyStride];
+            std::memmove(history, history + frames, carried * sizeof(float));
+        }
+        m_position = position - frames;
+        m_phase = phase;
+
+        out.resize(produced * channels * outBytes);
+        if(produced == 0)
+            return true;
+
+        if(outFormat.layout == PLANAR)
+        {
+            for(size_t channel = 0; channel < channels; ++channel)
+                SampleConversion::convert(&m_output[channel * m_outputStride], FLOAT32,
+                    out.data() + channel * produced * outBytes, outEncoding, produced);
+            return true;
+        }
+
+        if(m_scratch.size() < produced * channels)
+            m_scratch.resize(produced * channels);
+        for(size_t channel = 0; channel < channels; ++channel)
+        {
+            const float* output = &m_output[channel * m_outputStride];
+            for(size_t i = 0; i < produced; ++i)
+                m_scratch[i * channels + channel] = output[i];
+        }
+        return SampleConversion::convert(&m_scratch[0], FLOAT32, out.data(), outEncoding, produced * channels);
+    }
+
+    void PolyphaseProcessor::reset()
+    {
+        m_bank.reset();
+        m_inRate = 0;
+        m_outRate = 0;
+        m_channels = 0;
+    }
+
+    SampleLayout PolyphaseProcessor::preferredLayout() const
+    {
+        return PLANAR;
+    }
+
+    void PolyphaseProcessor::configure(unsigned int inRate, unsigned int outRate, size_t channels)
+    {
+        const unsigned int divisor = greatestCommonDivisor(inRate, outRate);
+        m_bank = PolyphaseBank::get(outRate / divisor, inRate / divisor, m_quality);
+        m_inRate = inRate;
+        m_outRate = outRate;
+        m_channels = channels;
+
+        // Start from silence, with the first output lined up on the first new frame
+        m_historyStride = 0;
+        m_outputStride = 0;
+        m_history.clear();
+        m_output.clear();
+        m_position = m_bank->taps() - 1;
+        m_phase = 0;
+    }
+
+    void PolyphaseProcessor::reserve(size_t inFrames)
+    {
+        const size_t carried = m_bank->taps() - 1;
+        if(carried + inFrames > m_historyStride)
+        {
+            // Grow, keeping each channel's carried frames
+            const size_t stride = carried + inFrames;
+            std::vector<float> history(m_channels * stride, 0.0f);
+            if(m_historyStride > 0)
+            {
+                for(size_t channel = 0; channel < m_channels; ++channel)
+                    std::memcpy(&history[channel * stride], &m_history[channel * m_historyStride], carried * sizeof(float));
+            }
+            m_history.swap(history);
+            m_historyStride = stride;
+        }
+
+        // At most one output per down / up input frames, plus one for wherever the phase starts
+        const size_t maxOutput = static_cast<size_t>(static_cast<unsigned long long>(inFrames) * m_bank->up()
+            / m_bank->down()) + 2;
+        if(maxOutput > m_outputStride)
+        {
+            m_output.assign(m_channels * maxOutput, 0.0f);
+            m_outputStride = maxOutput;
+        }
+    }
+
+}
+}
@@ -0,0 +1,138 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AbstractFilter.h"
+#include "FilterProcessor.h"
+
+#include <memory>
+#include <vector>
+
+namespace DX {
+namespace Audio {
+
+    class PolyphaseBank;
+
+    //! Defines the most phases a PolyphaseBank will hold before it starts rounding phases. Arbitrary for now, best results TBD
+    #ifndef POLYPHASE_MAX_PHASES
+        #define POLYPHASE_MAX_PHASES 1024
+    #endif
+
+    /*! \brief ResamplerQuality trades PolyphaseResampler accuracy for speed */
+    enum ResamplerQuality
+    {
+        RESAMPLER_LOW       = 0, /*!< 60 dB stopband, passband to 40% of the lower rate */
+        RESAMPLER_MEDIUM    = 1, /*!< 90 dB stopband, passband to 44% of the lower rate */
+        RESAMPLER_HIGH      = 2  /*!< 120 dB stopband, passband to 46% of the lower rate */
+    };
+
+    /*! \brief PolyphaseProcessor is one stream through a PolyphaseResampler, see FilterProcessor */
+    class DXAUDIO_EXPORT PolyphaseProcessor : public FilterProcessor
+    {
+    public:
+        explicit PolyphaseProcessor(ResamplerQuality quality);
+        ~PolyphaseProcessor();
+
+        /*! \return False if the packets differ in channels or layout, an encoding is unknown, or
+            either is empty
+        */
+        bool            process(const AudioPacket& in, AudioPacket& out);
+        /*! Forgets any input carried over from earlier packets */
+        void            reset();
+        SampleLayout    preferredLayout() const;
+
+    private:
+        void            configure(unsigned int inRate, unsigned int outRate, size_t channels);
+        void            reserve(size_t inFrames);
+
+        const ResamplerQuality                  m_quality;
+        std::shared_ptr<const PolyphaseBank>    m_bank;
+        unsigned int                            m_inRate;
+        unsigned int                            m_outRate;
+        size_t                                  m_channels;
+        std::vector<float>                      m_history; // Per channel, taps - 1 carried frames then new ones
+        size_t                                  m_historyStride;
+        std::vector<float>                      m_output; // Per channel
+        size_t                                  m_outputStride;
+        std::vector<float>                      m_scratch;
+        size_t                                  m_position; // Newest history frame the next output reads
+        unsigned int                            m_phase;
+    };
+
+    /*! \brief PolyphaseResampler converts between sample rates with a Kaiser-windowed sinc,
+        evaluated as a polyphase FIR filter.
+
+        Going from inRate to outRate is upsampling by L and downsampling by M, with L / M the
+        ratio in lowest terms (160 / 147 for 44.1 KHz -> 48 KHz, 1 / 3 for 48 KHz -> 16 KHz). Only
+        the L sub-filters ("phases") of the anti-aliasing filter that can ever line up with a real
+        input sample are kept, so each output sample is a single dot product against the most
+        recent input. Phases are built once per (L, M, ResamplerQuality) and shared by every
+        PolyphaseResampler that needs them. Ratios that would need more than POLYPHASE_MAX_PHASES
+        phases use the nearest of that many instead.
+
+        The dot products are vectorized with SSE where it's available, and channels are filtered
+        one at a time, so the filter prefers PLANAR packets.
+
+        Resampling keeps the tail of each packet's input for the next one, so a stream comes out
+        exactly as if it had been resampled in one go. That state lives in a PolyphaseProcessor:
+        createProcessor() hands out a fresh one per stream, while transformPacket() runs through one
+        built in, which makes calling it directly good for one stream at a time; reset() starts that
+        one afresh, and so does any change in rates or channels. How many frames come out of a packet
+        varies by one either way, so out is resized to fit whatever was produced.
+
+        Samples may be in any SampleEncoding; they're filtered as FLOAT32.
+
+        \code
+        PolyphaseResampler resampler(RESAMPLER_HIGH);
+        playbackDevice->writeToBuffer(captureStream, resampler, callback);
+        \endcode
+    */
+    struct DXAUDIO_EXPORT PolyphaseResampler : public AbstractFilter
+    {
+        explicit PolyphaseResampler(ResamplerQuality quality = RESAMPLER_HIGH);
+        ~PolyphaseResampler();
+
+        /*! \return False if the packets differ in channels or layout, an encoding is unknown, or
+            either is empty
+        */
+        bool            transformPacket(const AudioPacket& in, AudioPacket& out) const;
+        std::string     name() const;
+        SampleLayout    preferredLayout() const;
+        std::shared_ptr<FilterProcessor> createProcessor() const;
+
+        /*! Forgets any input transformPacket() carried over from earlier packets */
+        void            reset();
+
+        ResamplerQuality quality() const;
+
+    private:
+        const ResamplerQuality                      m_quality;
+        const std::shared_ptr<PolyphaseProcessor>   m_processor; // What transformPacket() streams through
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        PolyphaseResampler(const PolyphaseResampler&);
+        PolyphaseResampler(PolyphaseResampler&&);
+    };
+
+}
+}
@@ -0,0 +1,148 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "STFT.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace DX {
+namespace Audio {
+
+    static const double PI = 3.14159265358979323846;
+
+    std::vector<float> makeWindow(WindowType type, size_t size)
+    {
+        std::vector<float> window(size, 1.0f);
+        for(size_t i = 0; i < size; ++i)
+        {
+            const double phase = 2.0 * PI * double(i) / double(size);
+            switch(type)
+            {
+            case WINDOW_HANN:
+                window[i] = static_cast<float>(0.5 - 0.5 * std::cos(phase));
+                break;
+            case WINDOW_HAMMING:
+                window[i] = static_cast<float>(0.54 - 0.46 * std::cos(phase));
+                break;
+            case WINDOW_BLACKMAN:
+                window[i] = static_cast<float>(0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase));
+                break;
+            default:
+                break;
+            }
+        }
+        return window;
+    }
+
+    STFT::STFT(size_t fftSize, size_t hopSize, size_t numChannels, WindowType window)
+        : m_hopSize(std::min(std::max(hopSize, size_t(1)), FFT::roundUp(std::max(fftSize, size_t(2))))),
+        m_numChannels(numChannels), m_fft(fftSize), m_window(makeWindow(window, m_fft.size())), m_scale(1.0f),
+        m_position(0), m_input(numChannels * m_fft.size()), m_accumulator(numChannels * m_fft.size()),
+        m_ready(numChannels * m_hopSize), m_re(numChannels * m_fft.numBins()), m_im(numChannels * m_fft.numBins()),
+        m_time(m_fft.size())
+    {
+        /*
+            Every output frame is the sum of (fftSize / hopSize) overlapping blocks, each windowed twice.
+            Averaged over a hop, those squared windows add up to their sum over one block, spread over
+            hopSize frames, which is what gets divided back out
+        */
+        double sum = 0.0;
+        for(size_t i = 0; i < m_window.size(); ++i)
+            sum += double(m_window[i]) * double(m_window[i]);
+        if(sum > 0.0)
+            m_scale = static_cast<float>(double(m_hopSize) / sum);
+    }
+
+    STFT::~STFT()
+    {
+    }
+
+    void STFT::reset()
+    {
+        m_position = 0;
+        std::fill(m_input.begin(), m_input.end(), 0.0f);
+        std::fill(m_accumulator.begin(), m_accumulator.end(), 0.0f);
+        std::fill(m_ready.begin(), m_ready.end(), 0.0f);
+    }
+
+    size_t STFT::fftSize() const
+    {
+        return m_fft.size();
+    }
+
+    size_t STFT::hopSize() const
+    {
+        return m_hopSize;
+    }
+
+    size_t STFT::numChannels() const
+    {
+        return m_numChannels;
+    }
+
+    size_t STFT::numBins() const
+    {
+        return m_fft.numBins();
+    }
+
+    size_t STFT::latency() const
+    {
+        return m_fft.size();
+    }
+
+    void STFT::analyze()
+    {
+        const size_t size = fftSize();
+        const size_t bins = numBins();
+        for(size_t channel = 0; channel < m_numChannels; ++channel)
+        {
+            const float* input = &m_input[channel * size];
+            for(size_t i = 0; i < size; ++i)
+                m_time[i] = input[i] * m_window[i];
+            m_fft.forward(&m_time[0], &m_re[channel * bins], &m_im[channel * bins]);
+        }
+    }
+
+    void STFT::synthesize()
+    {
+        const size_t size = fftSize();
+        const size_t bins = numBins();
+        const size_t kept = size - m_hopSize;
+        for(size_t channel = 0; channel < m_numChannels; ++channel)
+        {
+            m_fft.inverse(&m_re[channel * bins], &m_im[channel * bins], &m_time[0]);
+
+            float* accumulator = &m_accumulator[channel * size];
+            for(size_t i = 0; i < size; ++i)
+                accumulator[i] += m_time[i] * m_window[i] * m_scale;
+
+            // The first hop has had every block it'll ever get added in, so it's done
+            std::memcpy(&m_ready[channel * m_hopSize], accumulator, m_hopSize * sizeof(float));
+            std::memmove(accumulator, accumulator + m_hopSize, kept * sizeof(float));
+            std::fill(accumulator + kept, accumulator + size, 0.0f);
+
+            float* input = &m_input[channel * size];
+            std::memmove(input, input + m_hopSize, kept * sizeof(float));
+        }
+    }
+
+}
+}
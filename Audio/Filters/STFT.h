@@ -0,0 +1,172 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FFT.h"
+#include "../AudioPacket.h"
+#include "../SampleSpan.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace DX {
+namespace Audio {
+
+    enum WindowType
+    {
+        WINDOW_RECTANGULAR  = 0,
+        WINDOW_HANN         = 1,
+        WINDOW_HAMMING      = 2,
+        WINDOW_BLACKMAN     = 3
+    };
+
+    /*! \return A periodic window of size samples, the form that overlaps and adds cleanly */
+    DXAUDIO_EXPORT std::vector<float> makeWindow(WindowType type, size_t size);
+
+    /*! \brief STFT runs audio through a short-time Fourier transform and back: every hopSize()
+        frames, the last fftSize() frames of each channel are windowed and transformed, handed to a
+        function that may change the spectrum however it likes, transformed back, windowed again and
+        overlap-added into the output.
+
+        Windowing on the way back in hides the seams between blocks whatever the function does, and
+        the output is scaled so that an untouched spectrum comes back as the input, delayed by
+        latency() frames. That's exact for Hann windows at hops of up to a quarter of the FFT, and
+        for rectangular windows at a hop of the whole FFT.
+
+        The function is called once per channel per hop, as
+
+            function(size_t channel, float* re, float* im, size_t numBins);
+
+        with the numBins() bins of a RealFFT (see there), which it changes where they are.
+
+        \code
+        STFT stft(1024, 256, 2);
+        stft.process(packet, [](size_t channel, float* re, float* im, size_t numBins)
+        {
+            for(size_t bin = numBins / 2; bin < numBins; ++bin)
+                re[bin] = im[bin] = 0.0f;
+        });
+        \endcode
+
+        Streams carry on from one call to the next, so an STFT belongs to one stream, and must be
+        used by one thread at a time. Nothing allocates after construction.
+    */
+    class DXAUDIO_EXPORT STFT
+    {
+    public:
+        /*! \param[in] fftSize      Frames per transform, rounded up to a power of two
+            \param[in] hopSize      Frames between transforms, from 1 to fftSize
+            \param[in] numChannels  Channels in the audio to process
+            \param[in] window       Applied both before and after the function
+        */
+        STFT(size_t fftSize, size_t hopSize, size_t numChannels, WindowType window = WINDOW_HANN);
+        ~STFT();
+
+        /*! Processes in into out, which may be the same samples.
+            \return False if the spans differ in frames or don't have numChannels() channels
+        */
+        template <typename Function>
+        bool    process(SampleSpan<const float> in, SampleSpan<float> out, Function&& function);
+        /*! Processes a FLOAT32 packet of numChannels() channels where it lies */
+        template <typename Function>
+        bool    process(AudioPacket& packet, Function&& function);
+
+        /*! Forgets the stream so far; the output starts over with latency() frames of silence */
+        void    reset();
+
+        size_t  fftSize() const;
+        size_t  hopSize() const;
+        size_t  numChannels() const;
+        size_t  numBins() const; /*!< fftSize() / 2 + 1 */
+        size_t  latency() const; /*!< Frames between a sample going in and coming back out */
+
+    private:
+        void    analyze(); // Windows and transforms every channel's last fftSize() frames
+        void    synthesize(); // Transforms every channel back and overlap-adds it, readying the next hop
+
+        const size_t        m_hopSize;
+        const size_t        m_numChannels;
+        RealFFT             m_fft;
+        std::vector<float>  m_window;
+        float               m_scale; // Undoes the gain of the window overlapping itself
+        size_t              m_position; // Frames into the current hop
+
+        // Each of these holds one run per channel, one after the other
+        std::vector<float>  m_input; // fftSize() frames, the last hop being filled
+        std::vector<float>  m_accumulator; // fftSize() frames being overlap-added
+        std::vector<float>  m_ready; // hopSize() frames of finished output
+        std::vector<float>  m_re; // numBins() per channel
+        std::vector<float>  m_im;
+        std::vector<float>  m_time; // fftSize() frames, one channel at a time
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        STFT(const STFT&);
+        STFT(STFT&&);
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // STFT impl
+
+    template <typename Function>
+    bool STFT::process(SampleSpan<const float> in, SampleSpan<float> out, Function&& function)
+    {
+        if(in.numChannels() != m_numChannels || out.numChannels() != m_numChannels || in.numFrames() != out.numFrames())
+            return false;
+
+        const size_t size = fftSize();
+        const size_t bins = numBins();
+        const size_t numFrames = in.numFrames();
+        for(size_t frame = 0; frame < numFrames; ++frame)
+        {
+            // Read every channel before writing any, in case in and out are the same samples
+            for(size_t channel = 0; channel < m_numChannels; ++channel)
+                m_input[channel * size + size - m_hopSize + m_position] = in(frame, channel);
+            for(size_t channel = 0; channel < m_numChannels; ++channel)
+                out(frame, channel) = m_ready[channel * m_hopSize + m_position];
+
+            if(++m_position < m_hopSize)
+                continue;
+
+            m_position = 0;
+            analyze();
+            for(size_t channel = 0; channel < m_numChannels; ++channel)
+                function(channel, &m_re[channel * bins], &m_im[channel * bins], bins);
+            synthesize();
+        }
+        return true;
+    }
+
+    template <typename Function>
+    bool STFT::process(AudioPacket& packet, Function&& function)
+    {
+        const AudioFormat format = packet.getAudioFormat();
+        if(static_cast<size_t>(format.channels) != m_numChannels || encodingOf(format) != FLOAT32)
+            return false;
+
+        const SampleSpan<float> samples = makeSampleSpan<float>(packet);
+        return process(samples, samples, function);
+    }
+
+}
+}
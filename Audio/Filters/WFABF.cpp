@@ -20,6 +20,8 @@
 #include "WFABF.h"
 #include "../AudioPacket.h"
 
+#include <cstring>
+
 #pragma warning(push)
 #pragma warning(disable : 4244) // Get rid of the pesky "double to size_t" conversion warning
 
@@ -45,14 +47,29 @@ namespace Audio {
         const double ratio = double(in.getAudioFormat().samplesPerSecond) / double(out.getAudioFormat().samplesPerSecond);
         if(ratio == 1.)
         {
+            // Straight across, so out holds exactly what in did
+            out.resize(in.byteSize());
             out.assign(in.data(), in.byteSize());
             return true;
         }
 
-        const size_t maxSamples = out.numSamples();
+        // Nearest-neighbour resampling only moves whole frames around, it can't convert between them
+        const size_t bytesPerFrame = in.getAudioFormat().bitsPerBlock;
+        if(bytesPerFrame == 0 || bytesPerFrame != out.getAudioFormat().bitsPerBlock)
+            return false;
+
+        const size_t numInFrames = in.byteSize() / bytesPerFrame;
+        const size_t numOutFrames = out.byteSize() / bytesPerFrame;
+        const AudioByte* inData = in.data();
+        AudioByte* outData = out.data();
 
-        for(size_t i = 0; i < maxSamples; ++i)
-            out[i] = in.at(size_t(double(i) * ratio));
+        for(size_t i = 0; i < numOutFrames; ++i)
+        {
+            size_t source = size_t(double(i) * ratio);
+            if(source >= numInFrames)
+                source = numInFrames - 1;
+            std::memcpy(outData + i * bytesPerFrame, inData + source * bytesPerFrame, bytesPerFrame);
+        }
 
         return true;
     }
@@ -0,0 +1,419 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Interleaving.h"
+#include "AudioPacket.h"
+#include "SampleSpan.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define DX_INTERLEAVING_SSE2
+#endif
+
+#if defined(DX_INTERLEAVING_SSE2)
+    #include <emmintrin.h>
+#endif
+
+namespace DX {
+namespace Audio {
+namespace Interleaving {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Interleaving impl
+
+    // Stands in for any sample type of Size bytes, we only ever copy them
+    template <size_t Size>
+    struct Sample
+    {
+        AudioByte bytes[Size];
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Generic kernels
+
+    /*
+        Handles frames [firstFrame, numFrames), so the SIMD kernels can hand their leftovers off. Walking
+        the interleaved side sequentially is kinder to the cache than walking the planar one.
+    */
+    template <typename T>
+    static void deinterleaveGeneric(const T* in, T* out, size_t numFrames, size_t numChannels, size_t firstFrame)
+    {
+        for(size_t frame = firstFrame; frame < numFrames; ++frame)
+        {
+            const T* source = in + frame * numChannels;
+            for(size_t channel = 0; channel < numChannels; ++channel)
+                out[channel * numFrames + frame] = source[channel];
+        }
+    }
+
+    template <typename T>
+    static void interleaveGeneric(const T* in, T* out, size_t numFrames, size_t numChannels, size_t firstFrame)
+    {
+        for(size_t frame = firstFrame; frame < numFrames; ++frame)
+        {
+            T* destination = out + frame * numChannels;
+            for(size_t channel = 0; channel < numChannels; ++channel)
+                destination[channel] = in[channel * numFrames + frame];
+        }
+    }
+
+#if defined(DX_INTERLEAVING_SSE2)
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // SSE2 kernels
+
+    /*
+        Every kernel works on 4 frames at a time: 4 samples of each channel, one register per channel
+        on the planar side. The shuffles are pure bit moves, so they're just as correct for PCM_INT32
+        as they are for FLOAT32. They return the number of frames they handled, the rest go generic.
+    */
+
+    static size_t deinterleave2(const float* in, float* out, size_t numFrames)
+    {
+        float* left = out;
+        float* right = out + numFrames;
+        size_t frame = 0;
+        for(; frame + 4 <= numFrames; frame += 4)
+        {
+            const __m128 a = _mm_loadu_ps(in + frame * 2);      // L0 R0 L1 R1
+            const __m128 b = _mm_loadu_ps(in + frame * 2 + 4);  // L2 R2 L3 R3
+            _mm_storeu_ps(left + frame, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(right + frame, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+        return frame;
+    }
+
+    static size_t interleave2(const float* in, float* out, size_t numFrames)
+    {
+        const float* left = in;
+        const float* right = in + numFrames;
+        size_t frame = 0;
+        for(; frame + 4 <= numFrames; frame += 4)
+        {
+            const __m128 l = _mm_loadu_ps(left + frame);
+            const __m128 r = _mm_loadu_ps(right + frame);
+            _mm_storeu_ps(out + frame * 2, _mm_unpacklo_ps(l, r));
+            _mm_storeu_ps(out + frame * 2 + 4, _mm_unpackhi_ps(l, r));
+        }
+        return frame;
+    }
+
+    static size_t deinterleave4(const float* in, float* out, size_t numFrames)
+    {
+        size_t frame = 0;
+        for(; frame + 4 <= numFrames; frame += 4)
+        {
+            const float* source = in + frame * 4;
+            __m128 c0 = _mm_loadu_ps(source);
+            __m128 c1 = _mm_loadu_ps(source + 4);
+            __m128 c2 = _mm_loadu_ps(source + 8);
+            __m128 c3 = _mm_loadu_ps(source + 12);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            _mm_storeu_ps(out + frame, c0);
+            _mm_storeu_ps(out + numFrames + frame, c1);
+            _mm_storeu_ps(out + numFrames * 2 + frame, c2);
+            _mm_storeu_ps(out + numFrames * 3 + frame, c3);
+        }
+        return frame;
+    }
+
+    static size_t interleave4(const float* in, float* out, size_t numFrames)
+    {
+        size_t frame = 0;
+        for(; frame + 4 <= numFrames; frame += 4)
+        {
+            __m128 f0 = _mm_loadu_ps(in + frame);
+            __m128 f1 = _mm_loadu_ps(in + numFrames + frame);
+            __m128 f2 = _mm_loadu_ps(in + numFrames * 2 + frame);
+            __m128 f3 = _mm_loadu_ps(in + numFrames * 3 + frame);
+            _MM_TRANSPOSE4_PS(f0, f1, f2, f3);
+            float* destination = out + frame * 4;
+            _mm_storeu_ps(destination, f0);
+            _mm_storeu_ps(destination + 4, f1);
+            _mm_storeu_ps(destination + 8, f2);
+            _mm_storeu_ps(destination + 12, f3);
+        }
+        return frame;
+    }
+
+    static size_t deinterleave6(const float* in, float* out, size_t numFrames)
+    {
+        size_t frame = 0;
+        for(; frame + 4 <= numFrames; frame += 4)
+        {
+            // 4 frames of 6 channels are 6 registers, with frames 1 and 3 straddling a boundary
+            const float* source = in + frame * 6;
+            const __m128 v0 = _mm_loadu_ps(source);
+            const __m128 v1 = _mm_loadu_ps(source + 4);
+            const __m128 v2 = _mm_loadu_ps(source + 8);
+            const __m128 v3 = _mm_loadu_ps(source + 12);
+            const __m128 v4 = _mm_loadu_ps(source + 16);
+            const __m128 v5 = _mm_loadu_ps(source + 20);
+
+            // Channels 0 - 3 of each frame, then a plain transpose
+            __m128 c0 = v0;
+            __m128 c1 = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(1, 0, 3, 2));
+            __m128 c2 = v3;
+            __m128 c3 = _mm_shuffle_ps(v4, v5, _MM_SHUFFLE(1, 0, 3, 2));
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+            // Channels 4 and 5, as (4, 5) pairs for frames 0 and 1, then 2 and 3
+            const __m128 low = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(3, 2, 1, 0));
+            const __m128 high = _mm_shuffle_ps(v4, v5, _MM_SHUFFLE(3, 2, 1, 0));
+
+            _mm_storeu_ps(out + frame, c0);
+            _mm_storeu_ps(out + numFrames + frame, c1);
+            _mm_storeu_ps(out + numFrames * 2 + frame, c2);
+            _mm_storeu_ps(out + numFrames * 3 + frame, c3);
+            _mm_storeu_ps(out + numFrames * 4 + frame, _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(out + numFrames * 5 + frame, _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+        return frame;
+    }
+
+    static size_t interleave6(const float* in, float* out, size_t numFrames)
+    {
+        size_t frame = 0;
+        for(; frame + 4 <= numFrames; frame += 4)
+        {
+            __m128 f0 = _mm_loadu_ps(in + frame);
+            __m128 f1 = _mm_loadu_ps(in + numFrames + frame);
+            __m128 f2 = _mm_loadu_ps(in + numFrames * 2 + frame);
+            __m128 f3 = _mm_loadu_ps(in + numFrames * 3 + frame);
+            _MM_TRANSPOSE4_PS(f0, f1, f2, f3);
+
+            const __m128 c4 = _mm_loadu_ps(in + numFrames * 4 + frame);
+            const __m128 c5 = _mm_loadu_ps(in + numFrames * 5 + frame);
+            const __m128 low = _mm_unpacklo_ps(c4, c5);     // (4, 5) of frames 0 and 1
+            const __m128 high = _mm_unpackhi_ps(c4, c5);    // (4, 5) of frames 2 and 3
+
+            float* destination = out + frame * 6;
+            _mm_storeu_ps(destination, f0);
+            _mm_storeu_ps(destination + 4, _mm_shuffle_ps(low, f1, _MM_SHUFFLE(1, 0, 1, 0)));
+            _mm_storeu_ps(destination + 8, _mm_shuffle_ps(f1, low, _MM_SHUFFLE(3, 2, 3, 2)));
+            _mm_storeu_ps(destination + 12, f2);
+            _mm_storeu_ps(destination + 16, _mm_shuffle_ps(high, f3, _MM_SHUFFLE(1, 0, 1, 0)));
+            _mm_storeu_ps(destination + 20, _mm_shuffle_ps(f3, high, _MM_SHUFFLE(3, 2, 3, 2)));
+        }
+        return frame;
+    }
+
+    static size_t deinterleave8(const float* in, float* out, size_t numFrames)
+    {
+        size_t frame = 0;
+        for(; frame + 4 <= numFrames; frame += 4)
+        {
+            // Two 4x4 transposes, one for channels 0 - 3 and one for 4 - 7
+            const float* source = in + frame * 8;
+            __m128 a0 = _mm_loadu_ps(source);
+            __m128 b0 = _mm_loadu_ps(source + 4);
+            __m128 a1 = _mm_loadu_ps(source + 8);
+            __m128 b1 = _mm_loadu_ps(source + 12);
+            __m128 a2 = _mm_loadu_ps(source + 16);
+            __m128 b2 = _mm_loadu_ps(source + 20);
+            __m128 a3 = _mm_loadu_ps(source + 24);
+            __m128 b3 = _mm_loadu_ps(source + 28);
+            _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+            _MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+            _mm_storeu_ps(out + frame, a0);
+            _mm_storeu_ps(out + numFrames + frame, a1);
+            _mm_storeu_ps(out + numFrames * 2 + frame, a2);
+            _mm_storeu_ps(out + numFrames * 3 + frame, a3);
+            _mm_storeu_ps(out + numFrames * 4 + frame, b0);
+            _mm_storeu_ps(out + numFrames * 5 + frame, b1);
+            _mm_storeu_ps(out + numFrames * 6 + frame, b2);
+            _mm_storeu_ps(out + numFrames * 7 + frame, b3);
+        }
+        return frame;
+    }
+
+    static size_t interleave8(const float* in, float* out, size_t numFrames)
+    {
+        size_t frame = 0;
+        for(; frame + 4 <= numFrames; frame += 4)
+        {
+            __m128 a0 = _mm_loadu_ps(in + frame);
+            __m128 a1 = _mm_loadu_ps(in + numFrames + frame);
+            __m128 a2 = _mm_loadu_ps(in + numFrames * 2 + frame);
+            __m128 a3 = _mm_loadu_ps(in + numFrames * 3 + frame);
+            __m128 b0 = _mm_loadu_ps(in + numFrames * 4 + frame);
+            __m128 b1 = _mm_loadu_ps(in + numFrames * 5 + frame);
+            __m128 b2 = _mm_loadu_ps(in + numFrames * 6 + frame);
+            __m128 b3 = _mm_loadu_ps(in + numFrames * 7 + frame);
+            _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+            _MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+            float* destination = out + frame * 8;
+            _mm_storeu_ps(destination, a0);
+            _mm_storeu_ps(destination + 4, b0);
+            _mm_storeu_ps(destination + 8, a1);
+            _mm_storeu_ps(destination + 12, b1);
+            _mm_storeu_ps(destination + 16, a2);
+            _mm_storeu_ps(destination + 20, b2);
+            _mm_storeu_ps(destination + 24, a3);
+            _mm_storeu_ps(destination + 28, b3);
+        }
+        return frame;
+    }
+
+#endif
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Dispatch
+
+    static void deinterleave32(const void* in, void* out, size_t numFrames, size_t numChannels)
+    {
+        size_t done = 0;
+    #if defined(DX_INTERLEAVING_SSE2)
+        const float* source = static_cast<const float*>(in);
+        float* destination = static_cast<float*>(out);
+        switch(numChannels)
+        {
+        case 2: done = deinterleave2(source, destination, numFrames); break;
+        case 4: done = deinterleave4(source, destination, numFrames); break;
+        case 6: done = deinterleave6(source, destination, numFrames); break;
+        case 8: done = deinterleave8(source, destination, numFrames); break;
+        default: break;
+        }
+    #endif
+        deinterleaveGeneric(static_cast<const Sample<4>*>(in), static_cast<Sample<4>*>(out), numFrames, numChannels, done);
+    }
+
+    static void interleave32(const void* in, void* out, size_t numFrames, size_t numChannels)
+    {
+        size_t done = 0;
+    #if defined(DX_INTERLEAVING_SSE2)
+        const float* source = static_cast<const float*>(in);
+        float* destination = static_cast<float*>(out);
+        switch(numChannels)
+        {
+        case 2: done = interleave2(source, destination, numFrames); break;
+        case 4: done = interleave4(source, destination, numFrames); break;
+        case 6: done = interleave6(source, destination, numFrames); break;
+        case 8: done = interleave8(source, destination, numFrames); break;
+        default: break;
+        }
+    #endif
+        interleaveGeneric(static_cast<const Sample<4>*>(in), static_cast<Sample<4>*>(out), numFrames, numChannels, done);
+    }
+
+    void deinterleave(const void* in, void* out, size_t numFrames, size_t numChannels, size_t bytesPerSample)
+    {
+        if(numFrames == 0 || numChannels == 0)
+            return;
+
+        // Nothing to rearrange, both layouts are the same thing
+        if(numChannels == 1 || numFrames == 1)
+        {
+            std::memcpy(out, in, numFrames * numChannels * bytesPerSample);
+            return;
+        }
+
+        switch(bytesPerSample)
+        {
+        case 1: deinterleaveGeneric(static_cast<const Sample<1>*>(in), static_cast<Sample<1>*>(out), numFrames, numChannels, 0); break;
+        case 2: deinterleaveGeneric(static_cast<const int16_t*>(in), static_cast<int16_t*>(out), numFrames, numChannels, 0); break;
+        case 3: deinterleaveGeneric(static_cast<const Int24*>(in), static_cast<Int24*>(out), numFrames, numChannels, 0); break;
+        case 4: deinterleave32(in, out, numFrames, numChannels); break;
+        case 8: deinterleaveGeneric(static_cast<const Sample<8>*>(in), static_cast<Sample<8>*>(out), numFrames, numChannels, 0); break;
+        default:
+            // Odd sizes, one byte run at a time
+            for(size_t frame = 0; frame < numFrames; ++frame)
+            {
+                for(size_t channel = 0; channel < numChannels; ++channel)
+                {
+                    std::memcpy(static_cast<AudioByte*>(out) + (channel * numFrames + frame) * bytesPerSample,
+                        static_cast<const AudioByte*>(in) + (frame * numChannels + channel) * bytesPerSample, bytesPerSample);
+                }
+            }
+            break;
+        }
+    }
+
+    void interleave(const void* in, void* out, size_t numFrames, size_t numChannels, size_t bytesPerSample)
+    {
+        if(numFrames == 0 || numChannels == 0)
+            return;
+
+        if(numChannels == 1 || numFrames == 1)
+        {
+            std::memcpy(out, in, numFrames * numChannels * bytesPerSample);
+            return;
+        }
+
+        switch(bytesPerSample)
+        {
+        case 1: interleaveGeneric(static_cast<const Sample<1>*>(in), static_cast<Sample<1>*>(out), numFrames, numChannels, 0); break;
+        case 2: interleaveGeneric(static_cast<const int16_t*>(in), static_cast<int16_t*>(out), numFrames, numChannels, 0); break;
+        case 3: interleaveGeneric(static_cast<const Int24*>(in), static_cast<Int24*>(out), numFrames, numChannels, 0); break;
+        case 4: interleave32(in, out, numFrames, numChannels); break;
+        case 8: interleaveGeneric(static_cast<const Sample<8>*>(in), static_cast<Sample<8>*>(out), numFrames, numChannels, 0); break;
+        default:
+            for(size_t frame = 0; frame < numFrames; ++frame)
+            {
+                for(size_t channel = 0; channel < numChannels; ++channel)
+                {
+                    std::memcpy(static_cast<AudioByte*>(out) + (frame * numChannels + channel) * bytesPerSample,
+                        static_cast<const AudioByte*>(in) + (channel * numFrames + frame) * bytesPerSample, bytesPerSample);
+                }
+            }
+            break;
+        }
+    }
+
+    bool convertLayout(const AudioPacket& in, AudioPacket& out)
+    {
+        const AudioFormat inFormat = in.getAudioFormat();
+        AudioFormat outFormat = out.getAudioFormat();
+        const SampleLayout outLayout = outFormat.layout;
+        outFormat.layout = inFormat.layout;
+        if(inFormat != outFormat || in.byteSize() != out.byteSize())
+            return false;
+        if(inFormat.channels == 0 || inFormat.bitsPerBlock == 0 || inFormat.bitsPerBlock % inFormat.channels != 0)
+            return false;
+
+        out.setTimestamp(in.getTimestamp());
+        if(in.byteSize() == 0)
+            return true;
+
+        const size_t numFrames = in.byteSize() / inFormat.bitsPerBlock;
+        const size_t sampleSize = inFormat.bitsPerBlock / inFormat.channels;
+        if(inFormat.layout == outLayout)
+            std::memcpy(out.data(), in.data(), in.byteSize());
+        else if(outLayout == PLANAR)
+            deinterleave(in.data(), out.data(), numFrames, inFormat.channels, sampleSize);
+        else
+            interleave(in.data(), out.data(), numFrames, inFormat.channels, sampleSize);
+        return true;
+    }
+
+    const char* kernelName()
+    {
+    #if defined(DX_INTERLEAVING_SSE2)
+        return "SSE2";
+    #else
+        return "generic";
+    #endif
+    }
+
+}
+}
+}
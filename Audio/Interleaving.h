@@ -0,0 +1,88 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX Audio - Interleaving moves samples between INTERLEAVED and PLANAR layouts, SIMD accelerated
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "AudioFormat.h"
+
+#include <cstddef>
+
+namespace DX {
+namespace Audio {
+
+    class AudioPacket;
+
+namespace Interleaving {
+
+    /*! \brief Interleaving converts blocks of audio between the INTERLEAVED layout devices use and the
+        PLANAR layout that per-channel DSP prefers (see SampleLayout).
+
+        Only the size of a sample matters here - nothing is converted, samples are just moved - so
+        4 byte samples (FLOAT32 and PCM_INT32) share the same kernels. Those are vectorized with SSE2
+        for 2, 4, 6 and 8 channels, which covers stereo through 7.1. Other channel counts and sample
+        sizes are handled by plain loops.
+
+        A pipeline should convert once, on the way in to the filters that asked for PLANAR (see
+        AbstractFilter::preferredLayout()), and once on the way back out to the device - not per
+        filter.
+
+        \code
+        AudioFormat planarFormat = packet.getAudioFormat();
+        planarFormat.layout = PLANAR;
+
+        AudioPacket planar(planarFormat, packet.byteSize());
+        Interleaving::convertLayout(packet, planar);
+        \endcode
+    */
+
+    /*! Splits numFrames interleaved frames of numChannels channels into numChannels runs of numFrames
+        samples each.
+
+        \param[in] bytesPerSample   The size of a single sample, 1 through 8 AudioBytes
+
+        \note in and out must not overlap.
+    */
+    void        deinterleave(const void* in, void* out, size_t numFrames, size_t numChannels, size_t bytesPerSample);
+
+    /*! Weaves numChannels runs of numFrames samples each back into numFrames interleaved frames. The
+        inverse of deinterleave().
+
+        \note in and out must not overlap.
+    */
+    void        interleave(const void* in, void* out, size_t numFrames, size_t numChannels, size_t bytesPerSample);
+
+    /*! Copies in into out, converting from in's SampleLayout to out's. Same-layout packets are
+        simply copied. out takes in's AudioTimestamp.
+
+        \return False if the packets differ in anything but layout, or aren't the same size
+    */
+    bool        convertLayout(const AudioPacket& in, AudioPacket& out);
+
+    /*! \return The name of the widest kernel set compiled in: "SSE2" or "generic" */
+    const char* kernelName();
+
+}
+}
+}
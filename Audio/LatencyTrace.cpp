@@ -0,0 +1,256 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "LatencyTrace.h"
+#include "AudioPacket.h"
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // LatencyHistogram impl
+
+    static const uint64_t LINEAR_LIMIT = 1ULL << LATENCY_PRECISION_BITS;
+    static const uint64_t HALF_LINEAR_LIMIT = LINEAR_LIMIT >> 1;
+
+    // Index of the highest set bit, value must not be 0
+    static inline unsigned int magnitudeOf(uint64_t value)
+    {
+        unsigned int magnitude = 0;
+        while(value >>= 1)
+            ++magnitude;
+        return magnitude;
+    }
+
+    LatencyHistogram::LatencyHistogram()
+    {
+        reset();
+    }
+
+    LatencyHistogram::~LatencyHistogram()
+    {
+    }
+
+    void LatencyHistogram::record(uint64_t ticks)
+    {
+        m_buckets[bucketOf(ticks)].fetch_add(1, std::memory_order_relaxed);
+        m_total.fetch_add(ticks, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+
+        // Only contended when a new extreme comes in, which settles quickly
+        uint64_t current = m_min.load(std::memory_order_relaxed);
+        while(ticks < current && !m_min.compare_exchange_weak(current, ticks, std::memory_order_relaxed))
+            ;
+        current = m_max.load(std::memory_order_relaxed);
+        while(ticks > current && !m_max.compare_exchange_weak(current, ticks, std::memory_order_relaxed))
+            ;
+    }
+
+    void LatencyHistogram::reset()
+    {
+        for(size_t i = 0; i < NUM_BUCKETS; ++i)
+            m_buckets[i].store(0, std::memory_order_relaxed);
+        m_count = 0;
+        m_total = 0;
+        m_min = UINT64_MAX;
+        m_max = 0;
+    }
+
+    uint64_t LatencyHistogram::count() const
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t LatencyHistogram::minValue() const
+    {
+        const uint64_t lowest = m_min.load(std::memory_order_relaxed);
+        return lowest == UINT64_MAX ? 0 : lowest;
+    }
+
+    uint64_t LatencyHistogram::maxValue() const
+    {
+        return m_max.load(std::memory_order_relaxed);
+    }
+
+    double LatencyHistogram::mean() const
+    {
+        const uint64_t total = m_count.load(std::memory_order_relaxed);
+        return total > 0 ? static_cast<double>(m_total.load(std::memory_order_relaxed)) / total : 0.0;
+    }
+
+    uint64_t LatencyHistogram::percentile(double percent) const
+    {
+        // Count from the buckets themselves, so a record that's only half done can't throw us off
+        uint64_t counts[NUM_BUCKETS];
+        uint64_t total = 0;
+        for(size_t i = 0; i < NUM_BUCKETS; ++i)
+        {
+            counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        if(total == 0)
+            return 0;
+
+        const double clamped = percent < 0.0 ? 0.0 : (percent > 100.0 ? 100.0 : percent);
+        uint64_t rank = static_cast<uint64_t>(clamped / 100.0 * total + 0.5);
+        if(rank == 0)
+            rank = 1;
+
+        uint64_t seen = 0;
+        for(size_t i = 0; i < NUM_BUCKETS; ++i)
+        {
+            seen += counts[i];
+            if(seen >= rank)
+                return highestValueIn(i);
+        }
+        return highestValueIn(NUM_BUCKETS - 1);
+    }
+
+    size_t LatencyHistogram::bucketOf(uint64_t ticks)
+    {
+        if(ticks < LINEAR_LIMIT)
+            return static_cast<size_t>(ticks);
+
+        const unsigned int magnitude = magnitudeOf(ticks);
+        if(magnitude >= LATENCY_MAX_MAGNITUDE)
+            return NUM_BUCKETS - 1;
+
+        // The top LATENCY_PRECISION_BITS - 1 bits below the leading one pick the bucket within the power of two
+        const unsigned int shift = magnitude - (LATENCY_PRECISION_BITS - 1);
+        const uint64_t subBucket = (ticks >> shift) - HALF_LINEAR_LIMIT;
+        return static_cast<size_t>(LINEAR_LIMIT + (magnitude - LATENCY_PRECISION_BITS) * HALF_LINEAR_LIMIT + subBucket);
+    }
+
+    uint64_t LatencyHistogram::highestValueIn(size_t bucket)
+    {
+        if(bucket < LINEAR_LIMIT)
+            return bucket;
+
+        const uint64_t offset = bucket - LINEAR_LIMIT;
+        const unsigned int magnitude = static_cast<unsigned int>(offset / HALF_LINEAR_LIMIT) + LATENCY_PRECISION_BITS;
+        const uint64_t subBucket = offset % HALF_LINEAR_LIMIT + HALF_LINEAR_LIMIT;
+        const unsigned int shift = magnitude - (LATENCY_PRECISION_BITS - 1);
+        return ((subBucket + 1) << shift) - 1;
+    }
+
+namespace LatencyTrace {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // LatencyTrace impl
+
+    static std::atomic<bool>    s_enabled(false);
+    static LatencyHistogram     s_histograms[NUM_STAGES];
+
+    static const char* const    STAGE_NAMES[NUM_STAGES] =
+    {
+        "capture to enqueue",
+        "queued",
+        "filter",
+        "filter to release",
+        "end to end"
+    };
+
+    void setEnabled(bool enabled)
+    {
+        s_enabled = enabled;
+    }
+
+    bool isEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    const LatencyHistogram& histogram(Stage stage)
+    {
+        return s_histograms[stage];
+    }
+
+    const char* stageName(Stage stage)
+    {
+        return stage < NUM_STAGES ? STAGE_NAMES[stage] : "unknown";
+    }
+
+    void reset()
+    {
+        for(size_t i = 0; i < NUM_STAGES; ++i)
+            s_histograms[i].reset();
+    }
+
+    void record(Stage stage, uint64_t ticks)
+    {
+        if(isEnabled() && stage < NUM_STAGES)
+            s_histograms[stage].record(ticks);
+    }
+
+    uint64_t now()
+    {
+        return isEnabled() ? audioClockNow() : 0;
+    }
+
+    // Clocks can disagree by a tick or so between threads; never let that wrap around
+    static inline uint64_t elapsed(uint64_t from, uint64_t to)
+    {
+        return to > from ? to - from : 0;
+    }
+
+    void enqueued(AudioPacket& packet)
+    {
+        if(!isEnabled())
+            return;
+
+        AudioTimestamp timestamp = packet.getTimestamp();
+        timestamp.enqueueTime = audioClockNow();
+        if(timestamp.isValid() && timestamp.captureTime != 0)
+            record(CAPTURE_TO_ENQUEUE, elapsed(timestamp.captureTime, timestamp.enqueueTime));
+        packet.setTimestamp(timestamp);
+    }
+
+    void filtered(const AudioPacket& in, uint64_t filterStart, AudioPacket& out)
+    {
+        if(!isEnabled() || filterStart == 0)
+            return;
+
+        AudioTimestamp timestamp = out.getTimestamp();
+        timestamp.filteredTime = audioClockNow();
+        record(FILTER, elapsed(filterStart, timestamp.filteredTime));
+
+        const uint64_t enqueueTime = in.getTimestamp().enqueueTime;
+        if(enqueueTime != 0)
+            record(QUEUED, elapsed(enqueueTime, filterStart));
+        out.setTimestamp(timestamp);
+    }
+
+    void released(const AudioTimestamp& timestamp)
+    {
+        if(!isEnabled())
+            return;
+
+        const uint64_t releaseTime = audioClockNow();
+        if(timestamp.filteredTime != 0)
+            record(FILTER_TO_RELEASE, elapsed(timestamp.filteredTime, releaseTime));
+        if(timestamp.isValid() && timestamp.captureTime != 0)
+            record(END_TO_END, elapsed(timestamp.captureTime, releaseTime));
+    }
+
+}
+
+}
+}
@@ -0,0 +1,176 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX Audio - LatencyTrace measures how long audio spends in each stage from capture to playback
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "AudioTimestamp.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace DX {
+namespace Audio {
+
+    class AudioPacket;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // LatencyHistogram
+
+    //! Defines how many bits of each value a LatencyHistogram keeps, which sets its precision. Arbitrary for now, best results TBD
+    #ifndef LATENCY_PRECISION_BITS
+        #define LATENCY_PRECISION_BITS 6
+    #endif
+
+    //! Defines the largest value (as a power of two) a LatencyHistogram tells apart. Arbitrary for now, best results TBD
+    #ifndef LATENCY_MAX_MAGNITUDE
+        #define LATENCY_MAX_MAGNITUDE 40
+    #endif
+
+    /*! \brief LatencyHistogram is a lock-free, log-linear (HDR-style) histogram of durations in
+        audio clock ticks.
+
+        Values below 2^LATENCY_PRECISION_BITS get a bucket each. Above that, every power of two is
+        split into 2^(LATENCY_PRECISION_BITS - 1) equal buckets, so any value is known to within about
+        3% however large it is, and the whole range up to 2^LATENCY_MAX_MAGNITUDE ticks (over a day)
+        fits in a fixed array of counters. Larger values land in the last bucket.
+
+        record() is a couple of relaxed atomic adds, safe from any number of threads at once, and
+        never allocates. Queries may run at the same time as records; they see every record that
+        finished before they started, and maybe some that didn't.
+    */
+    class LatencyHistogram
+    {
+    public:
+        LatencyHistogram();
+        ~LatencyHistogram();
+
+        void        record(uint64_t ticks);
+        void        reset();
+
+        uint64_t    count() const;
+        uint64_t    minValue() const; /*!< 0 while empty */
+        uint64_t    maxValue() const;
+        double      mean() const;
+
+        /*! \param[in] percent  Which percentile, 0 to 100 (99.9 for p99.9)
+            \return The value that percent of records are at or below, as the upper edge of its
+            bucket. 0 while empty.
+        */
+        uint64_t    percentile(double percent) const;
+
+        //! One bucket per value below 2^LATENCY_PRECISION_BITS, then 2^(LATENCY_PRECISION_BITS - 1) per power of two
+        static const size_t NUM_BUCKETS = (1 << LATENCY_PRECISION_BITS)
+            + (LATENCY_MAX_MAGNITUDE - LATENCY_PRECISION_BITS) * (1 << (LATENCY_PRECISION_BITS - 1));
+
+    private:
+        static size_t   bucketOf(uint64_t ticks);
+        static uint64_t highestValueIn(size_t bucket);
+
+        std::atomic<uint64_t>   m_buckets[NUM_BUCKETS];
+        std::atomic<uint64_t>   m_count;
+        std::atomic<uint64_t>   m_total;
+        std::atomic<uint64_t>   m_min;
+        std::atomic<uint64_t>   m_max;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        LatencyHistogram(const LatencyHistogram&);
+        LatencyHistogram(LatencyHistogram&&);
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // LatencyTrace
+
+namespace LatencyTrace {
+
+    /*! \brief LatencyTrace follows audio from the capture device to the playback device and keeps a
+        LatencyHistogram of how long each stage took.
+
+        Each AudioPacket's AudioTimestamp picks up the points it passes: captureTime from the capture
+        device, enqueueTime when it is pushed onto an AudioStream, and filteredTime when the playback
+        device has run its filter. When the playback device's ReleaseBuffer completes, the first frame
+        released finishes the trace. The stages are the gaps between those points, plus the whole
+        trip, END_TO_END.
+
+        Tracing is off until setEnabled(true). While off, nothing reads the clock and nothing is
+        recorded. The histograms can be read at any time, by any thread, while audio is running.
+
+        \code
+        LatencyTrace::setEnabled(true);
+        // ... run capture -> playback for a while ...
+        for(int stage = 0; stage < LatencyTrace::NUM_STAGES; ++stage)
+        {
+            const LatencyHistogram& histogram = LatencyTrace::histogram(LatencyTrace::Stage(stage));
+            printf("%s p99.9: %.2f ms\n", LatencyTrace::stageName(LatencyTrace::Stage(stage)),
+                audioClockSeconds(histogram.percentile(99.9)) * 1000.0);
+        }
+        \endcode
+    */
+    enum Stage
+    {
+        CAPTURE_TO_ENQUEUE  = 0, /*!< Device capture until pushed onto an AudioStream */
+        QUEUED              = 1, /*!< Pushed onto an AudioStream until the playback side starts filtering it */
+        FILTER              = 2, /*!< Filtering, layout conversions included */
+        FILTER_TO_RELEASE   = 3, /*!< Filtered until the playback device's ReleaseBuffer completes */
+        END_TO_END          = 4, /*!< Device capture until the playback device's ReleaseBuffer completes */
+        NUM_STAGES          = 5
+    };
+
+    void                    setEnabled(bool enabled);
+    bool                    isEnabled();
+
+    /*! \return The histogram for stage */
+    const LatencyHistogram& histogram(Stage stage);
+    /*! \return A printable name for stage */
+    const char*             stageName(Stage stage);
+    /*! Empties every histogram */
+    void                    reset();
+
+    /*! Adds ticks to stage's histogram, if tracing is enabled */
+    void                    record(Stage stage, uint64_t ticks);
+
+    /*! \return audioClockNow() if tracing is enabled, otherwise 0 */
+    uint64_t                now();
+
+    /*! Stamps packet's enqueueTime. Call right before pushing it onto an AudioStream. */
+    void                    enqueued(AudioPacket& packet);
+    /*! Records QUEUED and FILTER for a filter that began at filterStart (from now()), and stamps
+        out's filteredTime
+    */
+    void                    filtered(const AudioPacket& in, uint64_t filterStart, AudioPacket& out);
+    /*! Records FILTER_TO_RELEASE and END_TO_END for audio stamped with timestamp that has just been
+        released to a playback device
+    */
+    void                    released(const AudioTimestamp& timestamp);
+
+}
+
+}
+}
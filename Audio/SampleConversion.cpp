@@ -0,0 +1,551 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SampleConversion.h"
+#include "AudioPacket.h"
+#include "SampleSpan.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+    #define DX_CONVERSION_AVX2
+#endif
+
+#if defined(DX_CONVERSION_AVX2) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define DX_CONVERSION_SSE2
+#endif
+
+#if defined(DX_CONVERSION_AVX2)
+    #include <immintrin.h>
+#elif defined(DX_CONVERSION_SSE2)
+    #include <emmintrin.h>
+#endif
+
+namespace DX {
+namespace Audio {
+namespace SampleConversion {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // SampleConversion impl
+
+    static const float  INT16_SCALE = 32768.f;
+    static const float  INT24_SCALE = 8388608.f;
+    static const double INT32_SCALE = 2147483648.;
+    // The largest float that still fits in an int32_t, 2^31 itself would overflow the conversion
+    static const float  INT32_MAX_FLOAT = 2147483520.f;
+
+    // Pairs that go through an intermediate buffer do so this many samples at a time (on the stack)
+    static const size_t CHUNK_SIZE = 256;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Dither
+
+    // Out here rather than in nextDitherSeed(), where VS2013 wouldn't guard its initialization
+    static std::atomic<uint32_t> s_ditherCounter(0x2545F491u);
+
+    // Each call gets its own seed, so concurrent conversions don't share (or fight over) any state
+    static uint32_t nextDitherSeed()
+    {
+        const uint32_t seed = s_ditherCounter.fetch_add(0x9E3779B9u, std::memory_order_relaxed);
+        return seed != 0 ? seed : 1;
+    }
+
+    static inline uint32_t xorshift(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Uniform in [0, 1)
+    static inline float uniform(uint32_t& state)
+    {
+        return float(xorshift(state) >> 8) * (1.f / 16777216.f);
+    }
+
+    // Triangular in (-1, 1), in units of the output's least significant bit
+    static inline float tpdf(uint32_t& state)
+    {
+        return uniform(state) - uniform(state);
+    }
+
+#ifdef DX_CONVERSION_SSE2
+
+    static inline __m128i xorshift(__m128i& state)
+    {
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+        state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+        return state;
+    }
+
+    // Builds floats in [1, 2) straight from the random mantissa bits, then shifts them down to [0, 1)
+    static inline __m128 uniform(__m128i& state)
+    {
+        const __m128i bits = _mm_or_si128(_mm_srli_epi32(xorshift(state), 9), _mm_set1_epi32(0x3F800000));
+        return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.f));
+    }
+
+    static inline __m128 tpdf(__m128i& state)
+    {
+        const __m128 first = uniform(state);
+        return _mm_sub_ps(first, uniform(state));
+    }
+
+    static inline __m128i seedLanes(uint32_t seed)
+    {
+        return _mm_set_epi32(int(seed * 0x9E3779B9u | 1), int(seed * 0x85EBCA6Bu | 1),
+            int(seed * 0xC2B2AE35u | 1), int(seed | 1));
+    }
+
+#endif
+
+#ifdef DX_CONVERSION_AVX2
+
+    static inline __m256i xorshift(__m256i& state)
+    {
+        state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 13));
+        state = _mm256_xor_si256(state, _mm256_srli_epi32(state, 17));
+        state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 5));
+        return state;
+    }
+
+    static inline __m256 uniform(__m256i& state)
+    {
+        const __m256i bits = _mm256_or_si256(_mm256_srli_epi32(xorshift(state), 9), _mm256_set1_epi32(0x3F800000));
+        return _mm256_sub_ps(_mm256_castsi256_ps(bits), _mm256_set1_ps(1.f));
+    }
+
+    static inline __m256 tpdf(__m256i& state)
+    {
+        const __m256 first = uniform(state);
+        return _mm256_sub_ps(first, uniform(state));
+    }
+
+#endif
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Scalar helpers
+
+    static inline float clampFloat(float value, float low, float high)
+    {
+        return value < low ? low : (value > high ? high : value);
+    }
+
+    static inline double clampDouble(double value, double low, double high)
+    {
+        return value < low ? low : (value > high ? high : value);
+    }
+
+    // Round to nearest. Ties go away from zero rather than to even like the vector paths, which is inaudible
+    static inline int32_t roundToInt(float value)
+    {
+        return int32_t(value < 0.f ? value - 0.5f : value + 0.5f);
+    }
+
+    static inline int64_t roundToInt(double value)
+    {
+        return int64_t(value < 0. ? value - 0.5 : value + 0.5);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // PCM_INT16 <-> FLOAT32
+
+    static void int16ToFloat(const int16_t* in, float* out, size_t count)
+    {
+        size_t i = 0;
+    #if defined(DX_CONVERSION_AVX2)
+        const __m256 scale = _mm256_set1_ps(1.f / INT16_SCALE);
+        for(; i + 8 <= count; i += 8)
+        {
+            const __m256i wide = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(wide), scale));
+        }
+    #elif defined(DX_CONVERSION_SSE2)
+        const __m128 scale = _mm_set1_ps(1.f / INT16_SCALE);
+        for(; i + 8 <= count; i += 8)
+        {
+            const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            // Duplicate each sample into both halves of a 32-bit lane, then shift to sign extend
+            const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+            const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+            _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+        }
+    #endif
+        for(; i < count; ++i)
+            out[i] = float(in[i]) * (1.f / INT16_SCALE);
+    }
+
+    static void floatToInt16(const float* in, int16_t* out, size_t count, DitherMode dither)
+    {
+        uint32_t state = nextDitherSeed();
+        size_t i = 0;
+    #if defined(DX_CONVERSION_AVX2)
+        const __m256 scale = _mm256_set1_ps(INT16_SCALE);
+        const __m256 low = _mm256_set1_ps(-INT16_SCALE);
+        const __m256 high = _mm256_set1_ps(INT16_SCALE - 1.f);
+        __m256i lanes = _mm256_inserti128_si256(_mm256_castsi128_si256(seedLanes(state)), seedLanes(state ^ 0xA5A5A5A5u), 1);
+        for(; i + 16 <= count; i += 16)
+        {
+            __m256 first = _mm256_mul_ps(_mm256_loadu_ps(in + i), scale);
+            __m256 second = _mm256_mul_ps(_mm256_loadu_ps(in + i + 8), scale);
+            if(dither == TPDF_DITHER)
+            {
+                first = _mm256_add_ps(first, tpdf(lanes));
+                second = _mm256_add_ps(second, tpdf(lanes));
+            }
+            first = _mm256_min_ps(_mm256_max_ps(first, low), high);
+            second = _mm256_min_ps(_mm256_max_ps(second, low), high);
+            // packs works within 128-bit lanes, so the 64-bit quarters need putting back in order
+            const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(first), _mm256_cvtps_epi32(second));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+        }
+    #elif defined(DX_CONVERSION_SSE2)
+        const __m128 scale = _mm_set1_ps(INT16_SCALE);
+        const __m128 low = _mm_set1_ps(-INT16_SCALE);
+        const __m128 high = _mm_set1_ps(INT16_SCALE - 1.f);
+        __m128i lanes = seedLanes(state);
+        for(; i + 8 <= count; i += 8)
+        {
+            __m128 first = _mm_mul_ps(_mm_loadu_ps(in + i), scale);
+            __m128 second = _mm_mul_ps(_mm_loadu_ps(in + i + 4), scale);
+            if(dither == TPDF_DITHER)
+            {
+                first = _mm_add_ps(first, tpdf(lanes));
+                second = _mm_add_ps(second, tpdf(lanes));
+            }
+            // cvtps turns anything past int32 range into INT_MIN, so clamp before converting
+            first = _mm_min_ps(_mm_max_ps(first, low), high);
+            second = _mm_min_ps(_mm_max_ps(second, low), high);
+            const __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(first), _mm_cvtps_epi32(second));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+        }
+    #endif
+        for(; i < count; ++i)
+        {
+            float value = in[i] * INT16_SCALE;
+            if(dither == TPDF_DITHER)
+                value += tpdf(state);
+            out[i] = int16_t(roundToInt(clampFloat(value, -INT16_SCALE, INT16_SCALE - 1.f)));
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // PCM_INT32 <-> FLOAT32
+
+    static void int32ToFloat(const int32_t* in, float* out, size_t count)
+    {
+        const float inverse = float(1. / INT32_SCALE);
+        size_t i = 0;
+    #if defined(DX_CONVERSION_AVX2)
+        const __m256 scale = _mm256_set1_ps(inverse);
+        for(; i + 8 <= count; i += 8)
+        {
+            const __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(samples), scale));
+        }
+    #elif defined(DX_CONVERSION_SSE2)
+        const __m128 scale = _mm_set1_ps(inverse);
+        for(; i + 4 <= count; i += 4)
+        {
+            const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(samples), scale));
+        }
+    #endif
+        for(; i < count; ++i)
+            out[i] = float(in[i]) * inverse;
+    }
+
+    static void floatToInt32(const float* in, int32_t* out, size_t count)
+    {
+        // Floats only carry 24 bits, there's nothing for dither to do here
+        const float scale = float(INT32_SCALE);
+        size_t i = 0;
+    #if defined(DX_CONVERSION_AVX2)
+        const __m256 scaleVector = _mm256_set1_ps(scale);
+        const __m256 low = _mm256_set1_ps(-scale);
+        const __m256 high = _mm256_set1_ps(INT32_MAX_FLOAT);
+        for(; i + 8 <= count; i += 8)
+        {
+            const __m256 value = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), scaleVector), low), high);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_cvtps_epi32(value));
+        }
+    #elif defined(DX_CONVERSION_SSE2)
+        const __m128 scaleVector = _mm_set1_ps(scale);
+        const __m128 low = _mm_set1_ps(-scale);
+        const __m128 high = _mm_set1_ps(INT32_MAX_FLOAT);
+        for(; i + 4 <= count; i += 4)
+        {
+            // Unlike packs, cvtps doesn't saturate - clamp first so overflow clips instead of flipping sign
+            const __m128 value = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scaleVector), low), high);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_cvtps_epi32(value));
+        }
+    #endif
+        for(; i < count; ++i)
+            out[i] = int32_t(roundToInt(clampFloat(in[i] * scale, -scale, INT32_MAX_FLOAT)));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // PCM_INT24 <-> FLOAT32
+
+    static void int24ToFloat(const Int24* in, float* out, size_t count)
+    {
+        for(size_t i = 0; i < count; ++i)
+            out[i] = float(int32_t(in[i])) * (1.f / INT24_SCALE);
+    }
+
+    static void floatToInt24(const float* in, Int24* out, size_t count, DitherMode dither)
+    {
+        uint32_t state = nextDitherSeed();
+        for(size_t i = 0; i < count; ++i)
+        {
+            float value = in[i] * INT24_SCALE;
+            if(dither == TPDF_DITHER)
+                value += tpdf(state);
+            out[i] = roundToInt(clampFloat(value, -INT24_SCALE, INT24_SCALE - 1.f));
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // FLOAT64 <-> FLOAT32
+
+    static void doubleToFloat(const double* in, float* out, size_t count)
+    {
+        for(size_t i = 0; i < count; ++i)
+            out[i] = float(in[i]);
+    }
+
+    static void floatToDouble(const float* in, double* out, size_t count)
+    {
+        for(size_t i = 0; i < count; ++i)
+            out[i] = double(in[i]);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Everything <-> FLOAT64, for the pairs float would lose bits on
+
+    static void toDouble(const void* in, SampleEncoding encoding, double* out, size_t count)
+    {
+        switch(encoding)
+        {
+        case PCM_INT16:
+            for(size_t i = 0; i < count; ++i)
+                out[i] = double(static_cast<const int16_t*>(in)[i]) * (1. / INT16_SCALE);
+            break;
+        case PCM_INT24:
+            for(size_t i = 0; i < count; ++i)
+                out[i] = double(int32_t(static_cast<const Int24*>(in)[i])) * (1. / INT24_SCALE);
+            break;
+        case PCM_INT32:
+            for(size_t i = 0; i < count; ++i)
+                out[i] = double(static_cast<const int32_t*>(in)[i]) * (1. / INT32_SCALE);
+            break;
+        case FLOAT32:
+            floatToDouble(static_cast<const float*>(in), out, count);
+            break;
+        case FLOAT64:
+            std::memcpy(out, in, count * sizeof(double));
+            break;
+        default:
+            break;
+        }
+    }
+
+    static void fromDouble(const double* in, void* out, SampleEncoding encoding, size_t count, DitherMode dither, uint32_t& state)
+    {
+        switch(encoding)
+        {
+        case PCM_INT16:
+            for(size_t i = 0; i < count; ++i)
+            {
+                double value = in[i] * INT16_SCALE;
+                if(dither == TPDF_DITHER)
+                    value += tpdf(state);
+                static_cast<int16_t*>(out)[i] = int16_t(roundToInt(clampDouble(value, -INT16_SCALE, INT16_SCALE - 1.)));
+            }
+            break;
+        case PCM_INT24:
+            for(size_t i = 0; i < count; ++i)
+            {
+                double value = in[i] * INT24_SCALE;
+                if(dither == TPDF_DITHER)
+                    value += tpdf(state);
+                static_cast<Int24*>(out)[i] = int32_t(roundToInt(clampDouble(value, -INT24_SCALE, INT24_SCALE - 1.)));
+            }
+            break;
+        case PCM_INT32:
+            for(size_t i = 0; i < count; ++i)
+                static_cast<int32_t*>(out)[i] = int32_t(roundToInt(clampDouble(in[i] * INT32_SCALE, -INT32_SCALE, INT32_SCALE - 1.)));
+            break;
+        case FLOAT32:
+            doubleToFloat(in, static_cast<float*>(out), count);
+            break;
+        case FLOAT64:
+            std::memcpy(out, in, count * sizeof(double));
+            break;
+        default:
+            break;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Dispatch
+
+    static void fromFloat(const float* in, void* out, SampleEncoding encoding, size_t count, DitherMode dither)
+    {
+        switch(encoding)
+        {
+        case PCM_INT16:
+            floatToInt16(in, static_cast<int16_t*>(out), count, dither);
+            break;
+        case PCM_INT24:
+            floatToInt24(in, static_cast<Int24*>(out), count, dither);
+            break;
+        case PCM_INT32:
+            floatToInt32(in, static_cast<int32_t*>(out), count);
+            break;
+        case FLOAT64:
+            floatToDouble(in, static_cast<double*>(out), count);
+            break;
+        default:
+            break;
+        }
+    }
+
+    static void toFloat(const void* in, SampleEncoding encoding, float* out, size_t count)
+    {
+        switch(encoding)
+        {
+        case PCM_INT16:
+            int16ToFloat(static_cast<const int16_t*>(in), out, count);
+            break;
+        case PCM_INT24:
+            int24ToFloat(static_cast<const Int24*>(in), out, count);
+            break;
+        case PCM_INT32:
+            int32ToFloat(static_cast<const int32_t*>(in), out, count);
+            break;
+        case FLOAT64:
+            doubleToFloat(static_cast<const double*>(in), out, count);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Dither only makes sense when we're actually throwing bits away
+    static DitherMode effectiveDither(SampleEncoding inEncoding, SampleEncoding outEncoding, DitherMode dither)
+    {
+        if(outEncoding == PCM_INT16)
+            return inEncoding != PCM_INT16 ? dither : NO_DITHER;
+        if(outEncoding == PCM_INT24)
+            return (inEncoding != PCM_INT16 && inEncoding != PCM_INT24) ? dither : NO_DITHER;
+        return NO_DITHER;
+    }
+
+    bool convert(const void* in, SampleEncoding inEncoding, void* out, SampleEncoding outEncoding,
+        size_t count, DitherMode dither)
+    {
+        const size_t inBytes = bytesPerSample(inEncoding);
+        const size_t outBytes = bytesPerSample(outEncoding);
+        if(inBytes == 0 || outBytes == 0)
+            return false;
+        if(count == 0)
+            return true;
+
+        if(inEncoding == outEncoding)
+        {
+            if(in != out)
+                std::memcpy(out, in, count * inBytes);
+            return true;
+        }
+
+        dither = effectiveDither(inEncoding, outEncoding, dither);
+
+        if(inEncoding == FLOAT32)
+        {
+            fromFloat(static_cast<const float*>(in), out, outEncoding, count, dither);
+            return true;
+        }
+
+        if(outEncoding == FLOAT32)
+        {
+            toFloat(in, inEncoding, static_cast<float*>(out), count);
+            return true;
+        }
+
+        // No float on either side - go through double so that no bits are lost along the way
+        double buffer[CHUNK_SIZE];
+        uint32_t state = nextDitherSeed();
+        const AudioByte* source = static_cast<const AudioByte*>(in);
+        AudioByte* destination = static_cast<AudioByte*>(out);
+        for(size_t done = 0; done < count; done += CHUNK_SIZE)
+        {
+            const size_t chunk = (count - done < CHUNK_SIZE ? count - done : CHUNK_SIZE);
+            toDouble(source + done * inBytes, inEncoding, buffer, chunk);
+            fromDouble(buffer, destination + done * outBytes, outEncoding, chunk, dither, state);
+        }
+        return true;
+    }
+
+    bool convert(const AudioPacket& in, AudioPacket& out, DitherMode dither)
+    {
+        const AudioFormat inFormat = in.getAudioFormat();
+        const AudioFormat outFormat = out.getAudioFormat();
+        if(inFormat.channels != outFormat.channels || inFormat.samplesPerSecond != outFormat.samplesPerSecond
+            || inFormat.layout != outFormat.layout)
+            return false;
+
+        const SampleEncoding inEncoding = encodingOf(inFormat);
+        const SampleEncoding outEncoding = encodingOf(outFormat);
+        const size_t inBytes = bytesPerSample(inEncoding);
+        const size_t outBytes = bytesPerSample(outEncoding);
+        if(inBytes == 0 || outBytes == 0)
+            return false;
+
+        const size_t count = in.byteSize() / inBytes;
+        if(out.byteSize() < count * outBytes)
+            return false;
+        // A planar packet's channels start wherever its frame count says, so the sizes have to agree
+        if(inFormat.layout == PLANAR && out.byteSize() != count * outBytes)
+            return false;
+
+        out.setTimestamp(in.getTimestamp());
+        return convert(in.data(), inEncoding, out.data(), outEncoding, count, dither);
+    }
+
+    const char* kernelName()
+    {
+    #if defined(DX_CONVERSION_AVX2)
+        return "AVX2";
+    #elif defined(DX_CONVERSION_SSE2)
+        return "SSE2";
+    #else
+        return "generic";
+    #endif
+    }
+
+}
+}
+}
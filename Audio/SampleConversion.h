@@ -0,0 +1,87 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX Audio - SampleConversion converts samples between SampleEncodings, SIMD accelerated
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "AudioFormat.h"
+
+#include <cstddef>
+
+namespace DX {
+namespace Audio {
+
+    class AudioPacket;
+
+namespace SampleConversion {
+
+    /*! \brief SampleConversion moves samples from one SampleEncoding to another - the WASAPI float
+        mix format to 16-bit PCM for an encoder, 24-bit capture to float for filtering, and so on.
+
+        Integer samples map onto [-1, 1) floats by dividing by 2^(bits - 1). Going the other way,
+        floats are scaled, rounded to nearest and saturated, so out of range input clips instead of
+        wrapping.
+
+        The conversions to and from FLOAT32 for PCM_INT16 and PCM_INT32 are vectorized, with SSE2
+        kernels and AVX2 ones when built with /arch:AVX2 (__AVX2__). Every other pair is handled
+        by plain loops, through float or (where float would lose bits) double. Builds without SSE2
+        fall back to the plain loops everywhere.
+
+        Down-conversions to PCM_INT16 and PCM_INT24 can add TPDF dither: triangular noise, one least
+        significant bit either way, which trades the distortion of plain rounding for a constant
+        noise floor.
+    */
+
+    enum DitherMode
+    {
+        NO_DITHER   = 0,
+        TPDF_DITHER = 1
+    };
+
+    /*! Converts count samples from in to out.
+
+        \param[in] count    The number of individual samples, which is frames * channels for
+                            interleaved audio
+        \return False if either encoding is UNKNOWN_ENCODING
+
+        \note in and out must not overlap, unless they are the same pointer and encoding.
+    */
+    bool        convert(const void* in, SampleEncoding inEncoding, void* out, SampleEncoding outEncoding,
+                    size_t count, DitherMode dither = NO_DITHER);
+
+    /*! Converts every sample of in into out, using the encoding of each packet's AudioFormat (see
+        encodingOf()). out takes in's AudioTimestamp.
+
+        \return False if the packets differ in channels, sample rate or layout, an encoding is unknown,
+        or out is too small to hold the converted samples (or, for PLANAR packets, isn't exactly the
+        right size)
+    */
+    bool        convert(const AudioPacket& in, AudioPacket& out, DitherMode dither = NO_DITHER);
+
+    /*! \return The name of the widest kernel set compiled in: "AVX2", "SSE2" or "generic" */
+    const char* kernelName();
+
+}
+}
+}
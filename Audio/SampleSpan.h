@@ -0,0 +1,344 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX Audio - A high-level audio library designed for interacting easily with hardware devices
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX Audio - SampleSpan gives typed, strided access to the samples held by an AudioPacket
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "AudioFormat.h"
+#include "AudioPacket.h"
+
+#include <assert.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace DX {
+namespace Audio {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Int24
+
+    /*! \brief Int24 is a packed, 3 byte, little-endian signed sample - the in-memory layout of 24-bit
+        PCM. It has no alignment requirements, so an array of Int24 lines up exactly with the
+        AudioBytes of a 24-bit AudioPacket.
+    */
+    struct Int24
+    {
+        AudioByte bytes[3];
+
+        /*! Sign-extends the packed sample into a full int32_t */
+        operator int32_t() const
+        {
+            return static_cast<int32_t>((uint32_t(bytes[0]) << 8) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 24)) >> 8;
+        }
+
+        /*! Stores the low 24 bits of value, which is expected to already be in 24-bit range */
+        Int24& operator=(int32_t value)
+        {
+            bytes[0] = static_cast<AudioByte>(value);
+            bytes[1] = static_cast<AudioByte>(value >> 8);
+            bytes[2] = static_cast<AudioByte>(value >> 16);
+            return *this;
+        }
+    };
+
+    static_assert(sizeof(Int24) == 3, "Int24 must be packed to exactly 3 bytes");
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // SampleSpan
+
+    /*! \brief SampleSpan is a non-owning, typed view over a block of samples - int16_t, Int24, int32_t,
+        float, ... - laid out as frames of channels. It is the replacement for walking an AudioPacket one
+        AudioSample at a time: no formats get copied, nothing throws, and the hot loops are plain
+        pointer arithmetic the compiler can vectorize.
+
+        Where sample (frame, channel) lives is described by two strides, measured in samples:
+            data[frame * frameStride() + channel * channelStride()]
+        Interleaved audio (the layout devices hand us) has frameStride == channels and
+        channelStride == 1, planar audio has frameStride == 1 and channelStride == frames. channel()
+        narrows a span to a single channel by keeping the strides, so per-channel processing needs no
+        copies either - and on a planar span, each channel is itself contiguous.
+
+        When isContiguous() is true, begin() / end() cover every sample exactly once, which is the
+        fastest way to run an operation that doesn't care about channels.
+
+        Like AudioSample, a SampleSpan must not outlive the memory it looks at.
+
+        \code
+        void applyGain(AudioPacket& packet, float gain)
+        {
+            SampleSpan<float> samples = makeSampleSpan<float>(packet);
+            for(float* it = samples.begin(); it != samples.end(); ++it)
+                *it *= gain;
+        }
+
+        void swapChannels(AudioPacket& packet)
+        {
+            SampleSpan<int16_t> samples = makeSampleSpan<int16_t>(packet);
+            for(size_t frame = 0; frame < samples.numFrames(); ++frame)
+                std::swap(samples(frame, 0), samples(frame, 1));
+        }
+        \endcode
+    */
+    template <typename T>
+    class SampleSpan
+    {
+    public:
+        typedef T           value_type;
+        typedef T*          iterator;
+
+        SampleSpan(); /*!< Constructs an empty span */
+        /*! Constructs a span over interleaved samples */
+        SampleSpan(T* data, size_t numFrames, size_t numChannels);
+        /*! Constructs a span with explicit strides, in samples */
+        SampleSpan(T* data, size_t numFrames, size_t numChannels, size_t frameStride, size_t channelStride);
+
+        /*! Lets a SampleSpan<T> be passed wherever a SampleSpan<const T> is expected */
+        operator SampleSpan<const T>() const;
+
+        T&          operator()(size_t frame, size_t channel) const; /*!< Unchecked in release builds */
+        T*          frame(size_t frame) const; /*!< Pointer to the first sample of frame */
+        SampleSpan  channel(size_t channel) const; /*!< Single-channel span, sharing our strides */
+        SampleSpan  frames(size_t firstFrame, size_t numFrames) const; /*!< Span over a range of frames, clamped */
+
+        size_t      numFrames() const;
+        size_t      numChannels() const;
+        size_t      frameStride() const;
+        size_t      channelStride() const;
+        size_t      size() const; /*!< numFrames() * numChannels() */
+        bool        empty() const;
+        /*! \return True if every sample sits back to back with no gaps, in which case begin() / end()
+            cover the whole span
+        */
+        bool        isContiguous() const;
+
+        T*          data() const;
+        iterator    begin() const; /*!< Only meaningful when isContiguous() */
+        iterator    end() const; /*!< Only meaningful when isContiguous() */
+
+    private:
+        T*          m_data;
+        size_t      m_numFrames;
+        size_t      m_numChannels;
+        size_t      m_frameStride;
+        size_t      m_channelStride;
+    };
+
+    /*! Creates a SampleSpan over every frame of packet, with strides to match its SampleLayout.
+
+        \note Asserts that T matches the packet's sample size. Make sure to pick the right T for the
+        packet's AudioFormat - the bits alone can't tell int32_t from float.
+    */
+    template <typename T>
+    SampleSpan<T>       makeSampleSpan(AudioPacket& packet);
+    /*! Read-only version of makeSampleSpan() */
+    template <typename T>
+    SampleSpan<const T> makeSampleSpan(const AudioPacket& packet);
+
+    /*! Copies every sample of from into to, whatever the strides of either. Does nothing if they're
+        already the same samples.
+        \return False if from and to differ in frames or channels
+    */
+    template <typename T>
+    bool                copySamples(const SampleSpan<const T>& from, const SampleSpan<T>& to);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // SampleSpan impl
+
+    template <typename T>
+    SampleSpan<T>::SampleSpan() : m_data(nullptr), m_numFrames(0), m_numChannels(0), m_frameStride(0), m_channelStride(0)
+    {
+    }
+
+    template <typename T>
+    SampleSpan<T>::SampleSpan(T* data, size_t numFrames, size_t numChannels)
+        : m_data(data), m_numFrames(numFrames), m_numChannels(numChannels), m_frameStride(numChannels), m_channelStride(1)
+    {
+    }
+
+    template <typename T>
+    SampleSpan<T>::SampleSpan(T* data, size_t numFrames, size_t numChannels, size_t frameStride, size_t channelStride)
+        : m_data(data), m_numFrames(numFrames), m_numChannels(numChannels), m_frameStride(frameStride), m_channelStride(channelStride)
+    {
+    }
+
+    template <typename T>
+    SampleSpan<T>::operator SampleSpan<const T>() const
+    {
+        return SampleSpan<const T>(m_data, m_numFrames, m_numChannels, m_frameStride, m_channelStride);
+    }
+
+    template <typename T>
+    T& SampleSpan<T>::operator()(size_t frame, size_t channel) const
+    {
+        assert(frame < m_numFrames);
+        assert(channel < m_numChannels);
+        return m_data[frame * m_frameStride + channel * m_channelStride];
+    }
+
+    template <typename T>
+    T* SampleSpan<T>::frame(size_t frame) const
+    {
+        assert(frame < m_numFrames);
+        return m_data + frame * m_frameStride;
+    }
+
+    template <typename T>
+    SampleSpan<T> SampleSpan<T>::channel(size_t channel) const
+    {
+        assert(channel < m_numChannels);
+        return SampleSpan<T>(m_data + channel * m_channelStride, m_numFrames, 1, m_frameStride, m_channelStride);
+    }
+
+    template <typename T>
+    SampleSpan<T> SampleSpan<T>::frames(size_t firstFrame, size_t numFrames) const
+    {
+        if(firstFrame > m_numFrames)
+            firstFrame = m_numFrames;
+        if(numFrames > m_numFrames - firstFrame)
+            numFrames = m_numFrames - firstFrame;
+        return SampleSpan<T>(m_data + firstFrame * m_frameStride, numFrames, m_numChannels, m_frameStride, m_channelStride);
+    }
+
+    template <typename T>
+    size_t SampleSpan<T>::numFrames() const
+    {
+        return m_numFrames;
+    }
+
+    template <typename T>
+    size_t SampleSpan<T>::numChannels() const
+    {
+        return m_numChannels;
+    }
+
+    template <typename T>
+    size_t SampleSpan<T>::frameStride() const
+    {
+        return m_frameStride;
+    }
+
+    template <typename T>
+    size_t SampleSpan<T>::channelStride() const
+    {
+        return m_channelStride;
+    }
+
+    template <typename T>
+    size_t SampleSpan<T>::size() const
+    {
+        return m_numFrames * m_numChannels;
+    }
+
+    template <typename T>
+    bool SampleSpan<T>::empty() const
+    {
+        return size() == 0;
+    }
+
+    template <typename T>
+    bool SampleSpan<T>::isContiguous() const
+    {
+        // Interleaved with no gaps between frames, planar with no gaps between channels, or a single run
+        return (m_channelStride == 1 && m_frameStride == m_numChannels)
+            || (m_frameStride == 1 && m_channelStride == m_numFrames)
+            || (m_numFrames <= 1 && m_channelStride == 1)
+            || (m_numChannels == 1 && m_frameStride == 1);
+    }
+
+    template <typename T>
+    T* SampleSpan<T>::data() const
+    {
+        return m_data;
+    }
+
+    template <typename T>
+    typename SampleSpan<T>::iterator SampleSpan<T>::begin() const
+    {
+        assert(isContiguous());
+        return m_data;
+    }
+
+    template <typename T>
+    typename SampleSpan<T>::iterator SampleSpan<T>::end() const
+    {
+        assert(isContiguous());
+        return m_data + size();
+    }
+
+    template <typename T>
+    SampleSpan<T> makeSampleSpan(AudioPacket& packet)
+    {
+        const AudioFormat format = packet.getAudioFormat();
+        assert(format.channels > 0);
+        assert(sizeof(T) * format.channels == format.bitsPerBlock);
+        const size_t numFrames = (format.bitsPerBlock > 0 ? packet.byteSize() / format.bitsPerBlock : 0);
+        if(format.layout == PLANAR)
+            return SampleSpan<T>(reinterpret_cast<T*>(packet.data()), numFrames, format.channels, 1, numFrames);
+        return SampleSpan<T>(reinterpret_cast<T*>(packet.data()), numFrames, format.channels);
+    }
+
+    template <typename T>
+    SampleSpan<const T> makeSampleSpan(const AudioPacket& packet)
+    {
+        const AudioFormat format = packet.getAudioFormat();
+        assert(format.channels > 0);
+        assert(sizeof(T) * format.channels == format.bitsPerBlock);
+        const size_t numFrames = (format.bitsPerBlock > 0 ? packet.byteSize() / format.bitsPerBlock : 0);
+        if(format.layout == PLANAR)
+            return SampleSpan<const T>(reinterpret_cast<const T*>(packet.data()), numFrames, format.channels, 1, numFrames);
+        return SampleSpan<const T>(reinterpret_cast<const T*>(packet.data()), numFrames, format.channels);
+    }
+
+    template <typename T>
+    bool copySamples(const SampleSpan<const T>& from, const SampleSpan<T>& to)
+    {
+        if(from.numFrames() != to.numFrames() || from.numChannels() != to.numChannels())
+            return false;
+
+        if(from.frameStride() == to.frameStride() && from.channelStride() == to.channelStride())
+        {
+            if(from.data() == to.data())
+                return true;
+            if(from.isContiguous())
+            {
+                std::memcpy(to.data(), from.data(), from.size() * sizeof(T));
+                return true;
+            }
+        }
+
+        for(size_t frame = 0; frame < from.numFrames(); ++frame)
+        {
+            for(size_t channel = 0; channel < from.numChannels(); ++channel)
+                to(frame, channel) = from(frame, channel);
+        }
+        return true;
+    }
+
+}
+}
@@ -23,6 +23,8 @@
 
 #include <atlbase.h>
 #include <functiondiscoverykeys_devpkey.h>
+#include <mmreg.h>
+#include <ksmedia.h>
 
 #endif
 
@@ -31,13 +33,40 @@ namespace Audio {
 
 #ifdef WIN32
 
+    // Works out what's actually in the samples, which for extensible formats lives in the SubFormat
+    static SampleEncoding encodingOfWaveFormat(const WAVEFORMATEX* waveFormat)
+    {
+        bool isFloat = (waveFormat->wFormatTag == WAVE_FORMAT_IEEE_FLOAT);
+        if(waveFormat->wFormatTag == WAVE_FORMAT_EXTENSIBLE && waveFormat->cbSize >= 22)
+        {
+            const WAVEFORMATEXTENSIBLE* extensible = reinterpret_cast<const WAVEFORMATEXTENSIBLE*>(waveFormat);
+            isFloat = (extensible->SubFormat == KSDATAFORMAT_SUBTYPE_IEEE_FLOAT);
+        }
+
+        switch(waveFormat->wBitsPerSample)
+        {
+        case 16:
+            return PCM_INT16;
+        case 24:
+            return PCM_INT24;
+        case 32:
+            return isFloat ? FLOAT32 : PCM_INT32;
+        case 64:
+            return isFloat ? FLOAT64 : UNKNOWN_ENCODING;
+        default:
+            return UNKNOWN_ENCODING;
+        }
+    }
+
     AbstractAudioDeviceImpl::AbstractAudioDeviceImpl() 
-        : m_initialized(false), m_started(false), m_mmDevice(nullptr), m_client(nullptr)
+        : m_initialized(false), m_started(false), m_mmDevice(nullptr), m_client(nullptr),
+        m_packetPool(AudioPacketPool::create())
     {
     }
 
     AbstractAudioDeviceImpl::AbstractAudioDeviceImpl(IMMDevice *device, int deviceMode)
-        : m_mmDevice(device), m_client(nullptr), m_initialized(false), m_started(false), m_deviceMode(deviceMode)
+        : m_mmDevice(device), m_client(nullptr), m_initialized(false), m_started(false), m_deviceMode(deviceMode),
+        m_packetPool(AudioPacketPool::create())
     {
     }
 
@@ -113,6 +142,8 @@ namespace Audio {
         m_audioFormat.samplesPerSecond	= waveFormat->nSamplesPerSec;
         m_audioFormat.bitsPerBlock		= waveFormat->nBlockAlign;
         m_audioFormat.bitsPerSample		= waveFormat->wBitsPerSample;
+        m_audioFormat.encoding			= encodingOfWaveFormat(waveFormat);
+        m_audioFormat.layout			= INTERLEAVED;
 
         // Try to intialize our audio client
         ok = m_client->Initialize(AUDCLNT_SHAREMODE_SHARED, m_deviceMode, 
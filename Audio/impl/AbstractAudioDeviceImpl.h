@@ -21,6 +21,7 @@
 
 #include "../AbstractAudioDevice.h"
 #include "../AudioFormat.h"
+#include "../AudioPacketPool.h"
 #include "../Tasks/TaskCallback.h"
 #include "../AudioStream.h"
 
@@ -65,6 +66,7 @@ namespace Audio {
         virtual AudioPacket readFromBuffer() = 0;
         virtual bool        readFromBuffer(AudioStream& out, TaskCallback* callback = nullptr) = 0;
         virtual bool        writeToBuffer(const AudioPacket& in, const AbstractFilter& filter) = 0;
+        virtual bool        writeToBuffer(const AudioPacket& in, FilterProcessor& processor) = 0;
         virtual bool        writeToBuffer(AudioStream& in, const AbstractFilter& filter, TaskCallback* callback) = 0;
 
         virtual bool        isValid() const;
@@ -75,6 +77,8 @@ namespace Audio {
         IAudioClient*       m_client;
 
         AudioFormat         m_audioFormat;
+        // Every packet the device produces comes from here, so steady-state streaming doesn't allocate
+        std::shared_ptr<AudioPacketPool>    m_packetPool;
 
         long long           m_referenceTime;
 
@@ -18,8 +18,11 @@
 */ /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "AudioCaptureDeviceImpl.h"
+#include "../AllocationAudit.h"
 #include "../AudioPacket.h"
+#include "../LatencyTrace.h"
 
+#include <cstring>
 #include <thread>
 
 namespace DX {
@@ -65,11 +68,46 @@ namespace Audio {
         return false;
     }
 
+    bool AudioCaptureDeviceImpl::writeToBuffer(const AudioPacket&, FilterProcessor&)
+    {
+        return false;
+    }
+
     bool AudioCaptureDeviceImpl::writeToBuffer(AudioStream&, const AbstractFilter&, TaskCallback*)
     {
         return false;
     }
 
+    AudioPacket AudioCaptureDeviceImpl::capturePacket(const AudioByte* data, unsigned int numFrames,
+        DWORD bufferFlags, UINT64 devicePosition, UINT64 qpcPosition)
+    {
+        const size_t numBytes = numFrames * m_audioFormat.bitsPerBlock;
+        AudioPacket packet = m_packetPool->acquire(m_audioFormat, numBytes);
+
+        AudioTimestamp timestamp;
+        timestamp.devicePosition = devicePosition;
+        timestamp.captureTime = qpcPosition;
+        timestamp.flags = TIMESTAMP_VALID;
+        if(bufferFlags & AUDCLNT_BUFFERFLAGS_DATA_DISCONTINUITY)
+            timestamp.flags |= DISCONTINUITY;
+        if(bufferFlags & AUDCLNT_BUFFERFLAGS_TIMESTAMP_ERROR)
+            timestamp.flags |= TIMESTAMP_ERROR;
+
+        // Whatever is in the buffer is meant to be ignored when it's flagged silent
+        if(bufferFlags & AUDCLNT_BUFFERFLAGS_SILENT)
+        {
+            timestamp.flags |= SILENT;
+            std::memset(packet.data(), 0, numBytes);
+        }
+        else
+        {
+            packet.assign(data, numBytes);
+        }
+
+        packet.setTimestamp(timestamp);
+        return packet;
+    }
+
     AudioPacket AudioCaptureDeviceImpl::readFromBuffer()
     {
         if(!isStarted())
@@ -98,7 +136,9 @@ namespace Audio {
 
         AudioByte* data = nullptr;        
         unsigned long returnFlags = 0;
-        ok = m_captureClient->GetBuffer(&data, &numFramesToRead, &returnFlags, nullptr, nullptr);
+        UINT64 devicePosition = 0;
+        UINT64 qpcPosition = 0;
+        ok = m_captureClient->GetBuffer(&data, &numFramesToRead, &returnFlags, &devicePosition, &qpcPosition);
         if(ok < 0)
         {
             // Something bad happened when we tried to grab the buffer
@@ -108,12 +148,7 @@ namespace Audio {
             return BAD_BUFFER;
         }
 
-        // TODO: Some logic / error handling based off of flag return values. Skipping that for now.
-        const size_t numBytesToWrite = numFramesToRead * m_audioFormat.bitsPerBlock;
-        AudioPacket ret(m_audioFormat, numBytesToWrite);
-
-        // TODO: Think about adding some kind of bulk-inserter?
-        ret.assign(data, numBytesToWrite);
+        AudioPacket ret = capturePacket(data, numFramesToRead, returnFlags, devicePosition, qpcPosition);
 
         ok = m_captureClient->ReleaseBuffer(numFramesToRead);
         if(ok < 0)
@@ -140,8 +175,12 @@ namespace Audio {
         bool continueReading = true;
         const size_t maxPacketsFallback = 100000;
         size_t packetsRead = 0;
+        size_t periods = 0;
         while(continueReading)
         {
+            // Once the pool and stream have warmed up, nothing below should touch the heap
+            AllocationAudit::RealtimeScope realtime(periods >= DEFAULT_AUDIT_WARMUP);
+
             // See if there's any data we can get
             //d::this_thread::sleep_for(std::chrono::microseconds(m_referenceTime));
             unsigned int numFramesToRead = 0;
@@ -162,7 +201,9 @@ namespace Audio {
             AudioByte* data = nullptr;      
             numFramesToRead = 0;
             unsigned long returnFlags = 0;
-            ok = m_captureClient->GetBuffer(&data, &numFramesToRead, &returnFlags, 0, 0);
+            UINT64 devicePosition = 0;
+            UINT64 qpcPosition = 0;
+            ok = m_captureClient->GetBuffer(&data, &numFramesToRead, &returnFlags, &devicePosition, &qpcPosition);
             if(ok < 0 || data == nullptr)
             {
                 // Something bad happened when we tried to grab the buffer
@@ -180,12 +221,10 @@ namespace Audio {
                 continue;
             }
 
-            // TODO: Some logic / error handling based off of flag return values. Skipping that for now.
-            const size_t bytesToCopy = numFramesToRead * m_audioFormat.bitsPerBlock;
-            AudioPacket ret(m_audioFormat, bytesToCopy);
-
-            ret.assign(data, bytesToCopy);
-            out.push(std::move(ret));
+            AudioPacket packet = capturePacket(data, numFramesToRead, returnFlags, devicePosition, qpcPosition);
+            LatencyTrace::enqueued(packet);
+            out.push(std::move(packet));
+            ++periods;
 
             ok = m_captureClient->ReleaseBuffer(numFramesToRead);
             if(ok < 0)
@@ -42,9 +42,16 @@ namespace Audio {
         virtual AudioPacket readFromBuffer();
         virtual bool        readFromBuffer(AudioStream& out, TaskCallback* callback);
         virtual bool        writeToBuffer(const AudioPacket& in, const AbstractFilter& filter);
+        virtual bool        writeToBuffer(const AudioPacket& in, FilterProcessor& processor);
         virtual bool        writeToBuffer(AudioStream& in, const AbstractFilter& filter, TaskCallback* callback);
 
     protected:
+        /*! Copies numFrames frames of a captured buffer into a pooled AudioPacket, stamped with
+            where and when the device says they were captured
+        */
+        AudioPacket         capturePacket(const AudioByte* data, unsigned int numFrames, DWORD bufferFlags,
+                                UINT64 devicePosition, UINT64 qpcPosition);
+
         IAudioCaptureClient *m_captureClient;
     };
 
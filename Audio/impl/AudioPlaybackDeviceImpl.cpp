@@ -18,8 +18,13 @@
 */ /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "AudioPlaybackDeviceImpl.h"
+#include "../AllocationAudit.h"
 #include "../AudioPacket.h"
+#include "../Interleaving.h"
+#include "../LatencyTrace.h"
+#include "../SampleSpan.h"
 #include "../Filters/AbstractFilter.h"
+#include "../Filters/FilterProcessor.h"
 
 #include <thread>
 
@@ -61,6 +66,80 @@ namespace Audio {
         return true;
 	}
 
+    bool AudioPlaybackDeviceImpl::runFilter(FilterProcessor& processor, const AudioPacket& in, AudioPacket& out)
+    {
+        const uint64_t filterStart = LatencyTrace::now();
+        if(filtersInPlace(processor, in.getAudioFormat()))
+        {
+            // Same format in as out, so straight across with nothing to acquire or convert
+            out.resize(in.byteSize());
+            if(!processor.processInto(makeSampleSpan<float>(in), makeSampleSpan<float>(out)))
+                return false;
+            out.setTimestamp(in.getTimestamp());
+            LatencyTrace::filtered(in, filterStart, out);
+            return true;
+        }
+
+        const SampleLayout layout = processor.preferredLayout();
+
+        const AudioPacket* source = &in;
+        AudioPacket converted;
+        if(in.getAudioFormat().layout != layout)
+        {
+            AudioFormat convertedFormat = in.getAudioFormat();
+            convertedFormat.layout = layout;
+            converted = m_packetPool->acquire(convertedFormat, in.byteSize());
+            if(!Interleaving::convertLayout(in, converted))
+                return false;
+            source = &converted;
+        }
+
+        if(out.getAudioFormat().layout == layout)
+        {
+            if(!processor.process(*source, out))
+                return false;
+        }
+        else
+        {
+            AudioFormat filteredFormat = out.getAudioFormat();
+            filteredFormat.layout = layout;
+            AudioPacket filtered = m_packetPool->acquire(filteredFormat, out.byteSize());
+            if(!processor.process(*source, filtered))
+                return false;
+            // Resamplers decide for themselves how many frames come out
+            out.resize(filtered.byteSize());
+            if(!Interleaving::convertLayout(filtered, out))
+                return false;
+        }
+
+        /*
+            Filters that produce fewer frames than out was sized for shrink it to say so, and only
+            what they produced goes on to the device - never the stale tail of a pooled buffer
+        */
+        const size_t bytesPerFrame = out.getAudioFormat().bitsPerBlock;
+        if(bytesPerFrame > 0)
+            out.resize(out.byteSize() / bytesPerFrame * bytesPerFrame);
+
+        // Filters only see samples, so the timestamp is carried across for them
+        out.setTimestamp(in.getTimestamp());
+        LatencyTrace::filtered(in, filterStart, out);
+        return true;
+    }
+
+    bool AudioPlaybackDeviceImpl::runFilterInPlace(FilterProcessor& processor, AudioPacket& packet)
+    {
+        const uint64_t filterStart = LatencyTrace::now();
+        if(!processor.processInPlace(makeSampleSpan<float>(packet)))
+            return false;
+        LatencyTrace::filtered(packet, filterStart, packet);
+        return true;
+    }
+
+    bool AudioPlaybackDeviceImpl::filtersInPlace(const FilterProcessor& processor, const AudioFormat& format) const
+    {
+        return processor.supportsInPlace() && format == m_audioFormat && encodingOf(format) == FLOAT32;
+    }
+
     AudioPacket AudioPlaybackDeviceImpl::readFromBuffer() 
     {
         return BAD_BUFFER;
@@ -72,6 +151,13 @@ namespace Audio {
     }
 
     bool AudioPlaybackDeviceImpl::writeToBuffer(const AudioPacket& in, const AbstractFilter& filter)
+    {
+        // Nothing outlives the call, so a filter destroyed after it can't leave state behind for the next
+        const std::shared_ptr<FilterProcessor> processor = filter.createProcessor();
+        return (processor && writeToBuffer(in, *processor));
+    }
+
+    bool AudioPlaybackDeviceImpl::writeToBuffer(const AudioPacket& in, FilterProcessor& processor)
     {
         if(!isStarted())
         {
@@ -95,58 +181,21 @@ namespace Audio {
             return false;
         }
 
-        AudioByte *data = nullptr;
-        unsigned int sizeOfBuffer = 0;
-        int ok = m_client->GetBufferSize(&sizeOfBuffer);
-        if(ok < 0)
-        {
-            // Something went wrong with getting the buffer size (...how?)
-            return false;
-        }
-
-        unsigned int bytesPadded = 0;
-        ok = m_client->GetCurrentPadding(&bytesPadded);
-        if(ok < 0)
+        if(m_chain.isFull())
         {
-            // Something went wrong with getting the amount ofpadding (...how?)
-            return false;
-        }
-
-        if(bytesPadded > sizeOfBuffer)
-        {
-            // Woops, we've been writing too much!
-            return false;
-        }
-
-        sizeOfBuffer -= bytesPadded;
-        ok = m_playbackClient->GetBuffer(sizeOfBuffer, &data);
-        if(ok < 0)
-        {
-            // Something went wrong with grabbing a pointer to the buffer. That's no good.
-            m_playbackClient->ReleaseBuffer(sizeOfBuffer, 0); // Should we be releasing this here? Do we care?
-            return false;
+            // Nobody's been draining us, drop the oldest audio rather than the newest
+            m_chain.consume(m_chain.numFrames());
         }
 
         // We have to do some size calculations to get the appropriately sized buffer from whatever is passed in
         const size_t outSize = determineBufferSize(in, m_audioFormat);
-        AudioPacket myBuffer(m_audioFormat, outSize);
-        const bool transformOk = filter.transformPacket(in, myBuffer);
-        const size_t trueSize = sizeOfBuffer < outSize? sizeOfBuffer : outSize;
-        if(!transformOk)
-        {
-            m_playbackClient->ReleaseBuffer(sizeOfBuffer, 0);
+        AudioPacket myBuffer = m_packetPool->acquire(m_audioFormat, outSize);
+        if(!runFilter(processor, in, myBuffer))
             return false;
-        }
+        m_chain.push(std::move(myBuffer));
 
-        std::memcpy(data, myBuffer.data(), trueSize);
-
-        ok = m_playbackClient->ReleaseBuffer(sizeOfBuffer, 0);
-        if(ok < 0)
-        {
-            // Some error occured, but by now, we don't care about it...
-        }
-
-        return true;
+        // Whatever doesn't fit now stays in the chain and goes out first next time
+        return writeChain();
     }
 
     bool AudioPlaybackDeviceImpl::writeToBuffer(AudioStream& in, const AbstractFilter& filter, TaskCallback* callback)
@@ -172,6 +221,11 @@ namespace Audio {
             return false;
         }
 
+        // The whole stream goes through one processor, so the filter's state carries across packets
+        const std::shared_ptr<FilterProcessor> processor = filter.createProcessor();
+        if(!processor)
+            return false;
+
         bool continueWriting = true;
         if(callback)
             continueWriting = !callback->isTaskStopped();
@@ -180,106 +234,127 @@ namespace Audio {
         size_t packetsWritten = 0;
         size_t emptyLoops = 0;
         const size_t maxLoops = 10; // Bailout in case we get stuck with an empty stream for too long
+        size_t periods = 0;
 
         while(continueWriting)
         {
-            //std::this_thread::sleep_for(std::chrono::microseconds(m_referenceTime /2 ));
-            unsigned int sizeOfBuffer = 0;
-            int ok = m_client->GetBufferSize(&sizeOfBuffer);
-            if(ok < 0)
-            {
-                // Something went wrong with getting the buffer size (...how?)
-                return false;
-            }
+            // Once the pool and stream have warmed up, nothing below should touch the heap
+            AllocationAudit::RealtimeScope realtime(periods >= DEFAULT_AUDIT_WARMUP);
 
-            unsigned int bitsPadded = 0;
-            ok = m_client->GetCurrentPadding(&bitsPadded);
-            if(ok < 0)
-            {
-                // Something went wrong with getting the amount ofpadding (...how?)
+            //std::this_thread::sleep_for(std::chrono::microseconds(m_referenceTime /2 ));
+            unsigned int freeFrames = 0;
+            if(!freeBufferFrames(freeFrames))
                 return false;
-            }
 
-            if(bitsPadded >= sizeOfBuffer)
+            if(freeFrames == 0)
             {
-                // Woops, we've been writing too much!
+                // Device buffer's full, nothing to do until it plays some of it
                 continue;
             }
 
-            AudioByte *data = nullptr;
-            sizeOfBuffer -= bitsPadded;
-            ok = m_playbackClient->GetBuffer(sizeOfBuffer, &data);
-            if(ok < 0)
-            {
-                // Something went wrong with grabbing a pointer to the buffer. That's no good.
-                m_playbackClient->ReleaseBuffer(sizeOfBuffer, 0); // Should we be releasing this here? Do we care?
-                return false;
-            }
-
-            //AudioFormat inFormat = in.getAudioFormat();
-            bool gotData = true;
-            //while(data && gotData && bytesWritten <= sizeOfBuffer)
-            //{
+            // Top the chain up until it can fill every free frame, however many packets that takes
             AudioPacket inPacket;
-            gotData = !in.isEmpty();
-            if(!gotData)
+            while(m_chain.numFrames() < freeFrames && !m_chain.isFull() && in.pop(inPacket))
             {
-                m_playbackClient->ReleaseBuffer(sizeOfBuffer, 0);
-                continueWriting = ++emptyLoops < maxLoops;
-                continue;
+                if(filtersInPlace(*processor, inPacket.getAudioFormat()))
+                {
+                    // The popped packet is already in the device's format, filter it and hand it on as is
+                    if(!runFilterInPlace(*processor, inPacket))
+                        return false;
+                    m_chain.push(std::move(inPacket));
+                    ++packetsWritten;
+                    continue;
+                }
+
+                const size_t outSize = determineBufferSize(inPacket, m_audioFormat);
+                AudioPacket outPacket = m_packetPool->acquire(m_audioFormat, outSize);
+                if(!runFilter(*processor, inPacket, outPacket))
+                    return false;
+                m_chain.push(std::move(outPacket));
+                ++packetsWritten;
             }
 
-            gotData = in.pop(inPacket);
-            if(!gotData)
+            if(m_chain.isEmpty())
             {
-                // Something went wrong here
-                m_playbackClient->ReleaseBuffer(sizeOfBuffer, 0);
-                continueWriting = ++emptyLoops < maxLoops;
-                continue;
-            }
-
-            const unsigned int originalBufferSize = sizeOfBuffer;
-            sizeOfBuffer *= m_audioFormat.bitsPerBlock;
-
-            if(inPacket.byteSize() > sizeOfBuffer)
-            {
-                m_playbackClient->ReleaseBuffer(sizeOfBuffer, 0);
                 continueWriting = ++emptyLoops < maxLoops;
                 continue;
             }
             emptyLoops = 0;
-            const size_t outSize = determineBufferSize(inPacket, m_audioFormat);
-            AudioPacket outPacket(m_audioFormat, outSize);
-            const bool transformOk = filter.transformPacket(inPacket, outPacket);
-            if(!transformOk)
-            {
-                m_playbackClient->ReleaseBuffer(sizeOfBuffer, 0);
+
+            if(!writeChain())
                 return false;
-            }
+            ++periods;
 
-            const unsigned int bytesToCopy = (unsigned int)(outPacket.byteSize() > sizeOfBuffer ? sizeOfBuffer : outPacket.byteSize());
-            std::memcpy(data, outPacket.data(), bytesToCopy);
+            continueWriting = (callback ? !callback->isTaskStopped() : packetsWritten < maxPacketsFallback);
+        }
 
+        // Anything left over belongs to this stream, not to whoever writes next
+        m_chain.clear();
+        stop();
 
-            // Bump the buffer pointer
-            //data = data + outPacket.size();
-            // bytesWritten += outPacket.size();
-            continueWriting = callback ? !callback->isTaskStopped() : ++packetsWritten < maxPacketsFallback;
-            //}
+        return true;
 
-            ok = m_playbackClient->ReleaseBuffer(originalBufferSize, 0);
-            if(ok < 0)
-            {
-                // Some error occured, but by now, we don't care about it...
-            }
+    }
 
-            continueWriting = (callback ? !callback->isTaskStopped() : packetsWritten < maxPacketsFallback);
+    bool AudioPlaybackDeviceImpl::freeBufferFrames(unsigned int& freeFrames)
+    {
+        freeFrames = 0;
+
+        // Both of these are in frames, not bytes
+        unsigned int bufferFrames = 0;
+        int ok = m_client->GetBufferSize(&bufferFrames);
+        if(ok < 0)
+        {
+            // Something went wrong with getting the buffer size (...how?)
+            return false;
         }
 
-        stop();
+        unsigned int paddingFrames = 0;
+        ok = m_client->GetCurrentPadding(&paddingFrames);
+        if(ok < 0)
+        {
+            // Something went wrong with getting the amount ofpadding (...how?)
+            return false;
+        }
 
+        if(paddingFrames < bufferFrames)
+            freeFrames = bufferFrames - paddingFrames;
         return true;
+    }
+
+    bool AudioPlaybackDeviceImpl::writeChain()
+    {
+        unsigned int freeFrames = 0;
+        if(!freeBufferFrames(freeFrames))
+            return false;
+
+        const unsigned int framesToWrite = (unsigned int)(m_chain.numFrames() < freeFrames ? m_chain.numFrames() : freeFrames);
+        if(framesToWrite == 0)
+            return true;
 
+        AudioByte *data = nullptr;
+        int ok = m_playbackClient->GetBuffer(framesToWrite, &data);
+        if(ok < 0 || data == nullptr)
+        {
+            // Something went wrong with grabbing a pointer to the buffer. That's no good.
+            return false;
+        }
+
+        // Packet boundaries don't matter here, the chain fills exactly framesToWrite frames
+        const AudioTimestamp released = m_chain.frontTimestamp();
+        m_chain.read(data, framesToWrite);
+
+        ok = m_playbackClient->ReleaseBuffer(framesToWrite, 0);
+        if(ok < 0)
+        {
+            // Some error occured, but by now, we don't care about it...
+        }
+        else
+        {
+            LatencyTrace::released(released);
+        }
+
+        return true;
     }
 
 #endif
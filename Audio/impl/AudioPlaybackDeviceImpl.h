@@ -20,6 +20,9 @@
 #pragma once
 
 #include "AbstractAudioDeviceImpl.h"
+#include "../AudioPacketChain.h"
+
+#include <memory>
 
 namespace DX {
 namespace Audio {
@@ -27,6 +30,7 @@ namespace Audio {
 #ifdef WIN32
 
     struct AbstractFilter;
+    class FilterProcessor;
 
     class AudioPlaybackDeviceImpl : public AbstractAudioDeviceImpl
     {
@@ -40,12 +44,31 @@ namespace Audio {
 
         // TODO: Modify signature to provide error handling features
         virtual bool        writeToBuffer(const AudioPacket& in, const AbstractFilter& filter);
+        virtual bool        writeToBuffer(const AudioPacket& in, FilterProcessor& processor);
         virtual bool        writeToBuffer(AudioStream& in, const AbstractFilter& filter, TaskCallback* callback);
         virtual AudioPacket readFromBuffer();
         virtual bool        readFromBuffer(AudioStream& out, TaskCallback* callback);
 
     protected:
+        /*! Runs processor from in to out, out being in the device's (INTERLEAVED) format. If the
+            processor prefers another SampleLayout, in is converted to it once on the way in and the
+            result converted back once on the way out.
+        */
+        bool                runFilter(FilterProcessor& processor, const AudioPacket& in, AudioPacket& out);
+        /*! Runs processor over packet where it lies. Only for packets filtersInPlace() accepts. */
+        bool                runFilterInPlace(FilterProcessor& processor, AudioPacket& packet);
+        /*! \return True if processor can filter packets of format in place, straight into the device's
+            format - that is, it supports in place processing and format already is the device's FLOAT32
+        */
+        bool                filtersInPlace(const FilterProcessor& processor, const AudioFormat& format) const;
+        // How many frames the device buffer has room for right now
+        bool                freeBufferFrames(unsigned int& freeFrames);
+        // Moves as many frames out of m_chain as the device buffer has room for
+        bool                writeChain();
+
         IAudioRenderClient*	m_playbackClient;
+        // Filtered audio waiting for room in the device buffer, handed out by the frame
+        AudioPacketChain    m_chain;
 
     };
 
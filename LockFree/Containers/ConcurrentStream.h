@@ -27,7 +27,9 @@
 
 #include "AbstractQueue.h"
 
+#include <assert.h>
 #include <new>
+#include <utility>
 
 namespace DX {
 namespace LockFree {
@@ -36,6 +38,14 @@ namespace LockFree {
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // ConcurrentStream 
 
+    /*! \brief ConcurrentStream is a single-reader, single-writer queue.
+
+        Nodes are never freed while the stream is alive. Once the reader has moved past a Node, the
+        writer takes it back for its next push, reusing both the Node and the T it holds (which is
+        assigned to, not reconstructed). So once a stream has been as deep as it is ever going to
+        get, push() and pop() never touch the heap - for a T like AudioPacket, whose move assignment
+        doesn't allocate, the whole round trip is allocation free.
+    */
     template <typename T>
     class ConcurrentStream : public Queue<T>
     {
@@ -52,7 +62,25 @@ namespace LockFree {
         void    push(const T& in);
         void    push(T&& moveIn);
 
+        /*! Pops (and discards) everything in the stream. Reader side only, the Nodes are kept for reuse */
         void    clear();
+
+    private:
+        // Writer side only. Hands back a Node the reader is done with, or a brand new one
+        Node<T>*                acquireNode();
+        // Writer side only. Links node in at the end of the stream
+        void                    publish(Node<T>* node);
+        // Frees every Node we own, from m_first on
+        void                    destroyNodes();
+
+        // Writer side: the oldest Node we still own (reusable up to the reader's position), and our
+        // last look at that position
+        Node<T>*                m_first;
+        Node<T>*                m_consumedCopy;
+        volatile char           pad_3[CACHE_LINE_SIZE - ((2 * sizeof(Node<T>*)) % CACHE_LINE_SIZE)];
+        // Reader side: the reader's current position (m_start), published for the writer
+        std::atomic<Node<T>*>   m_consumed;
+        volatile char           pad_4[CACHE_LINE_SIZE - (sizeof(std::atomic<Node<T>*>) % CACHE_LINE_SIZE)];
     };
 
 
@@ -65,13 +93,20 @@ namespace LockFree {
     {
         m_start = new Node<T>();
         m_end = m_start;
+        m_first = m_start;
+        m_consumedCopy = m_start;
+        m_consumed = m_start;
         assert(m_start != nullptr);
     }
 
     template <typename T>
-    ConcurrentStream<T>::ConcurrentStream(const ConcurrentStream& copy)
+    ConcurrentStream<T>::ConcurrentStream(const ConcurrentStream& copy) : Queue<T>()
     {
         m_start = new Node<T>();
+        m_end = m_start;
+        m_first = m_start;
+        m_consumedCopy = m_start;
+        m_consumed = m_start;
         assert(m_start != nullptr);
         assert(copy.m_start != nullptr);
 
@@ -85,20 +120,21 @@ namespace LockFree {
     }
 
     template <typename T>
-    ConcurrentStream<T>::ConcurrentStream(ConcurrentStream&& move)
+    ConcurrentStream<T>::ConcurrentStream(ConcurrentStream&& move) : Queue<T>()
     {
-        m_start = new Node<T>();
-        m_start->next = move.m_start->next;
-        move.m_start->next = nullptr;
-        if(move.m_end == move.m_start)
-        {
-            m_end = m_start;
-        }
-        else
-        {
-            move.m_end = move.m_start;
-            m_end = move.m_end;
-        }
+        // Take move's Nodes wholesale, and leave it a fresh, empty stream
+        m_start = move.m_start;
+        m_end = move.m_end;
+        m_first = move.m_first;
+        m_consumedCopy = move.m_consumedCopy;
+        m_consumed = move.m_consumed.load();
+        m_size = move.m_size.load();
+
+        move.m_start = new Node<T>();
+        move.m_end = move.m_start;
+        move.m_first = move.m_start;
+        move.m_consumedCopy = move.m_start;
+        move.m_consumed = move.m_start;
         move.m_size = 0;
 
         assert(m_start != nullptr);
@@ -108,28 +144,35 @@ namespace LockFree {
     template <typename T>
     ConcurrentStream<T>::~ConcurrentStream()
     {
-        clear();
-        
-        delete m_start->data;
-        m_start->data = nullptr;
-        delete m_start;
+        destroyNodes();
+    }
+
+    template <typename T>
+    void ConcurrentStream<T>::destroyNodes()
+    {
+        // Everything from m_first through m_end is still linked together
+        Node<T>* currentNode = m_first;
+        while(currentNode != nullptr)
+        {
+            Node<T>* nextNode = currentNode->next.load();
+            delete currentNode->data;
+            delete currentNode;
+            currentNode = nextNode;
+        }
+
         m_start = nullptr;
+        m_end = nullptr;
+        m_first = nullptr;
+        m_consumedCopy = nullptr;
     }
 
     template <typename T>
     void ConcurrentStream<T>::clear()
     {
-        while(m_start->next.load() != nullptr)
+        assert(m_start != nullptr);
+        T discarded;
+        while(pop(discarded))
         {
-            Node<T>* currentNode = m_start;
-            m_start = currentNode->next.load();
-            if(currentNode->data != nullptr)
-            {
-                delete currentNode->data;
-                currentNode->data = nullptr;
-            }
-            delete currentNode;
-            currentNode = nullptr;
         }
     }
 
@@ -167,44 +210,66 @@ namespace LockFree {
         if(newStart == nullptr)
             return false;
 
-        Node<T>* oldStart = m_start;
-        m_start = newStart;
-
-        assert(m_start->data != nullptr);
-        out = std::move(*(m_start->data));
+        assert(newStart->data != nullptr);
+        out = std::move(*(newStart->data));
         assert(m_size > 0);
         --m_size;
 
-        delete oldStart->data;
-        // Only null out what used to be there in DEBUG mode
-        #if defined _DEBUG || defined DEBUG 
-            oldStart->data = nullptr;
-        #endif
-        delete oldStart;
-        #if defined _DEBUG || defined DEBUG
-            oldStart = nullptr;
-        #endif
+        /*
+            The old start is free for the writer to reuse, but only once we're done reading out of
+            newStart - hence publishing after the move, with release semantics
+        */
+        m_start = newStart;
+        m_consumed.store(newStart, std::memory_order_release);
 
         return true;
     }
 
     template <typename T>
-    void ConcurrentStream<T>::push(const T& in)
+    Node<T>* ConcurrentStream<T>::acquireNode()
     {
-        assert(m_end != nullptr);
+        // Only go and look at the reader's position when we've used up everything we knew was free
+        if(m_first == m_consumedCopy)
+            m_consumedCopy = m_consumed.load(std::memory_order_acquire);
 
-        Node<T>* temp = new (std::nothrow) Node<T>(new (std::nothrow) T(in));
-        assert(temp != nullptr);
-        assert(temp->data != nullptr);
+        if(m_first != m_consumedCopy)
+        {
+            Node<T>* node = m_first;
+            m_first = m_first->next.load(std::memory_order_relaxed);
+            node->next.store(nullptr, std::memory_order_relaxed);
+            return node;
+        }
 
-         /*
+        return new (std::nothrow) Node<T>();
+    }
+
+    template <typename T>
+    void ConcurrentStream<T>::publish(Node<T>* node)
+    {
+        /*
             Increment size before updating the Node's next ptr so we never have 
             the case of the queue reporting a size smaller than it is - bigger
             is ok.
         */
         ++m_size;
-        m_end->next = temp;
-        m_end = temp;
+        m_end->next = node;
+        m_end = node;
+    }
+
+    template <typename T>
+    void ConcurrentStream<T>::push(const T& in)
+    {
+        assert(m_end != nullptr);
+
+        Node<T>* temp = acquireNode();
+        assert(temp != nullptr);
+        if(temp->data != nullptr)
+            *(temp->data) = in;
+        else
+            temp->data = new (std::nothrow) T(in);
+        assert(temp->data != nullptr);
+
+        publish(temp);
     }
 
     template <typename T>
@@ -212,19 +277,16 @@ namespace LockFree {
     {
         assert(m_end != nullptr);
 
-        Node<T>* temp = new (std::nothrow) Node<T>(new (std::nothrow) T(moveIn));
+        Node<T>* temp = acquireNode();
         assert(temp != nullptr);
+        if(temp->data != nullptr)
+            *(temp->data) = std::move(moveIn);
+        else
+            temp->data = new (std::nothrow) T(std::move(moveIn));
         assert(temp->data != nullptr);
 
-         /*
-            Increment size before updating the Node's next ptr so we never have 
-            the case of the queue reporting a size smaller than it is - bigger
-            is ok.
-        */
-        ++m_size;
-        m_end->next = temp;
-        m_end = temp;
+        publish(temp);
     }
 
 }
-}
\ No newline at end of file
+}
@@ -0,0 +1,277 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX LockFree - FlatCombining wraps any sequential data structure for highly contended use
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../CacheLine.h"
+#include "../ThreadSlots.h"
+#include "../Mutex/SpinMutex.h"
+#include "../Mutex/SpinYieldMutex.h" // For the DEFAULT_YIELD_TICKS definition
+
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <memory>
+#include <thread>
+
+namespace DX {
+namespace LockFree {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // FlatCombining
+
+    // Arbitrary for now, best results TBD
+    #ifndef DEFAULT_COMBINING_THREADS
+        #define DEFAULT_COMBINING_THREADS 64
+    #endif
+
+    // Arbitrary for now, best results TBD
+    #ifndef DEFAULT_COMBINING_PASSES
+        #define DEFAULT_COMBINING_PASSES 3
+    #endif
+
+    /*! \brief FlatCombining turns any plain, single-threaded data structure into a thread-safe one
+        that holds up under heavy contention.
+
+        Rather than every thread fighting over the lock (and the cache lines of the structure behind
+        it), each thread publishes the operation it wants done in its own publication record, a
+        cache line that only it writes to. Whichever thread manages to take the lock becomes the
+        combiner: it sweeps the records and runs every pending operation in one go, while the other
+        threads simply wait for their record to be marked done. The structure stays hot in the
+        combiner's cache, and the lock changes hands once per batch instead of once per operation.
+
+        Records are assigned through ThreadSlots, so threads on the same NUMA node sit next to each
+        other in the sweep, and a thread's record is handed back when it exits. Threads beyond
+        maxThreads take the lock directly, until one of the threads holding a record exits.
+
+        Operations are any callable taking a T&. They run on whichever thread is combining, so they
+        must not depend on thread-local state, and must not call back into the same FlatCombining.
+        An operation that throws has its exception rethrown from the apply() call it was passed to.
+
+        \code
+        FlatCombining<std::priority_queue<int>> queue;
+
+        void producer()
+        {
+            queue.apply([](std::priority_queue<int>& q) { q.push(rand()); });
+        }
+
+        bool consumer(int& out)
+        {
+            bool popped = false;
+            queue.apply([&](std::priority_queue<int>& q)
+            {
+                if(q.empty())
+                    return;
+                out = q.top();
+                q.pop();
+                popped = true;
+            });
+            return popped;
+        }
+        \endcode
+    */
+    template <typename T>
+    class FlatCombining
+    {
+    public:
+        /*! \param[in] maxThreads   The number of distinct threads that get a publication record
+            \param[in] maxPasses    How many sweeps over the records a combiner makes before giving up the lock
+        */
+        explicit FlatCombining(size_t maxThreads = DEFAULT_COMBINING_THREADS,
+            size_t maxPasses = DEFAULT_COMBINING_PASSES);
+        ~FlatCombining();
+
+        /*! Runs operation on the wrapped object, blocking until it has been run (by this thread or
+            whichever thread is combining). Rethrows whatever operation throws.
+        */
+        template <typename Operation>
+        void    apply(Operation operation) const;
+
+    private:
+        struct Record
+        {
+            Record();
+
+            volatile char       pad_0[CACHE_LINE_SIZE];
+            void                (*invoke)(void*, T&);
+            void*               context;
+            std::exception_ptr  error;  // What invoke threw, for the owner to rethrow
+            std::atomic<bool>   pending;
+            volatile char       pad_1[CACHE_LINE_SIZE - ((sizeof(void (*)(void*, T&)) + sizeof(void*) + sizeof(std::exception_ptr) + sizeof(std::atomic<bool>)) % CACHE_LINE_SIZE)];
+        };
+
+        // Gives the combiner lock back however combining ends
+        struct CombinerLock
+        {
+            explicit CombinerLock(const SpinMutex& mutex);
+            ~CombinerLock();
+
+            const SpinMutex&    mutex;
+
+        private:
+            CombinerLock(const CombinerLock&);
+            CombinerLock& operator=(const CombinerLock&);
+        };
+
+        template <typename Operation>
+        static void invokeOperation(void* context, T& object);
+
+        void    combine() const;
+
+        const size_t                m_maxPasses;
+        ThreadSlots                 m_slots;
+        std::unique_ptr<Record[]>   m_records;
+        // SpinMutex is already padded on its own cache lines
+        SpinMutex                   m_lock;
+        mutable T                   m_object;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        FlatCombining(const FlatCombining&);
+        FlatCombining(FlatCombining&&);
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // FlatCombining impl
+
+    template <typename T>
+    FlatCombining<T>::Record::Record() : invoke(nullptr), context(nullptr), error(), pending(false)
+    {
+    }
+
+    template <typename T>
+    FlatCombining<T>::CombinerLock::CombinerLock(const SpinMutex& lockedMutex) : mutex(lockedMutex)
+    {
+    }
+
+    template <typename T>
+    FlatCombining<T>::CombinerLock::~CombinerLock()
+    {
+        mutex.unlock();
+    }
+
+    template <typename T>
+    FlatCombining<T>::FlatCombining(size_t maxThreads, size_t maxPasses)
+        : m_maxPasses(maxPasses > 0 ? maxPasses : 1), m_slots(maxThreads), m_records(new Record[maxThreads])
+    {
+    }
+
+    template <typename T>
+    FlatCombining<T>::~FlatCombining()
+    {
+    }
+
+    template <typename T>
+    template <typename Operation>
+    void FlatCombining<T>::invokeOperation(void* context, T& object)
+    {
+        (*static_cast<Operation*>(context))(object);
+    }
+
+    template <typename T>
+    template <typename Operation>
+    void FlatCombining<T>::apply(Operation operation) const
+    {
+        const size_t slot = m_slots.slot();
+        if(slot >= m_slots.size())
+        {
+            // Out of records, just do it the old fashioned way
+            SpinLock lock(m_lock);
+            operation(m_object);
+            return;
+        }
+
+        // Only we ever write our record while it isn't pending, the release below publishes both fields
+        Record& record = m_records[slot];
+        record.invoke = &invokeOperation<Operation>;
+        record.context = &operation;
+        record.pending.store(true, std::memory_order_release);
+
+        size_t numTries = 0;
+        while(record.pending.load(std::memory_order_acquire))
+        {
+            if(m_lock.tryLock())
+            {
+                CombinerLock lock(m_lock);
+                combine();
+                // Our own record is always swept, so we're done
+                assert(!record.pending.load(std::memory_order_relaxed));
+                break;
+            }
+
+            if(++numTries >= DEFAULT_YIELD_TICKS)
+            {
+                numTries = 0;
+                std::this_thread::yield();
+            }
+        }
+
+        if(record.error)
+        {
+            std::exception_ptr error = record.error;
+            record.error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    template <typename T>
+    void FlatCombining<T>::combine() const
+    {
+        const size_t numRecords = m_slots.size();
+        for(size_t pass = 0; pass < m_maxPasses; ++pass)
+        {
+            bool combinedAny = false;
+            for(size_t i = 0; i < numRecords; ++i)
+            {
+                Record& record = m_records[i];
+                if(!record.pending.load(std::memory_order_acquire))
+                    continue;
+
+                // The operation may belong to another thread, so its exception is handed back to that thread
+                try
+                {
+                    record.invoke(record.context, m_object);
+                }
+                catch(...)
+                {
+                    record.error = std::current_exception();
+                }
+                record.pending.store(false, std::memory_order_release);
+                combinedAny = true;
+            }
+
+            // Nobody published anything while we were sweeping, no point in holding onto the lock
+            if(!combinedAny)
+                break;
+        }
+    }
+
+}
+}
@@ -26,10 +26,18 @@
 #pragma once
 
 #include "CacheLine.h"
+#include "ThreadLocal.h"
+#include "ThreadSlots.h"
+#include "Topology.h"
 #include "Mutex/AbstractBarrier.h"
+#include "Mutex/CohortMutex.h"
+#include "Mutex/CombiningTreeBarrier.h"
 #include "Mutex/CyclicSpinBarrier.h"
+#include "Mutex/Futex.h"
 #include "Mutex/Mutex.h"
+#include "Mutex/Phaser.h"
 #include "Mutex/RWMutex.h"
+#include "Mutex/SenseReversingBarrier.h"
 #include "Mutex/SpinBarrier.h"
 #include "Mutex/SpinMutex.h"
 #include "Mutex/SpinRecursiveMutex.h"
@@ -39,3 +47,4 @@
 #include "Containers/AbstractQueue.h"
 #include "Containers/ConcurrentQueue.h"
 #include "Containers/ConcurrentStream.h"
+#include "Containers/FlatCombining.h"
@@ -0,0 +1,186 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CohortMutex.h"
+#include "../Topology.h"
+
+#include <cassert>
+#include <thread>
+
+namespace DX {
+namespace LockFree {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // CohortMutex impl
+
+    CohortMutex::CohortNode::CohortNode() : nextTicket(0), nowServing(0), ownsGlobal(false), handoffs(0)
+    {
+    }
+
+    CohortMutex::CohortMutex(size_t maxLocalHandoffs)
+        : Mutex(), m_global(false), m_ownerNode(0), m_globalAcquisitions(0), m_localHandoffs(0),
+        m_maxLocalHandoffs(maxLocalHandoffs), m_numNodes(Topology::numNodes()),
+        m_nodes(new CohortNode[Topology::numNodes()])
+    {
+        assert(m_numNodes > 0);
+    }
+
+    CohortMutex::~CohortMutex()
+    {
+    }
+
+    void CohortMutex::acquireGlobal() const
+    {
+        size_t numTries = 0;
+        while(m_global.exchange(true, std::memory_order_acquire))
+        {
+            // Wait for the lock to look free before trying to grab the line again
+            while(m_global.load(std::memory_order_relaxed))
+            {
+                if(++numTries >= DEFAULT_YIELD_TICKS)
+                {
+                    numTries = 0;
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    void CohortMutex::lock() const
+    {
+        const size_t nodeIndex = Topology::currentNode() % m_numNodes;
+        CohortNode& node = m_nodes[nodeIndex];
+
+        const size_t ticket = node.nextTicket.fetch_add(1, std::memory_order_relaxed);
+        size_t numTries = 0;
+        while(node.nowServing.load(std::memory_order_acquire) != ticket)
+        {
+            if(++numTries >= DEFAULT_YIELD_TICKS)
+            {
+                numTries = 0;
+                std::this_thread::yield();
+            }
+        }
+
+        // Here we own our node's local lock
+        if(node.ownsGlobal)
+        {
+            // Someone from our node passed the global lock along with the local one
+            m_localHandoffs.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            acquireGlobal();
+            node.ownsGlobal = true;
+            node.handoffs = 0;
+            m_globalAcquisitions.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        m_ownerNode = nodeIndex;
+    }
+
+    bool CohortMutex::tryLock() const
+    {
+        const size_t nodeIndex = Topology::currentNode() % m_numNodes;
+        CohortNode& node = m_nodes[nodeIndex];
+
+        // The local lock is only free if nobody holds a ticket that hasn't been served
+        size_t ticket = node.nowServing.load(std::memory_order_acquire);
+        if(!node.nextTicket.compare_exchange_strong(ticket, ticket + 1, std::memory_order_acquire))
+            return false;
+
+        // A free local lock never owns the global lock - unlock() releases it when nobody is waiting
+        assert(!node.ownsGlobal);
+        if(m_global.exchange(true, std::memory_order_acquire))
+        {
+            // Some other node has it. Give our ticket back
+            node.nowServing.store(ticket + 1, std::memory_order_release);
+            return false;
+        }
+
+        node.ownsGlobal = true;
+        node.handoffs = 0;
+        m_globalAcquisitions.fetch_add(1, std::memory_order_relaxed);
+        m_ownerNode = nodeIndex;
+        return true;
+    }
+
+    void CohortMutex::unlock() const
+    {
+        assert(m_ownerNode < m_numNodes);
+        CohortNode& node = m_nodes[m_ownerNode];
+        assert(node.ownsGlobal); // unlock called without a matching lock
+
+        const size_t serving = node.nowServing.load(std::memory_order_relaxed);
+        const bool cohortWaiting = node.nextTicket.load(std::memory_order_relaxed) != serving + 1;
+        if(cohortWaiting && node.handoffs < m_maxLocalHandoffs)
+        {
+            // Keep the global lock within our node, the next local ticket holder inherits it
+            ++node.handoffs;
+        }
+        else
+        {
+            node.ownsGlobal = false;
+            m_global.store(false, std::memory_order_release);
+        }
+
+        node.nowServing.store(serving + 1, std::memory_order_release);
+    }
+
+    size_t CohortMutex::maxLocalHandoffs() const
+    {
+        return m_maxLocalHandoffs;
+    }
+
+    size_t CohortMutex::numNodes() const
+    {
+        return m_numNodes;
+    }
+
+    size_t CohortMutex::globalAcquisitions() const
+    {
+        return m_globalAcquisitions.load(std::memory_order_relaxed);
+    }
+
+    size_t CohortMutex::localHandoffs() const
+    {
+        return m_localHandoffs.load(std::memory_order_relaxed);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // CohortLock impl
+
+    CohortLock::CohortLock(const CohortMutex& _mutex) : m_mutex(&_mutex)
+    {
+        assert(m_mutex); // We should have a handle on a valid mutex
+        if(m_mutex)
+            m_mutex->lock();
+    }
+
+    CohortLock::~CohortLock()
+    {
+        assert(m_mutex); // We should have a handle on a valid mutex
+        if(m_mutex)
+            m_mutex->unlock();
+    }
+
+}
+}
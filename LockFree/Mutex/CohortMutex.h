@@ -0,0 +1,172 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX LockFree - CohortMutex is a NUMA-aware Mutex that batches ownership within a single node
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../CacheLine.h"
+#include "Mutex.h"
+#include "SpinYieldMutex.h" // For the DEFAULT_YIELD_TICKS definition
+
+#include <atomic>
+#include <memory>
+
+namespace DX {
+namespace LockFree {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // CohortMutex
+
+    // Arbitrary for now, best results TBD
+    #ifndef DEFAULT_COHORT_HANDOFFS
+        #define DEFAULT_COHORT_HANDOFFS 64
+    #endif
+
+    /*! \brief CohortMutex is a hierarchical (cohort) lock for machines with more than one NUMA node.
+        Every node has its own local ticket lock, and all of the nodes share a single global lock.
+        A thread first takes the local lock of the node it is running on. If the previous owner from
+        that node left the global lock held, ownership is handed straight over without touching the
+        global lock at all. Otherwise the thread takes the global lock itself.
+
+        On unlock(), if another thread on the same node is already waiting, the global lock is kept
+        and only the local lock is passed along. This keeps the protected data (and the lock's own
+        cache lines) on one socket for a while instead of bouncing between sockets on every handoff.
+        To keep other nodes from starving, at most maxLocalHandoffs() handoffs happen in a row before
+        the global lock is released.
+
+        Node topology comes from Topology. On a machine with a single node, CohortMutex behaves like
+        a fair (FIFO) SpinYieldMutex.
+
+        \note CohortMutex is not a recursive mutex
+
+        \code
+        mutable CohortMutex myMutex;
+        MyClass myClass;
+
+        void setMyClass(const MyClass& other)
+        {
+            CohortLock _lock(myMutex);
+            myClass = other;
+        }
+        \endcode
+    */
+    class CohortMutex : public Mutex
+    {
+    public:
+        /*! \param[in] maxLocalHandoffs Number of consecutive handoffs within a node before the global
+            lock is given up to the other nodes
+        */
+        explicit CohortMutex(size_t maxLocalHandoffs = DEFAULT_COHORT_HANDOFFS);
+        ~CohortMutex();
+
+        /*! Locks the mutex. Blocks until ownership is obtained.
+            \note lock() is not recursive.
+        */
+        void lock() const;
+        /*! Attempts to lock the mutex without blocking.
+            \return True if ownership was obtained, false otherwise
+        */
+        bool tryLock() const;
+        /*! Unlocks the mutex, handing it to a thread on the same node if there is one waiting. */
+        void unlock() const;
+
+        size_t  maxLocalHandoffs() const;
+        size_t  numNodes() const;
+
+        /*! \return The number of times the global lock has been acquired. Each of these is a point
+            where ownership may have moved from one node to another.
+        */
+        size_t  globalAcquisitions() const;
+        /*! \return The number of times ownership was handed over within a node, without the global
+            lock being released.
+        */
+        size_t  localHandoffs() const;
+
+    private:
+        struct CohortNode
+        {
+            CohortNode();
+
+            volatile char       pad_0[CACHE_LINE_SIZE];
+            std::atomic<size_t> nextTicket;
+            volatile char       pad_1[CACHE_LINE_SIZE - (sizeof(std::atomic<size_t>) % CACHE_LINE_SIZE)];
+            std::atomic<size_t> nowServing;
+            volatile char       pad_2[CACHE_LINE_SIZE - (sizeof(std::atomic<size_t>) % CACHE_LINE_SIZE)];
+            // Only ever touched by the holder of this node's local lock
+            bool                ownsGlobal;
+            size_t              handoffs;
+            volatile char       pad_3[CACHE_LINE_SIZE - ((sizeof(bool) + sizeof(size_t)) % CACHE_LINE_SIZE)];
+        };
+
+        void acquireGlobal() const;
+
+        // Initial padding so we aren't overlapping some other potentially contended cache
+        volatile char                   pad_0[CACHE_LINE_SIZE];
+        mutable std::atomic<bool>       m_global;
+        volatile char                   pad_1[CACHE_LINE_SIZE - (sizeof(std::atomic<bool>) % CACHE_LINE_SIZE)];
+        // Written only by the current owner
+        mutable size_t                  m_ownerNode;
+        mutable std::atomic<size_t>     m_globalAcquisitions;
+        mutable std::atomic<size_t>     m_localHandoffs;
+        volatile char                   pad_2[CACHE_LINE_SIZE - ((sizeof(size_t) + 2 * sizeof(std::atomic<size_t>)) % CACHE_LINE_SIZE)];
+        const size_t                    m_maxLocalHandoffs;
+        const size_t                    m_numNodes;
+        std::unique_ptr<CohortNode[]>   m_nodes;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        CohortMutex(const CohortMutex&);
+        CohortMutex(CohortMutex&&);
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // CohortLock
+
+    /*! \brief CohortLock is a lock-guard style class that locks a CohortMutex upon creation and
+        unlocks it upon destruction. CohortLocks are the preferred way of interacting with CohortMutex.
+    */
+    class CohortLock
+    {
+    public:
+        /*! \param[in] mutex The CohortMutex the lock will lock and guard
+        */
+        CohortLock(const CohortMutex& mutex);
+        ~CohortLock();
+    private:
+        const CohortMutex* m_mutex;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        CohortLock(const CohortLock&);
+        CohortLock(CohortLock&&);
+    };
+
+}
+}
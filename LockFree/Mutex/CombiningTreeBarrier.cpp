@@ -0,0 +1,120 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CombiningTreeBarrier.h"
+
+#include <cassert>
+#include <thread>
+#include <vector>
+
+namespace DX {
+namespace LockFree {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // CombiningTreeBarrier impl
+
+    CombiningTreeBarrier::TreeNode::TreeNode() : count(0), initial(0), parent(nullptr), sense(0), sleeping(0)
+    {
+    }
+
+    CombiningTreeBarrier::CombiningTreeBarrier(size_t numThreads, size_t fanIn, size_t maxSpins)
+        : AbstractBarrier(numThreads), m_numThreads(numThreads), m_fanIn(fanIn < 2 ? 2 : fanIn),
+        m_maxSpins(maxSpins), m_slots(numThreads), m_nodes(nullptr)
+    {
+        // Work out how many nodes each level needs, leaves first
+        std::vector<size_t> levelSizes;
+        size_t children = (numThreads > 0 ? numThreads : 1);
+        do
+        {
+            children = (children + m_fanIn - 1) / m_fanIn;
+            levelSizes.push_back(children);
+        }
+        while(children > 1);
+
+        size_t totalNodes = 0;
+        for(size_t levelSize : levelSizes)
+            totalNodes += levelSize;
+        m_nodes.reset(new TreeNode[totalNodes]);
+
+        // Leaves wait on threads, every other level waits on the level below it
+        size_t levelStart = 0;
+        size_t arrivals = (numThreads > 0 ? numThreads : 1);
+        for(size_t level = 0; level < levelSizes.size(); ++level)
+        {
+            const size_t levelSize = levelSizes[level];
+            const size_t parentStart = levelStart + levelSize;
+            for(size_t i = 0; i < levelSize; ++i)
+            {
+                TreeNode& node = m_nodes[levelStart + i];
+                const size_t remaining = arrivals - i * m_fanIn;
+                node.initial = (remaining < m_fanIn ? remaining : m_fanIn);
+                node.count = node.initial;
+                node.parent = (level + 1 < levelSizes.size() ? &m_nodes[parentStart + i / m_fanIn] : nullptr);
+            }
+            arrivals = levelSize;
+            levelStart = parentStart;
+        }
+    }
+
+    CombiningTreeBarrier::~CombiningTreeBarrier()
+    {
+    }
+
+    void CombiningTreeBarrier::wait() const
+    {
+        size_t slot = m_slots.slot();
+        /*
+            Arriving without a leaf would throw every count in the tree off, so a thread beyond
+            numThreads waits for one of the others to exit and give its leaf back
+        */
+        while(slot >= m_numThreads)
+        {
+            std::this_thread::yield();
+            slot = m_slots.slot();
+        }
+
+        /*
+            Every node flips once a phase, and every node on our path was released (top down) before
+            we could get here again, so our leaf's sense is the sense of the whole phase
+        */
+        TreeNode& leaf = m_nodes[slot / m_fanIn];
+        arrive(leaf, leaf.sense.load(std::memory_order_acquire));
+    }
+
+    void CombiningTreeBarrier::arrive(TreeNode& node, uint32_t localSense) const
+    {
+        const size_t previous = node.count.fetch_sub(1, std::memory_order_acq_rel);
+        assert(previous > 0); // wait called too many times
+        if(previous != 1)
+        {
+            Futex::waitWhileEqual(node.sense, localSense, node.sleeping, m_maxSpins);
+            return;
+        }
+
+        // Last one into this node - re-arm it, carry the arrival up the tree, then release the others here
+        node.count.store(node.initial, std::memory_order_relaxed);
+        if(node.parent != nullptr)
+            arrive(*node.parent, localSense);
+        node.sense.store(localSense ^ 1, std::memory_order_seq_cst);
+        Futex::wakeAllSleeping(node.sense, node.sleeping);
+    }
+
+}
+}
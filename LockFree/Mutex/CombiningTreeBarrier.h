@@ -0,0 +1,129 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX LockFree - CombiningTreeBarrier is a scalable AbstractBarrier for large thread counts
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../CacheLine.h"
+#include "../ThreadSlots.h"
+#include "AbstractBarrier.h"
+#include "Futex.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace DX {
+namespace LockFree {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // CombiningTreeBarrier
+
+    // Arbitrary for now, best results TBD
+    #ifndef DEFAULT_BARRIER_FAN_IN
+        #define DEFAULT_BARRIER_FAN_IN 4
+    #endif
+
+    /*! \brief CombiningTreeBarrier is a self-resetting AbstractBarrier that spreads arrivals over a
+        tree of counters instead of a single shared one. Only fanIn threads ever decrement the same
+        counter, and only the last arriver at each node climbs to its parent, so each arrival costs
+        O(log n) and no cache line is ever contended by more than fanIn threads.
+
+        Threads are assigned leaves through ThreadSlots, which groups threads running on the same
+        NUMA node under the same leaves (and therefore the same subtrees). Most of the combining
+        traffic then stays on one socket, and only the upper levels of the tree cross nodes.
+
+        Releasing threads works the same way in reverse. A thread that isn't last into a node waits
+        on that node's own sense, so no more than fanIn threads ever watch the same cache line. Once
+        the root completes, its arriver flips the root's sense, and each thread released flips the
+        sense of the node it climbed out of on its way back down. Waiters spin on their node's line
+        in their own caches until it changes - then sleep on it (see Futex) if the phase runs long.
+
+        \note At most numThreads threads may use the barrier at once, as each thread keeps the leaf
+        it was first given until it exits. A thread beyond that blocks in wait() until one of the
+        others exits and its leaf can be handed over.
+
+        \code
+        CombiningTreeBarrier barrier(128);
+
+        void process()
+        {
+            while(true)
+            {
+                // Do some work
+                barrier.wait();
+            }
+        }
+        \endcode
+    */
+    class CombiningTreeBarrier : public AbstractBarrier
+    {
+    public:
+        /*! \param[in] numThreads   The number of threads that are expected to use this barrier
+            \param[in] fanIn        The number of arrivals combined at each node of the tree
+            \param[in] maxSpins     How long waiters spin before going to sleep
+        */
+        CombiningTreeBarrier(size_t numThreads = 2, size_t fanIn = DEFAULT_BARRIER_FAN_IN,
+            size_t maxSpins = DEFAULT_FUTEX_SPINS);
+        ~CombiningTreeBarrier();
+
+        /*! Blocks the current thread of execution until all other wait() calls have been made */
+        void wait() const;
+
+    private:
+        struct TreeNode
+        {
+            TreeNode();
+
+            volatile char           pad_0[CACHE_LINE_SIZE];
+            std::atomic<size_t>     count;
+            size_t                  initial;
+            TreeNode*               parent;
+            volatile char           pad_1[CACHE_LINE_SIZE - ((sizeof(std::atomic<size_t>) + sizeof(size_t) + sizeof(TreeNode*)) % CACHE_LINE_SIZE)];
+            // Kept off count's line, so arrivals don't disturb the threads waiting here
+            std::atomic<uint32_t>   sense;
+            std::atomic<uint32_t>   sleeping;
+            volatile char           pad_2[CACHE_LINE_SIZE - ((2 * sizeof(std::atomic<uint32_t>)) % CACHE_LINE_SIZE)];
+        };
+
+        // Arrives at node, carrying the arrival up if it's the last one in, and returns once released
+        void arrive(TreeNode& node, uint32_t localSense) const;
+
+        const size_t                    m_numThreads;
+        const size_t                    m_fanIn;
+        const size_t                    m_maxSpins;
+        ThreadSlots                     m_slots;
+        std::unique_ptr<TreeNode[]>     m_nodes;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        CombiningTreeBarrier(const CombiningTreeBarrier&);
+        CombiningTreeBarrier(CombiningTreeBarrier&&);
+    };
+
+}
+}
@@ -0,0 +1,121 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Futex.h"
+
+#include <thread>
+
+#if defined(WIN32) || defined(_WIN32)
+    #include <windows.h>
+    #if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+        #define DX_HAS_WAIT_ON_ADDRESS
+        #pragma comment(lib, "Synchronization.lib")
+    #endif
+#elif defined(__linux__)
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace DX {
+namespace LockFree {
+namespace Futex {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Futex impl
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+        "Futex requires std::atomic<uint32_t> to be layout compatible with uint32_t");
+
+    static uint32_t* address(const std::atomic<uint32_t>& word)
+    {
+        return reinterpret_cast<uint32_t*>(const_cast<std::atomic<uint32_t>*>(&word));
+    }
+
+    void wait(const std::atomic<uint32_t>& word, uint32_t expected)
+    {
+        #if defined(DX_HAS_WAIT_ON_ADDRESS)
+            WaitOnAddress(address(word), &expected, sizeof(uint32_t), INFINITE);
+        #elif defined(__linux__)
+            syscall(SYS_futex, address(word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+        #else
+            if(word.load(std::memory_order_acquire) == expected)
+                std::this_thread::yield();
+        #endif
+    }
+
+    void wakeOne(const std::atomic<uint32_t>& word)
+    {
+        #if defined(DX_HAS_WAIT_ON_ADDRESS)
+            WakeByAddressSingle(address(word));
+        #elif defined(__linux__)
+            syscall(SYS_futex, address(word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+        #else
+            (void)word;
+        #endif
+    }
+
+    void wakeAll(const std::atomic<uint32_t>& word)
+    {
+        #if defined(DX_HAS_WAIT_ON_ADDRESS)
+            WakeByAddressAll(address(word));
+        #elif defined(__linux__)
+            syscall(SYS_futex, address(word), FUTEX_WAKE_PRIVATE, 0x7FFFFFFF, nullptr, nullptr, 0);
+        #else
+            (void)word;
+        #endif
+    }
+
+    uint32_t waitWhileEqual(const std::atomic<uint32_t>& word, uint32_t expected,
+        std::atomic<uint32_t>& sleeping, size_t maxSpins)
+    {
+        uint32_t current = word.load(std::memory_order_acquire);
+        for(size_t spins = 0; current == expected && spins < maxSpins; ++spins)
+            current = word.load(std::memory_order_acquire);
+
+        while(current == expected)
+        {
+            /*
+                Count ourselves in before the final check. Paired with the load in wakeAllSleeping(),
+                either the waker sees us counted or we see the new value. Only we take ourselves back
+                out, once we're awake, so a late waker from an earlier change can't hide us from the
+                waker we're actually waiting for
+            */
+            sleeping.fetch_add(1, std::memory_order_seq_cst);
+            current = word.load(std::memory_order_seq_cst);
+            if(current == expected)
+            {
+                wait(word, expected);
+                current = word.load(std::memory_order_acquire);
+            }
+            sleeping.fetch_sub(1, std::memory_order_seq_cst);
+        }
+        return current;
+    }
+
+    void wakeAllSleeping(const std::atomic<uint32_t>& word, std::atomic<uint32_t>& sleeping)
+    {
+        if(sleeping.load(std::memory_order_seq_cst) != 0)
+            wakeAll(word);
+    }
+
+}
+}
+}
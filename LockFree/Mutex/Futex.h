@@ -0,0 +1,77 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX LockFree - Futex provides OS-assisted sleeping on a 32-bit atomic word
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace DX {
+namespace LockFree {
+namespace Futex {
+
+    // Arbitrary for now, best results TBD
+    #ifndef DEFAULT_FUTEX_SPINS
+        #define DEFAULT_FUTEX_SPINS 1024
+    #endif
+
+    /*! \brief Futex is a thin wrapper over the operating system's "wait on address" primitive. On
+        Linux this is futex(2), on WIN32 (Windows 8 and up) it is WaitOnAddress. Everywhere else the
+        calls degrade into std::this_thread::yield(), which is correct but burns CPU.
+
+        Waits may return spuriously, so callers should always re-check their condition in a loop.
+    */
+
+    /*! Puts the calling thread to sleep as long as word still holds expected. Returns immediately if
+        word no longer holds expected.
+    */
+    void    wait(const std::atomic<uint32_t>& word, uint32_t expected);
+
+    /*! Wakes at most one thread sleeping in wait() on word */
+    void    wakeOne(const std::atomic<uint32_t>& word);
+
+    /*! Wakes every thread sleeping in wait() on word */
+    void    wakeAll(const std::atomic<uint32_t>& word);
+
+    /*! Blocks until word no longer holds expected. Spins for up to maxSpins checks before falling
+        back to sleeping in wait(), so short waits never pay for a system call. sleeping counts the
+        threads that may be asleep: each adds itself before sleeping and takes itself back out once
+        awake, so that wakers can skip the system call when nobody is asleep (see wakeAllSleeping()).
+
+        \return The first value observed that differs from expected
+    */
+    uint32_t waitWhileEqual(const std::atomic<uint32_t>& word, uint32_t expected,
+        std::atomic<uint32_t>& sleeping, size_t maxSpins = DEFAULT_FUTEX_SPINS);
+
+    /*! Wakes every thread sleeping in waitWhileEqual() on word, but only makes the system call if
+        sleeping says somebody might be asleep. Wakers only read sleeping, never reset it. word must already have been changed by the caller,
+        using a sequentially consistent store.
+    */
+    void    wakeAllSleeping(const std::atomic<uint32_t>& word, std::atomic<uint32_t>& sleeping);
+
+}
+}
+}
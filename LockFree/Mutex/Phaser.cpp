@@ -0,0 +1,167 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Phaser.h"
+
+#include <cassert>
+
+namespace DX {
+namespace LockFree {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Phaser impl
+
+    static const uint64_t PHASER_PARTY_MASK = 0xFFFF;
+    static const uint64_t PHASER_PARTIES_SHIFT = 16;
+    static const uint64_t PHASER_PHASE_SHIFT = 32;
+
+    static inline uint32_t phaseOf(uint64_t state)
+    {
+        return static_cast<uint32_t>(state >> PHASER_PHASE_SHIFT);
+    }
+
+    static inline uint64_t partiesOf(uint64_t state)
+    {
+        return (state >> PHASER_PARTIES_SHIFT) & PHASER_PARTY_MASK;
+    }
+
+    static inline uint64_t unarrivedOf(uint64_t state)
+    {
+        return state & PHASER_PARTY_MASK;
+    }
+
+    // Phase numbers wrap, so "has moved past" has to be a signed distance rather than a plain compare
+    static inline bool phaseAfter(uint32_t lhs, uint32_t rhs)
+    {
+        return static_cast<int32_t>(lhs - rhs) > 0;
+    }
+
+    Phaser::Phaser(size_t parties, size_t maxSpins)
+        : m_maxSpins(maxSpins), m_state((static_cast<uint64_t>(parties) << PHASER_PARTIES_SHIFT) | parties),
+        m_phase(0), m_sleeping(0)
+    {
+        assert(parties <= PHASER_PARTY_MASK);
+    }
+
+    Phaser::~Phaser()
+    {
+    }
+
+    uint32_t Phaser::arrive() const
+    {
+        return doArrive(0);
+    }
+
+    uint32_t Phaser::awaitPhase(uint32_t phase) const
+    {
+        /*
+            m_phase can briefly trail the real phase, so a value behind the one we're waiting on is
+            not a sign that the phase has passed - keep waiting until it's strictly ahead
+        */
+        uint32_t current = m_phase.load(std::memory_order_acquire);
+        while(!phaseAfter(current, phase))
+            current = Futex::waitWhileEqual(m_phase, current, m_sleeping, m_maxSpins);
+        return current;
+    }
+
+    uint32_t Phaser::arriveAndAwait() const
+    {
+        return awaitPhase(doArrive(0));
+    }
+
+    uint32_t Phaser::registerParty() const
+    {
+        uint64_t state = m_state.load(std::memory_order_relaxed);
+        while(true)
+        {
+            assert(partiesOf(state) < PHASER_PARTY_MASK); // Too many parties
+            const uint64_t next = state + (static_cast<uint64_t>(1) << PHASER_PARTIES_SHIFT) + 1;
+            if(m_state.compare_exchange_weak(state, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+                return phaseOf(state);
+        }
+    }
+
+    uint32_t Phaser::arriveAndDeregister() const
+    {
+        return doArrive(1);
+    }
+
+    uint32_t Phaser::phase() const
+    {
+        return phaseOf(m_state.load(std::memory_order_acquire));
+    }
+
+    size_t Phaser::registeredParties() const
+    {
+        return static_cast<size_t>(partiesOf(m_state.load(std::memory_order_relaxed)));
+    }
+
+    size_t Phaser::unarrivedParties() const
+    {
+        return static_cast<size_t>(unarrivedOf(m_state.load(std::memory_order_relaxed)));
+    }
+
+    uint32_t Phaser::doArrive(uint64_t partiesDelta) const
+    {
+        uint64_t state = m_state.load(std::memory_order_relaxed);
+        while(true)
+        {
+            assert(unarrivedOf(state) > 0); // arrive called by more parties than are registered
+            const uint32_t phase = phaseOf(state);
+            const uint64_t parties = partiesOf(state) - partiesDelta;
+
+            uint64_t next;
+            const bool advancing = (unarrivedOf(state) == 1);
+            if(advancing)
+            {
+                // Last one in - move on to the next phase, expecting everyone who's still registered
+                next = (static_cast<uint64_t>(phase + 1) << PHASER_PHASE_SHIFT) | (parties << PHASER_PARTIES_SHIFT) | parties;
+            }
+            else
+                next = state - 1 - (partiesDelta << PHASER_PARTIES_SHIFT);
+
+            if(m_state.compare_exchange_weak(state, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                if(advancing)
+                    publishPhase(phase + 1);
+                return phase;
+            }
+        }
+    }
+
+    void Phaser::publishPhase(uint32_t phase) const
+    {
+        /*
+            Whoever advanced a later phase may have beaten us here, never move the waiters' copy
+            backwards. The store has to be sequentially consistent for wakeAllSleeping()
+        */
+        uint32_t current = m_phase.load(std::memory_order_relaxed);
+        while(phaseAfter(phase, current))
+        {
+            if(m_phase.compare_exchange_weak(current, phase, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                Futex::wakeAllSleeping(m_phase, m_sleeping);
+                return;
+            }
+        }
+    }
+
+}
+}
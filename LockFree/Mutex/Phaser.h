@@ -0,0 +1,143 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX LockFree - Phaser is a split-phase barrier whose parties can come and go
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../CacheLine.h"
+#include "Futex.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace DX {
+namespace LockFree {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Phaser
+
+    /*! \brief Phaser is a reusable barrier that separates arriving from waiting, and whose number
+        of parties can change between (and during) phases.
+
+        Every phase has a number. A registered party calls arrive() once per phase, which never
+        blocks and returns the number of the phase it arrived in. When the last registered party
+        arrives the phase advances. A party that later wants to block until then calls
+        awaitPhase() with the number arrive() handed back - any work done between the two calls
+        overlaps with the other parties still finishing the phase. arriveAndAwait() is the plain
+        barrier behaviour of AbstractBarrier::wait().
+
+        Parties join with registerParty() and leave with arriveAndDeregister(), so pipeline stages
+        can be added and removed without rebuilding the barrier everyone is using.
+
+        The registered count, the unarrived count and the phase number are packed into a single
+        64-bit word, so each of these operations is one compare-and-swap. Waiters spin briefly and
+        then sleep (see Futex) on a separate 32-bit copy of the phase number.
+
+        \note At most 65535 parties may be registered at once.
+
+        \code
+        Phaser phaser(numStages);
+
+        void stage()
+        {
+            while(true)
+            {
+                produceBlock();
+                const uint32_t phase = phaser.arrive();
+                // Do something useful that doesn't depend on the other stages
+                phaser.awaitPhase(phase);
+                consumeBlock();
+            }
+        }
+        \endcode
+    */
+    class Phaser
+    {
+    public:
+        /*! \param[in] parties      The number of parties registered from the start
+            \param[in] maxSpins     How long waiters spin before going to sleep
+        */
+        explicit Phaser(size_t parties = 0, size_t maxSpins = DEFAULT_FUTEX_SPINS);
+        ~Phaser();
+
+        /*! Arrives at the current phase without waiting for the other parties.
+            \return The number of the phase arrived at, to be handed to awaitPhase()
+        */
+        uint32_t    arrive() const;
+
+        /*! Blocks until the phaser has moved past phase. Returns immediately if it already has.
+            \return The number of the phase the phaser is in now
+        */
+        uint32_t    awaitPhase(uint32_t phase) const;
+
+        /*! Arrives at the current phase and blocks until every other party has arrived as well.
+            \return The number of the phase the phaser is in now
+        */
+        uint32_t    arriveAndAwait() const;
+
+        /*! Adds a new party, which is expected to arrive in the current phase.
+            (Named registerParty since register is a reserved word)
+            \return The number of the phase the party joined in
+        */
+        uint32_t    registerParty() const;
+
+        /*! Arrives at the current phase and removes the caller from the registered parties, without
+            waiting for the others.
+            \return The number of the phase arrived at
+        */
+        uint32_t    arriveAndDeregister() const;
+
+        /*! \return The number of the current phase */
+        uint32_t    phase() const;
+        /*! \return The number of registered parties */
+        size_t      registeredParties() const;
+        /*! \return The number of registered parties that have not arrived in the current phase */
+        size_t      unarrivedParties() const;
+
+    private:
+        uint32_t    doArrive(uint64_t partiesDelta) const;
+        void        publishPhase(uint32_t phase) const;
+
+        const size_t                    m_maxSpins;
+        volatile char                   pad_0[CACHE_LINE_SIZE];
+        // [phase:32][parties:16][unarrived:16]
+        mutable std::atomic<uint64_t>   m_state;
+        volatile char                   pad_1[CACHE_LINE_SIZE - (sizeof(std::atomic<uint64_t>) % CACHE_LINE_SIZE)];
+        // Trails m_state's phase, only ever moved forward by the thread that advanced it
+        mutable std::atomic<uint32_t>   m_phase;
+        mutable std::atomic<uint32_t>   m_sleeping;
+        volatile char                   pad_2[CACHE_LINE_SIZE - ((2 * sizeof(std::atomic<uint32_t>)) % CACHE_LINE_SIZE)];
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        Phaser(const Phaser&);
+        Phaser(Phaser&&);
+    };
+
+}
+}
@@ -0,0 +1,63 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SenseReversingBarrier.h"
+
+#include <cassert>
+
+namespace DX {
+namespace LockFree {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // SenseReversingBarrier impl
+
+    SenseReversingBarrier::SenseReversingBarrier(size_t numThreads, size_t maxSpins)
+        : AbstractBarrier(numThreads), m_initial(numThreads), m_maxSpins(maxSpins), m_sense(0), m_sleeping(0)
+    {
+    }
+
+    SenseReversingBarrier::~SenseReversingBarrier()
+    {
+    }
+
+    void SenseReversingBarrier::wait() const
+    {
+        // The sense can't flip until we arrive, so this is the sense of the phase we're arriving in
+        const uint32_t localSense = m_sense.load(std::memory_order_acquire);
+
+        const size_t previous = m_count.fetch_sub(1, std::memory_order_acq_rel);
+        assert(previous > 0); // wait called too many times
+        if(previous == 1)
+        {
+            /*
+                Last one in. Re-arm the count before flipping, everyone who sees the new sense
+                (including threads racing ahead into the next phase) will also see the reset count
+            */
+            m_count.store(m_initial, std::memory_order_relaxed);
+            m_sense.store(localSense ^ 1, std::memory_order_seq_cst);
+            Futex::wakeAllSleeping(m_sense, m_sleeping);
+            return;
+        }
+
+        Futex::waitWhileEqual(m_sense, localSense, m_sleeping, m_maxSpins);
+    }
+
+}
+}
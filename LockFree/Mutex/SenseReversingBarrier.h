@@ -0,0 +1,93 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX LockFree - SenseReversingBarrier is a reusable barrier that sleeps instead of spinning forever
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../CacheLine.h"
+#include "AbstractBarrier.h"
+#include "Futex.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace DX {
+namespace LockFree {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // SenseReversingBarrier
+
+    /*! \brief SenseReversingBarrier is a self-resetting AbstractBarrier, like CyclicSpinBarrier, that
+        needs no locks to be reused.
+
+        Arriving at the barrier is a single fetch_sub on the shared count. Every waiter remembers the
+        barrier's "sense" from when it arrived, spins for a short while watching for it to change, and
+        then goes to sleep on it (see Futex). The last thread to arrive resets the count, flips the
+        sense and wakes everyone up - which also re-arms the barrier for the next phase.
+
+        Threads waiting through a long phase are asleep rather than burning a core, which makes
+        SenseReversingBarrier a good fit for block-processing loops where the phases are uneven.
+
+        \code
+        void process(SenseReversingBarrier& barrier)
+        {
+            while(true)
+            {
+                // Do some work
+                barrier.wait();
+            }
+        }
+        \endcode
+    */
+    class SenseReversingBarrier : public AbstractBarrier
+    {
+    public:
+        /*! \param[in] numThreads   The number of threads that are expected to use this barrier
+            \param[in] maxSpins     How long waiters spin before going to sleep
+        */
+        SenseReversingBarrier(size_t numThreads = 2, size_t maxSpins = DEFAULT_FUTEX_SPINS);
+        ~SenseReversingBarrier();
+
+        /*! Blocks the current thread of execution until all other wait() calls have been made */
+        void wait() const;
+
+    private:
+        const size_t                    m_initial;
+        const size_t                    m_maxSpins;
+        // Shares its line with nothing but the sleeper count, which is only touched on the slow path
+        mutable std::atomic<uint32_t>   m_sense;
+        mutable std::atomic<uint32_t>   m_sleeping;
+        volatile char                   pad_2[CACHE_LINE_SIZE - ((2 * sizeof(std::atomic<uint32_t>)) % CACHE_LINE_SIZE)];
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        SenseReversingBarrier(const SenseReversingBarrier&);
+        SenseReversingBarrier(SenseReversingBarrier&&);
+    };
+
+}
+}
@@ -18,7 +18,9 @@
 */ /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "SpinRecursiveMutex.h"
+#include "../ThreadLocal.h"
 
+#include <cassert>
 #include <thread>
 
 namespace DX {
@@ -28,7 +30,23 @@ namespace LockFree {
     ////////////////////////////////////////////////////////////////////////////////////////////////   
     // SpinRecursiveMutex impl
 
-    SpinRecursiveMutex::SpinRecursiveMutex() : SpinMutex(), m_owner(0), m_count(0)
+    /*
+        0 is reserved for "no owner", so ids start at 1. At namespace scope rather than in
+        currentThreadId(), as function statics aren't initialized thread safely on every compiler
+        we build with, and two threads racing the first call could share an id
+    */
+    static std::atomic<size_t> s_nextThreadId(1);
+    static DX_THREAD_LOCAL size_t s_threadId = 0;
+
+    static size_t currentThreadId()
+    {
+        if(s_threadId == 0)
+            s_threadId = s_nextThreadId.fetch_add(1, std::memory_order_relaxed);
+        return s_threadId;
+    }
+
+    SpinRecursiveMutex::SpinRecursiveMutex() 
+        : SpinMutex(), m_owner(0), m_depth(0), m_nextTicket(0), m_nowServing(0)
     {
     }
 
@@ -38,52 +56,62 @@ namespace LockFree {
 
     void SpinRecursiveMutex::lock() const
     {
-        const size_t queryingThread = std::this_thread::get_id().hash();
-        #if defined _DEBUG || defined DEBUG 
-            const bool wasLocked = m_lock.load();
-            assert(wasLocked ? queryingThread == m_owner : m_count == 0);
-        #endif
-        while(m_lock.exchange(true) && queryingThread != m_owner)
+        const size_t queryingThread = currentThreadId();
+        /*
+            Only the owner ever stores its own id into m_owner, and it clears it before letting go,
+            so a relaxed load can only ever see our id if we really are the owner
+        */
+        if(m_owner.load(std::memory_order_relaxed) == queryingThread)
         {
-            // Spin out while someone else has the lock
-            // TOOD: yield here?
+            ++m_depth;
+            return;
+        }
+
+        const size_t ticket = m_nextTicket.fetch_add(1, std::memory_order_relaxed);
+        size_t numTries = 0;
+        while(m_nowServing.load(std::memory_order_acquire) != ticket)
+        {
+            if(++numTries >= DEFAULT_YIELD_TICKS)
+            {
+                numTries = 0;
+                std::this_thread::yield();
+            }
         }
 
         // Here we have exclusive ownership
-        SpinLock _lock(m_assignmentMutex);
-        m_owner = queryingThread;
-        ++m_count;
+        assert(m_depth == 0);
+        m_owner.store(queryingThread, std::memory_order_relaxed);
+        m_depth = 1;
     }
 
     bool SpinRecursiveMutex::tryLock() const
     {
-        const size_t queryingThread = std::this_thread::get_id().hash();
-
-        const bool wasLocked = m_lock.exchange(true);
-        const size_t owner = m_owner;
-        if(!wasLocked || (wasLocked && queryingThread == owner))
+        const size_t queryingThread = currentThreadId();
+        if(m_owner.load(std::memory_order_relaxed) == queryingThread)
         {
-            SpinLock _lock(m_assignmentMutex);
-            assert(wasLocked ? queryingThread == m_owner : m_count == 0);
-            m_owner = queryingThread;
-            ++m_count;
+            ++m_depth;
             return true;
         }
-        return false;        
+
+        // Only free if every ticket handed out has been served
+        size_t ticket = m_nowServing.load(std::memory_order_acquire);
+        if(!m_nextTicket.compare_exchange_strong(ticket, ticket + 1, std::memory_order_acquire))
+            return false;
+
+        assert(m_depth == 0);
+        m_owner.store(queryingThread, std::memory_order_relaxed);
+        m_depth = 1;
+        return true;
     }
 
     void SpinRecursiveMutex::unlock() const
     {
-        #if defined(_DEBUG) || defined(DEBUG)
-            const size_t queryingThread = std::this_thread::get_id().hash();
-            assert(m_owner == queryingThread);
-        #endif
-
-        assert(m_count > 0); // Make sure unlock() isn't called more than lock()
-        if(--m_count == 0)
+        assert(m_owner.load(std::memory_order_relaxed) == currentThreadId());
+        assert(m_depth > 0); // Make sure unlock() isn't called more than lock()
+        if(--m_depth == 0)
         {
-            m_lock = false;
-            m_owner = 0;
+            m_owner.store(0, std::memory_order_relaxed);
+            m_nowServing.store(m_nowServing.load(std::memory_order_relaxed) + 1, std::memory_order_release);
         }
     }
 
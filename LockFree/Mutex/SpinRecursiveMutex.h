@@ -27,6 +27,7 @@
 
 #include "../CacheLine.h"
 #include "SpinMutex.h"
+#include "SpinYieldMutex.h" // For the DEFAULT_YIELD_TICKS definition
 
 #include <atomic>
 
@@ -41,6 +42,14 @@ namespace LockFree {
         fashion, assuming they are the owner of the lock. Typical use case is a public function that
         requires a lock on some member data, but has to recursively call itself for proper execution.
 
+        Every thread is handed a small integer id the first time it touches a SpinRecursiveMutex, and
+        that id is cached thread-locally from then on. Re-entering a mutex that the calling thread
+        already owns is a single relaxed load of the owner id plus an increment of the recursion
+        depth - no atomic read-modify-write operations at all.
+
+        Contended lock() calls are served in FIFO order (ticket based), spinning for DEFAULT_YIELD_TICKS
+        before yielding, so no thread can be starved by a busy owner repeatedly re-acquiring the lock.
+
         \code
 
         SpinRecursiveMutex  m_dataMutex;
@@ -57,7 +66,7 @@ namespace LockFree {
             return n + publicMemberFunction(n - 1);        
         }
 
-        \encode
+        \endcode
     
     */
     class SpinRecursiveMutex : public SpinMutex
@@ -89,10 +98,17 @@ namespace LockFree {
         void unlock() const;
 
     private:
-        mutable SpinMutex m_assignmentMutex;    // Potentially unecessary
-        mutable std::atomic<size_t> m_count;
+        /*
+            m_lock (inherited from SpinMutex) is unused - the ticket pair below replaces it so waiters
+            are served in order. The owner and depth are only ever written by the owning thread.
+        */
         mutable std::atomic<size_t> m_owner;
-        volatile char pad_0[CACHE_LINE_SIZE - ((sizeof(std::atomic<size_t>) + sizeof(std::atomic<bool>)) % CACHE_LINE_SIZE)];
+        mutable size_t              m_depth;
+        volatile char               pad_0[CACHE_LINE_SIZE - ((sizeof(std::atomic<size_t>) + sizeof(size_t)) % CACHE_LINE_SIZE)];
+        mutable std::atomic<size_t> m_nextTicket;
+        volatile char               pad_1[CACHE_LINE_SIZE - (sizeof(std::atomic<size_t>) % CACHE_LINE_SIZE)];
+        mutable std::atomic<size_t> m_nowServing;
+        volatile char               pad_2[CACHE_LINE_SIZE - (sizeof(std::atomic<size_t>) % CACHE_LINE_SIZE)];
 
         /*
             Copy and move constructors are hidden to prevent the compiler from automatically generating
@@ -23,6 +23,8 @@
 // Author: Eli Pinkerton
 // Date: 3/14/14
 ////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
 #include "SpinMutex.h"
 
 namespace DX {
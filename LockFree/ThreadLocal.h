@@ -0,0 +1,43 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX LockFree - ThreadLocal defines how to declare a variable with one instance per thread
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+/*!
+    DX_THREAD_LOCAL declares a static variable with one instance per thread. Visual Studio 2013
+    doesn't know thread_local, so there it falls back to __declspec(thread) - which only takes plain
+    types (no constructors or destructors) with a constant initializer. Keep to those everywhere.
+
+    \code
+    static DX_THREAD_LOCAL size_t threadId = 0;
+    \endcode
+*/
+#ifndef DX_THREAD_LOCAL
+    #if defined(_MSC_VER) && _MSC_VER < 1900
+        #define DX_THREAD_LOCAL __declspec(thread)
+    #else
+        #define DX_THREAD_LOCAL thread_local
+    #endif
+#endif
@@ -0,0 +1,254 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ThreadSlots.h"
+#include "ThreadLocal.h"
+#include "Topology.h"
+
+#include <thread>
+
+#if defined(WIN32) || defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+namespace DX {
+namespace LockFree {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // ThreadSlotsRegistry
+
+    /*
+        Every live ThreadSlots, so a thread's slots can be found and given back when it exits. Only
+        touched when a ThreadSlots is created or destroyed, or a thread that claimed slots exits.
+    */
+    struct ThreadSlotsRegistry
+    {
+        static void lock()
+        {
+            while(s_locked.exchange(true, std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+
+        static void unlock()
+        {
+            s_locked.store(false, std::memory_order_release);
+        }
+
+        static void add(ThreadSlots* slots)
+        {
+            lock();
+            slots->m_next = s_head;
+            if(s_head != nullptr)
+                s_head->m_previous = slots;
+            s_head = slots;
+            unlock();
+        }
+
+        static void remove(ThreadSlots* slots)
+        {
+            lock();
+            if(slots->m_previous != nullptr)
+                slots->m_previous->m_next = slots->m_next;
+            else
+                s_head = slots->m_next;
+            if(slots->m_next != nullptr)
+                slots->m_next->m_previous = slots->m_previous;
+            unlock();
+        }
+
+        static void releaseThread(size_t thread)
+        {
+            lock();
+            for(ThreadSlots* slots = s_head; slots != nullptr; slots = slots->m_next)
+                slots->release(thread);
+            unlock();
+        }
+
+        // Arranges for releaseThread() to be called when the calling thread exits
+        static void watchCurrentThread(size_t thread);
+
+        static std::atomic<bool>    s_locked;
+        static ThreadSlots*         s_head;
+    };
+
+    std::atomic<bool> ThreadSlotsRegistry::s_locked(false);
+    ThreadSlots* ThreadSlotsRegistry::s_head = nullptr;
+
+    // Thread exit callbacks are handed the thread's id, which is never 0, so they always run
+#if defined(WIN32) || defined(_WIN32)
+    static VOID NTAPI onThreadExit(PVOID thread)
+    {
+        ThreadSlotsRegistry::releaseThread(reinterpret_cast<size_t>(thread));
+    }
+
+    static const DWORD s_threadExitKey = FlsAlloc(&onThreadExit);
+
+    void ThreadSlotsRegistry::watchCurrentThread(size_t thread)
+    {
+        FlsSetValue(s_threadExitKey, reinterpret_cast<PVOID>(thread));
+    }
+#else
+    static void onThreadExit(void* thread)
+    {
+        ThreadSlotsRegistry::releaseThread(reinterpret_cast<size_t>(thread));
+    }
+
+    static pthread_key_t createThreadExitKey()
+    {
+        pthread_key_t key;
+        pthread_key_create(&key, &onThreadExit);
+        return key;
+    }
+
+    static const pthread_key_t s_threadExitKey = createThreadExitKey();
+
+    void ThreadSlotsRegistry::watchCurrentThread(size_t thread)
+    {
+        pthread_setspecific(s_threadExitKey, reinterpret_cast<void*>(thread));
+    }
+#endif
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // ThreadSlots impl
+
+    struct SlotCacheEntry
+    {
+        size_t  id;     // Of the ThreadSlots plus one, so 0 is empty
+        size_t  slot;
+    };
+
+    // Slots this thread has claimed, by ThreadSlots id. Ids are never reused, so stale entries are harmless
+    static DX_THREAD_LOCAL SlotCacheEntry   s_slotCache[THREAD_SLOT_CACHE_SIZE];
+    // What this thread's slots are owned as, 0 until it first claims one
+    static DX_THREAD_LOCAL size_t           s_thread = 0;
+
+    // Set up before main() rather than on first use, which VS2013 doesn't guard against racing threads
+    static std::atomic<size_t>              s_nextThreadSlotsId(0);
+    // 0 is reserved for "no owner", so ids start at 1. They're never reused, so a slot given back can't be mistaken as still ours
+    static std::atomic<size_t>              s_nextThreadId(1);
+
+    static size_t nextThreadSlotsId()
+    {
+        return s_nextThreadSlotsId.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static size_t nextThreadId()
+    {
+        return s_nextThreadId.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ThreadSlots::ThreadSlots(size_t numSlots)
+        : m_id(nextThreadSlotsId()), m_numSlots(numSlots), m_numRegions(0), m_regions(nullptr),
+        m_owners(new std::atomic<size_t>[numSlots]), m_previous(nullptr), m_next(nullptr)
+    {
+        const size_t nodes = Topology::numNodes();
+        m_numRegions = (numSlots < nodes ? numSlots : nodes);
+        if(m_numRegions == 0)
+            m_numRegions = 1;
+
+        m_regions.reset(new Region[m_numRegions]);
+        for(size_t i = 0; i < m_numRegions; ++i)
+        {
+            m_regions[i].begin = i * numSlots / m_numRegions;
+            m_regions[i].end = (i + 1) * numSlots / m_numRegions;
+        }
+
+        for(size_t i = 0; i < numSlots; ++i)
+            m_owners[i].store(0, std::memory_order_relaxed);
+        ThreadSlotsRegistry::add(this);
+    }
+
+    ThreadSlots::~ThreadSlots()
+    {
+        ThreadSlotsRegistry::remove(this);
+    }
+
+    size_t ThreadSlots::slot() const
+    {
+        SlotCacheEntry& cached = s_slotCache[m_id % THREAD_SLOT_CACHE_SIZE];
+        if(cached.id == m_id + 1)
+            return cached.slot;
+
+        if(s_thread == 0)
+        {
+            s_thread = nextThreadId();
+            ThreadSlotsRegistry::watchCurrentThread(s_thread);
+        }
+
+        // Either this is our first time here, or another ThreadSlots took our place in the cache
+        size_t slot = find(s_thread);
+        if(slot >= m_numSlots)
+            slot = claim(s_thread);
+        if(slot < m_numSlots)
+        {
+            cached.id = m_id + 1;
+            cached.slot = slot;
+        }
+        return slot;
+    }
+
+    size_t ThreadSlots::size() const
+    {
+        return m_numSlots;
+    }
+
+    size_t ThreadSlots::find(size_t thread) const
+    {
+        // Only we ever store our own id, so a relaxed load can only see it if the slot is ours
+        for(size_t i = 0; i < m_numSlots; ++i)
+        {
+            if(m_owners[i].load(std::memory_order_relaxed) == thread)
+                return i;
+        }
+        return m_numSlots;
+    }
+
+    size_t ThreadSlots::claim(size_t thread) const
+    {
+        const size_t home = Topology::currentNode() % m_numRegions;
+        for(size_t i = 0; i < m_numRegions; ++i)
+        {
+            const Region& region = m_regions[(home + i) % m_numRegions];
+            for(size_t slot = region.begin; slot < region.end; ++slot)
+            {
+                // Cheap check first so taken slots don't get their line hammered. Acquire pairs with release()
+                size_t expected = 0;
+                if(m_owners[slot].load(std::memory_order_relaxed) == 0 &&
+                    m_owners[slot].compare_exchange_strong(expected, thread, std::memory_order_acquire))
+                    return slot;
+            }
+        }
+        return m_numSlots;
+    }
+
+    void ThreadSlots::release(size_t thread)
+    {
+        for(size_t i = 0; i < m_numSlots; ++i)
+        {
+            if(m_owners[i].load(std::memory_order_relaxed) == thread)
+                m_owners[i].store(0, std::memory_order_release);
+        }
+    }
+
+}
+}
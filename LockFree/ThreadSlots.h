@@ -0,0 +1,106 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX LockFree - ThreadSlots hands every thread a stable, per-object slot index
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace DX {
+namespace LockFree {
+
+    struct ThreadSlotsRegistry;
+
+    //! Defines how many slots each thread remembers without searching. Arbitrary for now, best results TBD
+    #ifndef THREAD_SLOT_CACHE_SIZE
+        #define THREAD_SLOT_CACHE_SIZE 16
+    #endif
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // ThreadSlots
+
+    /*! \brief ThreadSlots gives each thread that touches it a slot index in [0, size()), which
+        stays the same for the lifetime of the ThreadSlots object. This is the building block for
+        structures that need per-thread state inside a shared object (tree barriers, flat combining
+        publication records, ...) without every thread having to be registered up front.
+
+        Slots are claimed topology-first: the slot range is split evenly across the NUMA nodes (see
+        Topology), and a thread prefers a slot from its own node's share. Threads on the same node
+        therefore end up with neighbouring slots. Once a node's share runs out, threads spill over
+        into the other shares.
+
+        The first call to slot() from a thread claims the slot, and later calls find it in a small
+        per-thread cache of THREAD_SLOT_CACHE_SIZE entries (one per ThreadSlots object, hashed by
+        object). A thread that uses more objects than that at once still keeps its slots - they just
+        cost a scan of the object's slots to find again. When a thread exits, every slot it holds is
+        given back, ready for the next thread to claim.
+
+        \note If more than size() threads hold slots at once, the extra threads receive size() as
+        an invalid slot until one of the others exits.
+    */
+    class ThreadSlots
+    {
+    public:
+        explicit ThreadSlots(size_t numSlots);
+        ~ThreadSlots();
+
+        /*! \return The calling thread's slot, claiming one if needed. size() if no slots are left. */
+        size_t  slot() const;
+        /*! \return The number of slots */
+        size_t  size() const;
+
+    private:
+        friend struct ThreadSlotsRegistry; // Gives slots back when threads exit
+
+        struct Region
+        {
+            size_t  begin;
+            size_t  end;
+        };
+
+        size_t  find(size_t thread) const;
+        size_t  claim(size_t thread) const;
+        void    release(size_t thread);
+
+        const size_t                                m_id;   // Unique across every ThreadSlots ever created
+        const size_t                                m_numSlots;
+        size_t                                      m_numRegions;
+        std::unique_ptr<Region[]>                   m_regions;
+        std::unique_ptr<std::atomic<size_t>[]>      m_owners; // The thread holding each slot, 0 if free
+        ThreadSlots*                                m_previous; // Every live ThreadSlots, see ThreadSlotsRegistry
+        ThreadSlots*                                m_next;
+
+        /*
+            Copy and move constructors are hidden to prevent the compiler from automatically generating
+            them for us. This class is currently NOT copyable or movable.
+        */
+        ThreadSlots(const ThreadSlots&);
+        ThreadSlots(ThreadSlots&&);
+    };
+
+}
+}
@@ -0,0 +1,244 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Topology.h"
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(WIN32) || defined(_WIN32)
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <fstream>
+    #include <sched.h>
+    #include <stdexcept>
+#endif
+
+namespace DX {
+namespace LockFree {
+namespace Topology {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Topology impl
+
+    struct TopologyMap
+    {
+        std::vector<size_t> processorToNode;
+        size_t              nodes;
+    };
+
+    // Maps whatever node ids the OS hands us onto 0..n-1, in ascending order of the OS ids
+    static void densifyNodes(TopologyMap& topology)
+    {
+        std::map<size_t, size_t> denseIds;
+        for(size_t node : topology.processorToNode)
+            denseIds[node] = 0;
+
+        size_t nextId = 0;
+        for(auto& idPair : denseIds)
+            idPair.second = nextId++;
+
+        for(size_t& node : topology.processorToNode)
+            node = denseIds[node];
+
+        topology.nodes = denseIds.empty() ? 1 : denseIds.size();
+    }
+
+#if defined(WIN32) || defined(_WIN32)
+
+    static bool discover(TopologyMap& topology)
+    {
+        ULONG highestNode = 0;
+        if(!GetNumaHighestNodeNumber(&highestNode) || highestNode == 0)
+            return false;
+
+        const size_t processors = std::thread::hardware_concurrency();
+        for(size_t processor = 0; processor < processors && processor <= 0xFF; ++processor)
+        {
+            UCHAR node = 0;
+            if(!GetNumaProcessorNode(static_cast<UCHAR>(processor), &node) || node == 0xFF)
+                node = 0;
+            topology.processorToNode.push_back(node);
+        }
+
+        return !topology.processorToNode.empty();
+    }
+
+#elif defined(__linux__)
+
+    // Parses the sysfs list format, ie: "0-3,8-11,16"
+    static std::vector<size_t> parseList(const std::string& list)
+    {
+        std::vector<size_t> ret;
+        size_t position = 0;
+        while(position < list.size())
+        {
+            size_t end = list.find(',', position);
+            if(end == std::string::npos)
+                end = list.size();
+
+            const std::string range = list.substr(position, end - position);
+            const size_t dash = range.find('-');
+            if(!range.empty())
+            {
+                const size_t first = std::stoul(range.substr(0, dash));
+                const size_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+                for(size_t i = first; i <= last; ++i)
+                    ret.push_back(i);
+            }
+            position = end + 1;
+        }
+        return ret;
+    }
+
+    static bool readLine(const std::string& path, std::string& out)
+    {
+        std::ifstream file(path.c_str());
+        if(!file)
+            return false;
+        std::getline(file, out);
+        return true;
+    }
+
+    static bool discover(TopologyMap& topology)
+    {
+        static const std::string nodeRoot("/sys/devices/system/node/");
+
+        std::string onlineNodes;
+        if(!readLine(nodeRoot + "online", onlineNodes))
+            return false;
+
+        try
+        {
+            for(size_t node : parseList(onlineNodes))
+            {
+                std::string processors;
+                if(!readLine(nodeRoot + "node" + std::to_string(node) + "/cpulist", processors))
+                    continue;
+
+                for(size_t processor : parseList(processors))
+                {
+                    if(processor >= topology.processorToNode.size())
+                        topology.processorToNode.resize(processor + 1, node);
+                    topology.processorToNode[processor] = node;
+                }
+            }
+        }
+        catch(const std::exception&)
+        {
+            // sysfs handed us something we don't understand. Pretend we never looked
+            topology.processorToNode.clear();
+            return false;
+        }
+
+        return !topology.processorToNode.empty();
+    }
+
+#else
+
+    static bool discover(TopologyMap&)
+    {
+        return false;
+    }
+
+#endif
+
+    static TopologyMap buildTopology()
+    {
+        TopologyMap topology;
+        if(!discover(topology))
+        {
+            // Fallback - the whole machine is one big node
+            const size_t processors = std::thread::hardware_concurrency();
+            topology.processorToNode.assign(processors > 0 ? processors : 1, 0);
+        }
+        densifyNodes(topology);
+        return topology;
+    }
+
+    /*
+        Built on first use, which can come from another static initializer, so neither is given an
+        initializer of its own: zero initialization leaves them unlocked and empty before anything
+        runs. A function static wouldn't do, VS2013 doesn't guard their initialization.
+    */
+    static std::atomic<bool>                s_topologyLock;
+    static std::atomic<const TopologyMap*>  s_topology;
+
+    static const TopologyMap& getTopologySingleton()
+    {
+        const TopologyMap* topology = s_topology.load(std::memory_order_acquire);
+        if(topology)
+            return *topology;
+
+        while(s_topologyLock.exchange(true, std::memory_order_acquire))
+            std::this_thread::yield();
+        topology = s_topology.load(std::memory_order_relaxed);
+        if(!topology)
+        {
+            // Never freed, anything may ask for it right up to exit
+            topology = new TopologyMap(buildTopology());
+            s_topology.store(topology, std::memory_order_release);
+        }
+        s_topologyLock.store(false, std::memory_order_release);
+        return *topology;
+    }
+
+    size_t numNodes()
+    {
+        return getTopologySingleton().nodes;
+    }
+
+    size_t numProcessors()
+    {
+        return getTopologySingleton().processorToNode.size();
+    }
+
+    size_t currentProcessor()
+    {
+        #if defined(WIN32) || defined(_WIN32)
+            return GetCurrentProcessorNumber();
+        #elif defined(__linux__)
+            const int processor = sched_getcpu();
+            return processor < 0 ? 0 : size_t(processor);
+        #else
+            return 0;
+        #endif
+    }
+
+    size_t nodeOfProcessor(size_t processor)
+    {
+        const TopologyMap& topology = getTopologySingleton();
+        return processor < topology.processorToNode.size() ? topology.processorToNode[processor] : 0;
+    }
+
+    size_t currentNode()
+    {
+        const TopologyMap& topology = getTopologySingleton();
+        if(topology.nodes == 1)
+            return 0;
+        return nodeOfProcessor(currentProcessor());
+    }
+
+}
+}
+}
@@ -0,0 +1,76 @@
+/* /////////////////////////////////////////////////////////////////////////////////////////////////
+    DX LockFree - A high-level RAII concurrency library designed for fast and easy use
+    Copyright(C) 2014 Eli Pinkerton
+
+    This library is free software; you can redistribute it and / or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or(at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
+*/ /////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DX LockFree - Topology describes which NUMA node each logical processor belongs to
+// Author: Eli Pinkerton
+// Date: 10/19/26
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstddef>
+
+namespace DX {
+namespace LockFree {
+namespace Topology {
+
+    /*! \brief Topology is a read-only view of the memory layout of the machine, discovered once on
+        first use. On Linux the NUMA nodes are read from /sys/devices/system/node, on WIN32 they are
+        queried from the NUMA API. If neither is available (or discovery fails for any reason), the
+        machine is treated as a single node that contains every processor.
+
+        Node indices are dense, ranging from 0 to numNodes() - 1, even if the operating system
+        reports sparse node ids.
+
+        \code
+        std::vector<SpinMutex> perNodeMutexes(Topology::numNodes());
+
+        void touchLocalData()
+        {
+            SpinLock _lock(perNodeMutexes[Topology::currentNode()]);
+            // Work on data that lives on this thread's node
+        }
+        \endcode
+    */
+
+    /*! \return The number of NUMA nodes on the machine. Always at least 1. */
+    size_t  numNodes();
+
+    /*! \return The number of logical processors that Topology knows about. Always at least 1. */
+    size_t  numProcessors();
+
+    /*! \return The logical processor the calling thread is currently running on.
+        \note   Threads may migrate at any time, so treat this as a hint rather than a guarantee.
+    */
+    size_t  currentProcessor();
+
+    /*! \return The dense node index that some logical processor belongs to. Processors that are
+        unknown to Topology are reported as belonging to node 0.
+    */
+    size_t  nodeOfProcessor(size_t processor);
+
+    /*! \return The dense node index of the node the calling thread is currently running on.
+        \note   Same caveat as currentProcessor() - this is a hint.
+    */
+    size_t  currentNode();
+
+}
+}
+}
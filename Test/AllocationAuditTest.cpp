@@ -0,0 +1,98 @@
+#include "Benchmark.h"
+
+#include <Audio/AllocationAudit.h>
+#include <Audio/AudioPacket.h>
+#include <Audio/AudioPacketPool.h>
+
+#include <cstdio>
+
+using namespace DX::Audio;
+
+static std::atomic<size_t> s_reported(0);
+
+// Tests count violations rather than abort on them
+static void countOnly(size_t)
+{
+    s_reported.fetch_add(1);
+}
+
+// Stored through a volatile pointer so the compiler can't leave the allocation out
+static void allocate()
+{
+    int* volatile memory = new int(0);
+    delete memory;
+}
+
+static bool check(bool passed, const char* what)
+{
+    std::printf("  %-66s %s\n", what, passed ? "ok" : "FAILED");
+    return passed;
+}
+
+bool testAllocationAudit()
+{
+    if(!AllocationAudit::isEnabled())
+    {
+        skipTest("DXAudio was built without DX_AUDIT_ALLOCATIONS");
+        return true;
+    }
+
+    std::printf("AllocationAudit\n");
+    AllocationAudit::setViolationHandler(&countOnly);
+    AllocationAudit::resetCounters();
+    bool passed = true;
+
+    allocate();
+    passed = check(AllocationAudit::allocations() > 0 && AllocationAudit::violations() == 0,
+        "Allocating off a realtime thread is counted, not reported") && passed;
+
+    {
+        AllocationAudit::RealtimeScope scope;
+        allocate();
+    }
+    passed = check(AllocationAudit::violations() == 1 && s_reported.load() == 1,
+        "Allocating inside a RealtimeScope is reported") && passed;
+
+    {
+        AllocationAudit::RealtimeScope scope(false);
+        allocate();
+    }
+    passed = check(AllocationAudit::violations() == 1, "Unarmed scopes report nothing") && passed;
+
+    {
+        AllocationAudit::RealtimeScope outer;
+        {
+            AllocationAudit::RealtimeScope inner;
+        }
+        allocate();
+    }
+    passed = check(AllocationAudit::violations() == 2 && !AllocationAudit::isRealtimeThread(),
+        "Scopes nest, and the thread is realtime until the outermost ends") && passed;
+
+    // The steady state of a stream: once the pool has seen every size, packets come and go for free
+    std::shared_ptr<AudioPacketPool> pool = AudioPacketPool::create();
+    AudioFormat format;
+    format.channels = 2;
+    format.samplesPerSecond = 48000;
+    format.bitsPerSample = 32;
+    format.bitsPerBlock = 8;
+    format.encoding = FLOAT32;
+
+    static const size_t PACKET_BYTES = 480 * 8;
+    const std::vector<AudioByte> samples(PACKET_BYTES, 0);
+    pool->reserve(PACKET_BYTES, 1);
+
+    AllocationAudit::resetCounters();
+    {
+        AllocationAudit::RealtimeScope scope;
+        for(size_t i = 0; i < 1000; ++i)
+        {
+            AudioPacket packet = pool->acquire(format, PACKET_BYTES);
+            packet.assign(samples.data(), PACKET_BYTES);
+        }
+    }
+    passed = check(AllocationAudit::violations() == 0, "A warmed up AudioPacketPool never allocates") && passed;
+
+    AllocationAudit::setViolationHandler(nullptr);
+    return passed;
+}
@@ -0,0 +1,105 @@
+#include "Benchmark.h"
+
+#include <LockFree/Mutex/CombiningTreeBarrier.h>
+#include <LockFree/Mutex/CyclicSpinBarrier.h>
+#include <LockFree/Mutex/SenseReversingBarrier.h>
+//#include <DX/LockFree/Mutex/CombiningTreeBarrier.h>
+//#include <DX/LockFree/Mutex/CyclicSpinBarrier.h>
+//#include <DX/LockFree/Mutex/SenseReversingBarrier.h>
+
+#include <cstdio>
+
+using namespace DX::LockFree;
+
+// Spread over the threads, so oversubscribed runs don't take forever
+static const size_t TOTAL_ARRIVALS = 64000;
+// How long sleeping tests wait for a phase to complete before deciding a wakeup was lost
+static const double STALL_SECONDS = 10.0;
+
+/*
+    Every thread goes through the barrier phase after phase. Nobody may leave a phase before
+    everyone has arrived in it, which is checked with a count of arrivals made so far.
+    SpinBarrier is left out, as it isn't reusable.
+*/
+template <typename BarrierType>
+static bool phases(const char* name, size_t numThreads)
+{
+    BarrierType barrier(numThreads);
+    const size_t numPhases = TOTAL_ARRIVALS / numThreads;
+    std::atomic<size_t> arrivals(0);
+    std::atomic<bool> passed(true);
+    const double seconds = runThreads(numThreads, [&](size_t)
+    {
+        for(size_t phase = 0; phase < numPhases; ++phase)
+        {
+            arrivals.fetch_add(1);
+            barrier.wait();
+            if(arrivals.load() < (phase + 1) * numThreads)
+                passed.store(false);
+        }
+    });
+
+    std::printf("  %-22s %4u threads: %10.1f ns/phase\n", name, unsigned(numThreads),
+        seconds * 1e9 / double(numPhases));
+    return passed.load();
+}
+
+bool benchmarkBarriers()
+{
+    std::printf("CombiningTreeBarrier against the flat barriers, %u hardware threads\n",
+        std::thread::hardware_concurrency());
+
+    static const size_t THREAD_COUNTS[] = { 8, 32, 128 };
+    bool passed = true;
+    for(size_t numThreads : THREAD_COUNTS)
+    {
+        passed = phases<CyclicSpinBarrier>("CyclicSpinBarrier", numThreads) && passed;
+        passed = phases<SenseReversingBarrier>("SenseReversingBarrier", numThreads) && passed;
+        passed = phases<CombiningTreeBarrier>("CombiningTreeBarrier", numThreads) && passed;
+    }
+    return passed;
+}
+
+/*
+    Phases through barrier with maxSpins of 0, so every waiter goes to sleep (see Futex) and every
+    phase races its last arrival's wakeup against the waiters still on their way to sleep. A lost
+    wakeup leaves a thread asleep for good, which the watchdog reports.
+*/
+template <typename BarrierType>
+static bool sleepThrough(BarrierType& barrier, const char* name, size_t numThreads)
+{
+    const size_t numPhases = TOTAL_ARRIVALS / numThreads;
+    std::atomic<size_t> arrivals(0);
+    std::atomic<bool> passed(true);
+    const double seconds = runThreadsWatched(numThreads, arrivals, STALL_SECONDS, [&](size_t)
+    {
+        for(size_t phase = 0; phase < numPhases; ++phase)
+        {
+            arrivals.fetch_add(1);
+            barrier.wait();
+            if(arrivals.load() < (phase + 1) * numThreads)
+                passed.store(false);
+        }
+    });
+
+    std::printf("  %-22s %4u threads: %10.1f ns/phase, never spinning\n", name, unsigned(numThreads),
+        seconds * 1e9 / double(numPhases));
+    return passed.load();
+}
+
+bool testSleepingBarriers()
+{
+    std::printf("Futex backed barriers with every waiter sleeping\n");
+
+    bool passed = true;
+    const std::vector<size_t> levels = contentionLevels();
+    for(size_t numThreads : levels)
+    {
+        SenseReversingBarrier senseReversing(numThreads, 0);
+        passed = sleepThrough(senseReversing, "SenseReversingBarrier", numThreads) && passed;
+
+        CombiningTreeBarrier combiningTree(numThreads, DEFAULT_BARRIER_FAN_IN, 0);
+        passed = sleepThrough(combiningTree, "CombiningTreeBarrier", numThreads) && passed;
+    }
+    return passed;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/*
+    Tests and benchmarks DXTest can run by name, see main.cpp. Each prints what it measured and
+    returns false if anything it checked along the way came out wrong.
+*/
+bool benchmarkCohortMutex();
+bool benchmarkRecursiveMutex();
+bool benchmarkBarriers();
+bool testSleepingBarriers();
+bool testPhaser();
+bool benchmarkFlatCombining();
+bool testAllocationAudit();
+bool testResampler();
+bool testFilterGraph();
+bool benchmarkBiquadCascade();
+bool benchmarkConvolution();
+
+/*
+    For a test with nothing it can check in this build: it's reported as skipped rather than passed.
+    The test should still return true.
+*/
+void skipTest(const char* reason);
+
+//! Seconds since an arbitrary, fixed point
+inline double secondsNow()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+    Runs function(threadIndex) on numThreads threads at once. The threads are all created before
+    any of them starts, so only the work itself is timed.
+    \return Seconds from the threads starting to the last of them finishing
+*/
+template <typename Function>
+double runThreads(size_t numThreads, Function function)
+{
+    std::atomic<size_t> numReady(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < numThreads; ++i)
+    {
+        threads.push_back(std::thread([&, i]()
+        {
+            numReady.fetch_add(1);
+            while(!go.load())
+                std::this_thread::yield();
+            function(i);
+        }));
+    }
+
+    while(numReady.load() != numThreads)
+        std::this_thread::yield();
+    const double start = secondsNow();
+    go.store(true);
+    for(std::thread& thread : threads)
+        thread.join();
+    return secondsNow() - start;
+}
+
+/*
+    runThreads() for tests where a bug shows up as threads blocked for good, such as a lost wakeup.
+    function bumps progress as it goes; if progress stands still for stallSeconds, the test reports
+    it and aborts, as threads stuck in a wait can't be joined.
+*/
+template <typename Function>
+double runThreadsWatched(size_t numThreads, const std::atomic<size_t>& progress, double stallSeconds,
+    Function function)
+{
+    std::atomic<bool> finished(false);
+    std::thread watchdog([&]()
+    {
+        size_t last = progress.load();
+        double lastChange = secondsNow();
+        while(!finished.load())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            const size_t current = progress.load();
+            if(current != last)
+            {
+                last = current;
+                lastChange = secondsNow();
+            }
+            else if(secondsNow() - lastChange > stallSeconds)
+            {
+                std::printf("  No progress in %.0f seconds at %u, threads are stuck\n", stallSeconds, unsigned(current));
+                std::fflush(stdout);
+                std::abort();
+            }
+        }
+    });
+
+    const double seconds = runThreads(numThreads, function);
+    finished.store(true);
+    watchdog.join();
+    return seconds;
+}
+
+//! Thread counts worth measuring at: 2, the number of hardware threads, and twice that
+inline std::vector<size_t> contentionLevels()
+{
+    const size_t hardware = std::max(2u, std::thread::hardware_concurrency());
+    std::vector<size_t> levels;
+    levels.push_back(2);
+    if(hardware > 2)
+        levels.push_back(hardware);
+    levels.push_back(2 * hardware);
+    return levels;
+}
@@ -0,0 +1,72 @@
+#include "Benchmark.h"
+
+#include <LockFree/Mutex/CohortMutex.h>
+#include <LockFree/Mutex/SpinMutex.h>
+#include <LockFree/Topology.h>
+//#include <DX/LockFree/Mutex/CohortMutex.h>
+//#include <DX/LockFree/Mutex/SpinMutex.h>
+//#include <DX/LockFree/Topology.h>
+
+#include <cstdio>
+
+using namespace DX::LockFree;
+
+static const size_t LOCKS_PER_THREAD = 200000;
+
+// What the critical section guards: a counter, and which node touched it last
+struct GuardedCounter
+{
+    size_t  count;
+    size_t  lastNode;
+    size_t  crossNodeHandoffs;
+};
+
+/*
+    Every thread takes the lock LOCKS_PER_THREAD times. A handoff counts as cross node when the new
+    owner runs on a different node from the last one, which is when the guarded data (and the lock)
+    have to move between sockets.
+*/
+template <typename MutexType>
+static bool contend(const MutexType& mutex, const char* name, size_t numThreads)
+{
+    GuardedCounter counter = { 0, 0, 0 };
+    const double seconds = runThreads(numThreads, [&](size_t)
+    {
+        for(size_t i = 0; i < LOCKS_PER_THREAD; ++i)
+        {
+            mutex.lock();
+            const size_t node = Topology::currentNode();
+            if(node != counter.lastNode)
+                ++counter.crossNodeHandoffs;
+            counter.lastNode = node;
+            ++counter.count;
+            mutex.unlock();
+        }
+    });
+
+    const size_t total = numThreads * LOCKS_PER_THREAD;
+    std::printf("  %-12s %4u threads: %8.1f ns/lock, %9u cross node handoffs (%.2f%%)\n", name,
+        unsigned(numThreads), seconds * 1e9 / double(total), unsigned(counter.crossNodeHandoffs),
+        100.0 * double(counter.crossNodeHandoffs) / double(total));
+    return counter.count == total;
+}
+
+bool benchmarkCohortMutex()
+{
+    std::printf("CohortMutex against SpinMutex, %u NUMA node(s), %u processors\n", unsigned(Topology::numNodes()),
+        unsigned(Topology::numProcessors()));
+
+    bool passed = true;
+    const std::vector<size_t> levels = contentionLevels();
+    for(size_t numThreads : levels)
+    {
+        SpinMutex spinMutex;
+        passed = contend(spinMutex, "SpinMutex", numThreads) && passed;
+
+        CohortMutex cohortMutex;
+        passed = contend(cohortMutex, "CohortMutex", numThreads) && passed;
+        std::printf("  %-12s %4u threads: %9u global acquisitions, %9u local handoffs\n", "", unsigned(numThreads),
+            unsigned(cohortMutex.globalAcquisitions()), unsigned(cohortMutex.localHandoffs()));
+    }
+    return passed;
+}
@@ -0,0 +1,181 @@
+#include "Benchmark.h"
+
+#include <Audio/AudioPacket.h>
+#include <Audio/Filters/Convolution.h>
+
+#include <cmath>
+#include <cstdio>
+
+using namespace DX::Audio;
+
+static const unsigned int SAMPLE_RATE = 48000;
+
+// Largest difference from direct convolution in double precision, on noise of +-0.5 through responses of unit energy
+static const double MAX_ERROR = 1e-4;
+
+static AudioFormat floatFormat(unsigned short channels)
+{
+    AudioFormat format;
+    format.channels = channels;
+    format.samplesPerSecond = SAMPLE_RATE;
+    format.bitsPerSample = 32;
+    format.bitsPerBlock = 4 * channels;
+    format.encoding = FLOAT32;
+    format.layout = INTERLEAVED;
+    return format;
+}
+
+// Deterministic noise in [-0.5, 0.5), so runs compare like for like
+static float noise(unsigned int& seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return float(seed >> 8) / float(1u << 24) - 0.5f;
+}
+
+// Decaying noise, like a room's response, scaled to unit energy. Different for every seed.
+static std::vector<std::vector<float>> responses(size_t count, size_t length)
+{
+    std::vector<std::vector<float>> ret(count, std::vector<float>(length));
+    unsigned int seed = 7;
+    for(std::vector<float>& response : ret)
+    {
+        double energy = 0.0;
+        for(size_t i = 0; i < length; ++i)
+        {
+            response[i] = noise(seed) * float(std::exp(-4.0 * double(i) / double(length)));
+            energy += double(response[i]) * response[i];
+        }
+        const float scale = float(1.0 / std::sqrt(energy));
+        for(float& tap : response)
+            tap *= scale;
+    }
+    return ret;
+}
+
+/*
+    Streams noise through convolution in packets that don't line up with its blocks, and through
+    each response directly in double precision, one block later.
+    \return The largest difference between the two
+*/
+static double referenceError(const std::vector<std::vector<float>>& impulseResponses, size_t blockSize,
+    ConvolutionMode mode)
+{
+    static const size_t NUM_FRAMES = 16000;
+    static const size_t PACKET_FRAMES = 100;
+
+    const size_t channels = impulseResponses.size();
+    Convolution convolution(impulseResponses, blockSize, mode);
+    const std::shared_ptr<FilterProcessor> processor = convolution.createProcessor();
+    const AudioFormat format = floatFormat(static_cast<unsigned short>(channels));
+
+    std::vector<float> input(NUM_FRAMES * channels);
+    unsigned int seed = 1;
+    for(float& sample : input)
+        sample = noise(seed);
+
+    std::vector<float> output;
+    for(size_t frame = 0; frame < NUM_FRAMES; frame += PACKET_FRAMES)
+    {
+        const size_t bytes = PACKET_FRAMES * channels * sizeof(float);
+        AudioPacket in(format, bytes);
+        in.assign(&input[frame * channels], bytes);
+        AudioPacket out(format, bytes);
+        if(!processor->process(in, out))
+            return HUGE_VAL;
+        const float* produced = reinterpret_cast<const float*>(out.data());
+        output.insert(output.end(), produced, produced + out.byteSize() / sizeof(float));
+    }
+
+    const size_t latency = convolution.latency();
+    double maxError = 0.0;
+    for(size_t channel = 0; channel < channels; ++channel)
+    {
+        const std::vector<float>& response = impulseResponses[channel];
+        for(size_t frame = latency; frame < NUM_FRAMES; ++frame)
+        {
+            double expected = 0.0;
+            const size_t taps = std::min(response.size(), frame - latency + 1);
+            for(size_t k = 0; k < taps; ++k)
+                expected += double(response[k]) * input[(frame - latency - k) * channels + channel];
+            maxError = std::max(maxError, std::fabs(expected - output[frame * channels + channel]));
+        }
+    }
+    return maxError;
+}
+
+struct BlockCost
+{
+    double  average; // Seconds per block
+    double  heaviest; // Seconds per block, of the heaviest block of the tail's period, on average
+};
+
+/*
+    Times convolution a block at a time. Blocks are grouped by where they fall in the tail's period,
+    so the heaviest of the period shows through the noise of any one block.
+*/
+static BlockCost blockCost(const std::vector<std::vector<float>>& impulseResponses, size_t blockSize,
+    ConvolutionMode mode, size_t numPeriods)
+{
+    const size_t period = CONVOLUTION_TAIL_BLOCKS;
+    const size_t channels = impulseResponses.size();
+    Convolution convolution(impulseResponses, blockSize, mode);
+    const std::shared_ptr<FilterProcessor> processor = convolution.createProcessor();
+
+    std::vector<float> samples(blockSize * channels);
+    unsigned int seed = 1;
+    for(float& sample : samples)
+        sample = noise(seed);
+    AudioPacket packet(floatFormat(static_cast<unsigned short>(channels)), samples.size() * sizeof(float));
+    packet.assign(samples.data(), samples.size() * sizeof(float));
+
+    // A period to settle in, then every block timed on its own
+    for(size_t block = 0; block < period; ++block)
+        processor->processInPlace(makeSampleSpan<float>(packet));
+
+    std::vector<double> byStep(period, 0.0);
+    double total = 0.0;
+    for(size_t block = 0; block < numPeriods * period; ++block)
+    {
+        const double start = secondsNow();
+        processor->processInPlace(makeSampleSpan<float>(packet));
+        const double elapsed = secondsNow() - start;
+        byStep[block % period] += elapsed;
+        total += elapsed;
+    }
+
+    BlockCost cost;
+    cost.average = total / double(numPeriods * period);
+    cost.heaviest = *std::max_element(byStep.begin(), byStep.end()) / double(numPeriods);
+    return cost;
+}
+
+bool benchmarkConvolution()
+{
+    bool passed = true;
+
+    // Long enough for a tail at a 64 frame block, short enough to check directly
+    std::printf("Convolution against direct convolution, 4 channels of 5000 taps, 64 frame blocks\n");
+    const std::vector<std::vector<float>> shortResponses = responses(4, 5000);
+    const double uniformError = referenceError(shortResponses, 64, CONVOLUTION_UNIFORM);
+    const double nonUniformError = referenceError(shortResponses, 64, CONVOLUTION_NON_UNIFORM);
+    std::printf("  %-12s largest error %.2e\n", "uniform", uniformError);
+    std::printf("  %-12s largest error %.2e\n", "non-uniform", nonUniformError);
+    passed = uniformError <= MAX_ERROR && nonUniformError <= MAX_ERROR;
+
+    static const size_t CHANNELS = 32;
+    static const size_t TAPS = 65536;
+    static const size_t BLOCK_SIZE = 256;
+    static const size_t PERIODS = 20;
+    std::printf("Convolution cost, %u channels of %u taps, %u frame blocks (%.2f ms of audio each)\n",
+        unsigned(CHANNELS), unsigned(TAPS), unsigned(BLOCK_SIZE), 1e3 * double(BLOCK_SIZE) / SAMPLE_RATE);
+    const std::vector<std::vector<float>> longResponses = responses(CHANNELS, TAPS);
+    const BlockCost uniform = blockCost(longResponses, BLOCK_SIZE, CONVOLUTION_UNIFORM, PERIODS);
+    const BlockCost nonUniform = blockCost(longResponses, BLOCK_SIZE, CONVOLUTION_NON_UNIFORM, PERIODS);
+    std::printf("  %-12s %6.3f ms per block on average, %6.3f ms in the heaviest\n", "uniform",
+        1e3 * uniform.average, 1e3 * uniform.heaviest);
+    std::printf("  %-12s %6.3f ms per block on average, %6.3f ms in the heaviest\n", "non-uniform",
+        1e3 * nonUniform.average, 1e3 * nonUniform.heaviest);
+    std::printf("  non-uniform is %.1fx faster on average, %.1fx in the heaviest block\n",
+        uniform.average / nonUniform.average, uniform.heaviest / nonUniform.heaviest);
+    return passed;
+}
@@ -0,0 +1,127 @@
+#include "Benchmark.h"
+
+#include <Audio/AudioPacket.h>
+#include <Audio/Filters/BiquadCascade.h>
+#include <Audio/Filters/FilterGraph.h>
+
+#include <cmath>
+#include <cstdio>
+
+using namespace DX::Audio;
+
+static const unsigned int SAMPLE_RATE = 48000;
+static const unsigned short NUM_CHANNELS = 8;
+static const size_t PACKET_FRAMES = 256;
+static const size_t NUM_BRANCHES = 4;
+// Every packet crosses the workers' barrier twice per parallel level, so this is tens of thousands of waits
+static const size_t NUM_PACKETS = 5000;
+// How long a packet may take before the test decides the graph's threads are stuck
+static const double STALL_SECONDS = 10.0;
+
+static AudioFormat floatFormat()
+{
+    AudioFormat format;
+    format.channels = NUM_CHANNELS;
+    format.samplesPerSecond = SAMPLE_RATE;
+    format.bitsPerSample = 32;
+    format.bitsPerBlock = 4 * NUM_CHANNELS;
+    format.encoding = FLOAT32;
+    format.layout = INTERLEAVED;
+    return format;
+}
+
+/*
+    The input split into NUM_BRANCHES equalizers, each followed by a second stage, and mixed back
+    together - two levels NUM_BRANCHES wide for the workers to share
+*/
+static void build(FilterGraph& graph)
+{
+    const float rate = float(SAMPLE_RATE);
+    std::vector<FilterGraph::NodeId> branches;
+    for(size_t branch = 0; branch < NUM_BRANCHES; ++branch)
+    {
+        const float frequency = 200.0f * float(branch + 1);
+        std::shared_ptr<BiquadCascade> equalizer = std::make_shared<BiquadCascade>(NUM_CHANNELS, 2);
+        equalizer->setCoefficients(0, BiquadCoefficients::peaking(rate, frequency, 1.0f, 6.0f));
+        equalizer->setCoefficients(1, BiquadCoefficients::lowPass(rate, 8.0f * frequency));
+
+        std::shared_ptr<BiquadCascade> shelf = std::make_shared<BiquadCascade>(NUM_CHANNELS, 1);
+        shelf->setCoefficients(0, BiquadCoefficients::highShelf(rate, 4000.0f, -3.0f));
+
+        const FilterGraph::NodeId equalized = graph.addFilter(equalizer, graph.input());
+        branches.push_back(graph.addFilter(shelf, equalized));
+    }
+    graph.addMix(branches, std::vector<float>(NUM_BRANCHES, 1.0f / float(NUM_BRANCHES)));
+}
+
+/*
+    Streams NUM_PACKETS packets of a sweep through graph, bumping progress after each.
+    \return Every sample that came out, or nothing if a packet failed
+*/
+static std::vector<float> stream(const FilterGraph& graph, std::atomic<size_t>& progress)
+{
+    const std::shared_ptr<FilterProcessor> processor = graph.createProcessor();
+    const AudioFormat format = floatFormat();
+    std::vector<float> samples(PACKET_FRAMES * NUM_CHANNELS);
+    std::vector<float> output;
+    output.reserve(NUM_PACKETS * samples.size());
+    for(size_t packet = 0; packet < NUM_PACKETS; ++packet)
+    {
+        for(size_t i = 0; i < samples.size(); ++i)
+        {
+            const double frame = double(packet * PACKET_FRAMES + i / NUM_CHANNELS);
+            samples[i] = float(0.5 * std::sin(frame * frame * 1e-7 + double(i % NUM_CHANNELS)));
+        }
+
+        AudioPacket in(format, samples.size() * sizeof(float));
+        in.assign(samples.data(), samples.size() * sizeof(float));
+        AudioPacket out(format, samples.size() * sizeof(float));
+        if(!processor->process(in, out))
+            return std::vector<float>();
+
+        const float* produced = reinterpret_cast<const float*>(out.data());
+        output.insert(output.end(), produced, produced + out.byteSize() / sizeof(float));
+        progress.fetch_add(1);
+    }
+    return output;
+}
+
+bool testFilterGraph()
+{
+    std::printf("FilterGraph, %u branches of %u channels, %u packets of %u frames\n", unsigned(NUM_BRANCHES),
+        unsigned(NUM_CHANNELS), unsigned(NUM_PACKETS), unsigned(PACKET_FRAMES));
+
+    std::atomic<size_t> progress(0);
+    FilterGraph single;
+    build(single);
+    std::vector<float> expected;
+    runThreadsWatched(1, progress, STALL_SECONDS, [&](size_t)
+    {
+        expected = stream(single, progress);
+    });
+    if(expected.empty())
+    {
+        std::printf("  One thread: a packet failed\n");
+        return false;
+    }
+
+    // Every node runs the same code whichever thread it lands on, so the output has to match exactly
+    static const size_t THREAD_COUNTS[] = { 2, NUM_BRANCHES };
+    bool passed = true;
+    for(size_t numThreads : THREAD_COUNTS)
+    {
+        FilterGraph threaded(numThreads);
+        build(threaded);
+        std::vector<float> output;
+        const double seconds = runThreadsWatched(1, progress, STALL_SECONDS, [&](size_t)
+        {
+            output = stream(threaded, progress);
+        });
+
+        const bool matches = (output == expected);
+        std::printf("  %u threads: %8.1f us/packet, %s one thread's output\n", unsigned(numThreads),
+            seconds * 1e6 / double(NUM_PACKETS), matches ? "matches" : "DIFFERS from");
+        passed = matches && passed;
+    }
+    return passed;
+}
@@ -0,0 +1,145 @@
+#include "Benchmark.h"
+
+#include <LockFree/Containers/ConcurrentQueue.h>
+#include <LockFree/Containers/FlatCombining.h>
+#include <LockFree/Mutex/SpinMutex.h>
+//#include <DX/LockFree/Containers/ConcurrentQueue.h>
+//#include <DX/LockFree/Containers/FlatCombining.h>
+//#include <DX/LockFree/Mutex/SpinMutex.h>
+
+#include <cstdio>
+#include <queue>
+
+using namespace DX::LockFree;
+
+static const size_t OPERATIONS_PER_THREAD = 100000;
+
+// What every thread pushed and popped, so nothing going missing or turning up twice shows
+struct Tally
+{
+    std::atomic<size_t> pushed;
+    std::atomic<size_t> popped;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// The contenders, each a push and a pop over the same interface
+
+// The two-lock (Michael and Scott) queue: pushes and pops take separate locks
+struct TwoLockQueue
+{
+    ConcurrentQueue<size_t> queue;
+
+    void push(size_t value) { queue.push(value); }
+    bool pop(size_t& value) { return queue.pop(value); }
+};
+
+// A heap has no separate ends to lock, so the lock based equivalent is one lock around it all
+struct LockedPriorityQueue
+{
+    SpinMutex                   mutex;
+    std::priority_queue<size_t> queue;
+
+    void push(size_t value)
+    {
+        SpinLock lock(mutex);
+        queue.push(value);
+    }
+
+    bool pop(size_t& value)
+    {
+        SpinLock lock(mutex);
+        if(queue.empty())
+            return false;
+        value = queue.top();
+        queue.pop();
+        return true;
+    }
+};
+
+template <typename Container>
+struct CombinedContainer
+{
+    FlatCombining<Container> combined;
+
+    void push(size_t value)
+    {
+        combined.apply([value](Container& container) { container.push(value); });
+    }
+
+    bool pop(size_t& value)
+    {
+        bool popped = false;
+        combined.apply([&](Container& container)
+        {
+            if(container.empty())
+                return;
+            value = front(container);
+            container.pop();
+            popped = true;
+        });
+        return popped;
+    }
+
+    static size_t front(const std::queue<size_t>& queue) { return queue.front(); }
+    static size_t front(const std::priority_queue<size_t>& queue) { return queue.top(); }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmark
+
+/*
+    Every thread pushes and pops in turn, so the container stays small and every operation is
+    contended. Values pushed are summed, as are values popped, and whatever is left at the end.
+*/
+template <typename Contender>
+static bool pushAndPop(const char* name, size_t numThreads)
+{
+    Contender contender;
+    Tally tally = {};
+    const double seconds = runThreads(numThreads, [&](size_t thread)
+    {
+        size_t pushed = 0;
+        size_t popped = 0;
+        for(size_t i = 0; i < OPERATIONS_PER_THREAD; ++i)
+        {
+            const size_t value = thread * OPERATIONS_PER_THREAD + i;
+            contender.push(value);
+            pushed += value;
+
+            size_t out = 0;
+            if(contender.pop(out))
+                popped += out;
+        }
+        tally.pushed.fetch_add(pushed);
+        tally.popped.fetch_add(popped);
+    });
+
+    size_t out = 0;
+    size_t remaining = 0;
+    while(contender.pop(out))
+        remaining += out;
+
+    const size_t total = 2 * numThreads * OPERATIONS_PER_THREAD;
+    std::printf("  %-30s %4u threads: %8.1f ns/operation\n", name, unsigned(numThreads),
+        seconds * 1e9 / double(total));
+    return tally.pushed.load() == tally.popped.load() + remaining;
+}
+
+bool benchmarkFlatCombining()
+{
+    std::printf("FlatCombining against lock based queues\n");
+
+    bool passed = true;
+    const std::vector<size_t> levels = contentionLevels();
+    for(size_t numThreads : levels)
+    {
+        passed = pushAndPop<TwoLockQueue>("ConcurrentQueue (two locks)", numThreads) && passed;
+        passed = pushAndPop<CombinedContainer<std::queue<size_t>>>("FlatCombining queue", numThreads) && passed;
+        passed = pushAndPop<LockedPriorityQueue>("SpinMutex priority_queue", numThreads) && passed;
+        passed = pushAndPop<CombinedContainer<std::priority_queue<size_t>>>("FlatCombining priority_queue",
+            numThreads) && passed;
+    }
+    return passed;
+}
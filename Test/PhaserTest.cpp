@@ -0,0 +1,144 @@
+#include "Benchmark.h"
+
+#include <LockFree/Mutex/Phaser.h>
+//#include <DX/LockFree/Mutex/Phaser.h>
+
+#include <cstdio>
+
+using namespace DX::LockFree;
+
+static const size_t NUM_PHASES = 4000;
+// Parties that join, go through ROUNDS_PER_VISIT phases and leave, VISITS times each
+static const size_t NUM_VISITORS = 2;
+static const size_t VISITS = 500;
+static const size_t ROUNDS_PER_VISIT = 3;
+// How long a phase may take before the test decides a wakeup was lost
+static const double STALL_SECONDS = 10.0;
+
+static bool check(bool passed, const char* what)
+{
+    std::printf("  %-70s %s\n", what, passed ? "ok" : "FAILED");
+    return passed;
+}
+
+// One thread registering, arriving and leaving, where every count can be checked along the way
+static bool counts()
+{
+    Phaser phaser(2);
+    bool passed = check(phaser.phase() == 0 && phaser.registeredParties() == 2 && phaser.unarrivedParties() == 2,
+        "Starts in phase 0 with every party unarrived");
+
+    const bool firstStaysPut = (phaser.arrive() == 0 && phaser.phase() == 0 && phaser.unarrivedParties() == 1);
+    const bool lastAdvances = (phaser.arrive() == 0 && phaser.phase() == 1 && phaser.unarrivedParties() == 2);
+    passed = check(firstStaysPut && lastAdvances, "Only the last arrival advances the phase, and re-arms it") && passed;
+    passed = check(phaser.awaitPhase(0) == 1, "Awaiting a phase that's already over returns at once") && passed;
+
+    const bool joined = (phaser.registerParty() == 1 && phaser.registeredParties() == 3 && phaser.unarrivedParties() == 3);
+    passed = check(joined, "A new party joins the current phase, unarrived") && passed;
+
+    const bool left = (phaser.arriveAndDeregister() == 1 && phaser.registeredParties() == 2 && phaser.unarrivedParties() == 2);
+    passed = check(left, "Deregistering arrives and leaves without advancing for the others") && passed;
+
+    phaser.arrive();
+    const bool advancedOnLeave = (phaser.arriveAndDeregister() == 1 && phaser.phase() == 2
+        && phaser.registeredParties() == 1 && phaser.unarrivedParties() == 1);
+    passed = check(advancedOnLeave, "The last party in leaving advances the phase for one fewer") && passed;
+    return passed;
+}
+
+/*
+    Every thread marks its work done, arrives, does unrelated work and then awaits the phase. Once a
+    thread is past awaitPhase(), every other thread must have marked its work for that phase.
+*/
+static bool splitPhase(size_t numThreads, size_t maxSpins)
+{
+    Phaser phaser(numThreads, maxSpins);
+    std::vector<std::atomic<size_t>> done(numThreads);
+    for(std::atomic<size_t>& count : done)
+        count.store(0);
+
+    std::atomic<size_t> progress(0);
+    std::atomic<bool> passed(true);
+    runThreadsWatched(numThreads, progress, STALL_SECONDS, [&](size_t thread)
+    {
+        volatile size_t overlapped = 0;
+        for(size_t phase = 0; phase < NUM_PHASES; ++phase)
+        {
+            done[thread].store(phase + 1);
+            const uint32_t arrived = phaser.arrive();
+            for(size_t i = 0; i < 64; ++i)
+                overlapped = overlapped + i;
+            if(arrived != phase || phaser.awaitPhase(arrived) == arrived)
+                passed.store(false);
+
+            for(const std::atomic<size_t>& count : done)
+            {
+                if(count.load() < phase + 1)
+                    passed.store(false);
+            }
+            progress.fetch_add(1);
+        }
+    });
+    return passed.load() && phaser.phase() == NUM_PHASES;
+}
+
+/*
+    Resident threads go through NUM_PHASES phases with arriveAndAwait() while visitors keep joining
+    and leaving. Until they deregister at the end, residents arrive exactly once a phase, and no
+    phase can move on without everyone registered in it - visitors included.
+*/
+static bool comeAndGo(size_t numResidents, size_t maxSpins)
+{
+    Phaser phaser(numResidents, maxSpins);
+    std::atomic<size_t> progress(0);
+    std::atomic<bool> passed(true);
+    runThreadsWatched(numResidents + NUM_VISITORS, progress, STALL_SECONDS, [&](size_t thread)
+    {
+        if(thread < numResidents)
+        {
+            for(size_t phase = 0; phase < NUM_PHASES; ++phase)
+            {
+                if(phaser.arriveAndAwait() != phase + 1)
+                    passed.store(false);
+                progress.fetch_add(1);
+            }
+            // Visitors still to come run the phaser between themselves
+            if(phaser.arriveAndDeregister() != NUM_PHASES)
+                passed.store(false);
+            return;
+        }
+
+        for(size_t visit = 0; visit < VISITS; ++visit)
+        {
+            uint32_t phase = phaser.registerParty();
+            for(size_t round = 0; round < ROUNDS_PER_VISIT; ++round)
+            {
+                // Nothing can advance without us, so we always arrive in the phase we expect
+                if(phaser.arrive() != phase || phaser.awaitPhase(phase) != phase + 1)
+                    passed.store(false);
+                ++phase;
+            }
+            if(phaser.arriveAndDeregister() != phase)
+                passed.store(false);
+            progress.fetch_add(1);
+        }
+    });
+    return passed.load() && phaser.registeredParties() == 0 && phaser.unarrivedParties() == 0;
+}
+
+bool testPhaser()
+{
+    std::printf("Phaser\n");
+    bool passed = counts();
+
+    const std::vector<size_t> levels = contentionLevels();
+    for(size_t numThreads : levels)
+    {
+        std::printf("  %u threads\n", unsigned(numThreads));
+        passed = check(splitPhase(numThreads, DEFAULT_FUTEX_SPINS), "Arrive, overlap and await, spinning first") && passed;
+        passed = check(splitPhase(numThreads, 0), "Arrive, overlap and await, always sleeping") && passed;
+        passed = check(comeAndGo(numThreads, DEFAULT_FUTEX_SPINS), "Residents and visitors registering and leaving") && passed;
+        passed = check(comeAndGo(numThreads, 0), "Residents and visitors, always sleeping") && passed;
+    }
+    return passed;
+}
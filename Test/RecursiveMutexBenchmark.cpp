@@ -0,0 +1,86 @@
+#include "Benchmark.h"
+
+#include <LockFree/Mutex/SpinRecursiveMutex.h>
+//#include <DX/LockFree/Mutex/SpinRecursiveMutex.h>
+
+#include <cstdio>
+#include <mutex>
+
+using namespace DX::LockFree;
+
+static const size_t RECURSION_DEPTH = 1000;
+static const size_t RECURSIONS = 2000;
+static const size_t NESTED_DEPTH = 4; // How deep each thread goes while contending
+static const size_t LOCKS_PER_THREAD = 100000;
+
+// Locks depth times over, one level of recursion per lock. \return How deep it went
+template <typename MutexType>
+static size_t recurse(MutexType& mutex, size_t depth)
+{
+    if(depth == 0)
+        return 0;
+    mutex.lock();
+    const size_t reached = 1 + recurse(mutex, depth - 1);
+    mutex.unlock();
+    return reached;
+}
+
+// One thread re-entering a lock it already holds, over and over
+template <typename MutexType>
+static bool deepRecursion(MutexType& mutex, const char* name)
+{
+    size_t reached = 0;
+    const double start = secondsNow();
+    for(size_t i = 0; i < RECURSIONS; ++i)
+        reached += recurse(mutex, RECURSION_DEPTH);
+    const double seconds = secondsNow() - start;
+
+    const size_t total = RECURSIONS * RECURSION_DEPTH;
+    std::printf("  %-20s deep recursion:        %8.1f ns/lock\n", name, seconds * 1e9 / double(total));
+    return reached == total;
+}
+
+// Every thread fighting for the lock, then recursing into it NESTED_DEPTH deep once it has it
+template <typename MutexType>
+static bool crossThread(MutexType& mutex, const char* name, size_t numThreads)
+{
+    size_t count = 0;
+    const double seconds = runThreads(numThreads, [&](size_t)
+    {
+        for(size_t i = 0; i < LOCKS_PER_THREAD; ++i)
+        {
+            mutex.lock();
+            recurse(mutex, NESTED_DEPTH - 1);
+            ++count;
+            mutex.unlock();
+        }
+    });
+
+    const size_t total = numThreads * LOCKS_PER_THREAD;
+    std::printf("  %-20s %4u threads contending: %8.1f ns/outer lock\n", name, unsigned(numThreads),
+        seconds * 1e9 / double(total));
+    return count == total;
+}
+
+bool benchmarkRecursiveMutex()
+{
+    std::printf("SpinRecursiveMutex against std::recursive_mutex\n");
+
+    bool passed = true;
+    {
+        SpinRecursiveMutex spinMutex;
+        passed = deepRecursion(spinMutex, "SpinRecursiveMutex") && passed;
+        std::recursive_mutex stdMutex;
+        passed = deepRecursion(stdMutex, "std::recursive_mutex") && passed;
+    }
+
+    const std::vector<size_t> levels = contentionLevels();
+    for(size_t numThreads : levels)
+    {
+        SpinRecursiveMutex spinMutex;
+        passed = crossThread(spinMutex, "SpinRecursiveMutex", numThreads) && passed;
+        std::recursive_mutex stdMutex;
+        passed = crossThread(stdMutex, "std::recursive_mutex", numThreads) && passed;
+    }
+    return passed;
+}
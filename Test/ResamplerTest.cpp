@@ -0,0 +1,188 @@
+#include "Benchmark.h"
+
+#include <Audio/AudioPacket.h>
+#include <Audio/Filters/PolyphaseResampler.h>
+
+#include <cmath>
+#include <cstdio>
+
+using namespace DX::Audio;
+
+static const double PI = 3.14159265358979323846;
+static const size_t PACKET_FRAMES = 480;
+static const double SINE_AMPLITUDE = 0.5;
+
+// Frames at either end of a run left out of measurements, for the filter to settle
+static const size_t SETTLE_FRAMES = 2048;
+
+static AudioFormat floatFormat(unsigned int sampleRate, unsigned short channels)
+{
+    AudioFormat format;
+    format.channels = channels;
+    format.samplesPerSecond = sampleRate;
+    format.bitsPerSample = 32;
+    format.bitsPerBlock = 4 * channels;
+    format.encoding = FLOAT32;
+    format.layout = PLANAR;
+    return format;
+}
+
+/*
+    Resamples seconds of a mono sine at frequency through one stream, a packet at a time.
+    \return Every frame that came out
+*/
+static std::vector<float> resampleSine(ResamplerQuality quality, unsigned int inRate, unsigned int outRate,
+    double frequency, double seconds)
+{
+    PolyphaseResampler resampler(quality);
+    const std::shared_ptr<FilterProcessor> processor = resampler.createProcessor();
+
+    const size_t numFrames = size_t(seconds * inRate);
+    std::vector<float> output;
+    std::vector<float> samples(PACKET_FRAMES);
+    for(size_t frame = 0; frame < numFrames; frame += PACKET_FRAMES)
+    {
+        for(size_t i = 0; i < PACKET_FRAMES; ++i)
+            samples[i] = float(SINE_AMPLITUDE * std::sin(2.0 * PI * frequency * double(frame + i) / inRate));
+
+        AudioPacket in(floatFormat(inRate, 1), PACKET_FRAMES * sizeof(float));
+        in.assign(samples.data(), PACKET_FRAMES * sizeof(float));
+        AudioPacket out(floatFormat(outRate, 1), (PACKET_FRAMES * outRate / inRate + 2) * sizeof(float));
+        if(!processor->process(in, out))
+            return std::vector<float>();
+
+        const float* produced = reinterpret_cast<const float*>(out.data());
+        output.insert(output.end(), produced, produced + out.byteSize() / sizeof(float));
+    }
+    return output;
+}
+
+/*
+    Fits a sine at frequency (any phase) to the settled part of samples by least squares.
+    \return The power of the fit, and of what's left over once it's taken out
+*/
+static void fitSine(const std::vector<float>& samples, double sampleRate, double frequency,
+    double& signalPower, double& residualPower)
+{
+    double ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0;
+    const size_t end = samples.size() - SETTLE_FRAMES;
+    for(size_t i = SETTLE_FRAMES; i < end; ++i)
+    {
+        const double angle = 2.0 * PI * frequency * double(i) / sampleRate;
+        const double s = std::sin(angle);
+        const double c = std::cos(angle);
+        ss += s * s;
+        sc += s * c;
+        cc += c * c;
+        ys += samples[i] * s;
+        yc += samples[i] * c;
+    }
+
+    const double determinant = ss * cc - sc * sc;
+    const double a = (ys * cc - yc * sc) / determinant;
+    const double b = (yc * ss - ys * sc) / determinant;
+
+    double residual = 0.0;
+    for(size_t i = SETTLE_FRAMES; i < end; ++i)
+    {
+        const double angle = 2.0 * PI * frequency * double(i) / sampleRate;
+        const double error = samples[i] - (a * std::sin(angle) + b * std::cos(angle));
+        residual += error * error;
+    }
+
+    signalPower = (a * a + b * b) / 2.0;
+    residualPower = residual / double(end - SETTLE_FRAMES);
+}
+
+static double decibels(double powerRatio)
+{
+    return 10.0 * std::log10(powerRatio);
+}
+
+// A 1 KHz sine from 44.1 KHz to 48 KHz, against a perfect one
+static double signalToNoise(ResamplerQuality quality)
+{
+    const std::vector<float> output = resampleSine(quality, 44100, 48000, 1000.0, 1.0);
+    if(output.size() < 4 * SETTLE_FRAMES)
+        return 0.0;
+
+    double signalPower = 0.0, residualPower = 0.0;
+    fitSine(output, 48000.0, 1000.0, signalPower, residualPower);
+    return decibels(signalPower / residualPower);
+}
+
+// A 12 KHz sine from 48 KHz to 16 KHz, where it would alias to 4 KHz. Everything that comes out is leakage
+static double aliasRejection(ResamplerQuality quality)
+{
+    const std::vector<float> output = resampleSine(quality, 48000, 16000, 12000.0, 1.0);
+    if(output.size() < 4 * SETTLE_FRAMES)
+        return 0.0;
+
+    double leaked = 0.0;
+    const size_t end = output.size() - SETTLE_FRAMES;
+    for(size_t i = SETTLE_FRAMES; i < end; ++i)
+        leaked += double(output[i]) * output[i];
+    leaked /= double(end - SETTLE_FRAMES);
+
+    const double inputPower = SINE_AMPLITUDE * SINE_AMPLITUDE / 2.0;
+    return decibels(inputPower / std::max(leaked, 1e-30));
+}
+
+// Ten seconds of stereo 44.1 KHz -> 48 KHz, as a percentage of one core
+static double cpuLoad(ResamplerQuality quality)
+{
+    static const unsigned int IN_RATE = 44100;
+    static const unsigned int OUT_RATE = 48000;
+    static const double SECONDS = 10.0;
+
+    PolyphaseResampler resampler(quality);
+    const std::shared_ptr<FilterProcessor> processor = resampler.createProcessor();
+    std::vector<float> samples(2 * PACKET_FRAMES);
+    for(size_t i = 0; i < samples.size(); ++i)
+        samples[i] = float(SINE_AMPLITUDE * std::sin(0.01 * double(i)));
+
+    AudioPacket in(floatFormat(IN_RATE, 2), samples.size() * sizeof(float));
+    in.assign(samples.data(), samples.size() * sizeof(float));
+    AudioPacket out(floatFormat(OUT_RATE, 2), 2 * (PACKET_FRAMES * OUT_RATE / IN_RATE + 2) * sizeof(float));
+
+    const size_t numPackets = size_t(SECONDS * IN_RATE / PACKET_FRAMES);
+    const double start = secondsNow();
+    for(size_t i = 0; i < numPackets; ++i)
+        processor->process(in, out);
+    const double elapsed = secondsNow() - start;
+    return 100.0 * elapsed / (double(numPackets * PACKET_FRAMES) / IN_RATE);
+}
+
+/*
+    What each preset is expected to reach, a little under its design stopband so float rounding
+    doesn't make the test flaky
+*/
+struct QualityTarget
+{
+    ResamplerQuality    quality;
+    const char*         name;
+    double              minimumDecibels;
+};
+
+bool testResampler()
+{
+    static const QualityTarget TARGETS[] =
+    {
+        { RESAMPLER_LOW, "LOW", 55.0 },
+        { RESAMPLER_MEDIUM, "MEDIUM", 85.0 },
+        { RESAMPLER_HIGH, "HIGH", 115.0 },
+    };
+
+    std::printf("PolyphaseResampler, %u frame packets\n", unsigned(PACKET_FRAMES));
+    bool passed = true;
+    for(const QualityTarget& target : TARGETS)
+    {
+        const double snr = signalToNoise(target.quality);
+        const double rejection = aliasRejection(target.quality);
+        const double load = cpuLoad(target.quality);
+        std::printf("  %-6s 44.1k->48k SNR %6.1f dB, 48k->16k alias rejection %6.1f dB, %5.2f%% of a core per stereo stream\n",
+            target.name, snr, rejection, load);
+        passed = snr >= target.minimumDecibels && rejection >= target.minimumDecibels && passed;
+    }
+    return passed;
+}
@@ -1,10 +1,87 @@
 
+#include "Benchmark.h"
+
 #include <Audio/AudioDXLib.h>
 
+#include <cstdio>
+#include <cstring>
+
 using namespace DX::Audio;
 
+namespace
+{
+    struct NamedTest
+    {
+        const char*     name;
+        bool            (*run)();
+    };
+
+    const NamedTest TESTS[] =
+    {
+        { "cohort", &benchmarkCohortMutex },
+        { "recursive", &benchmarkRecursiveMutex },
+        { "barriers", &benchmarkBarriers },
+        { "sleepers", &testSleepingBarriers },
+        { "phaser", &testPhaser },
+        { "combining", &benchmarkFlatCombining },
+        { "audit", &testAllocationAudit },
+        { "resampler", &testResampler },
+        { "graph", &testFilterGraph },
+        { "biquad", &benchmarkBiquadCascade },
+        { "convolution", &benchmarkConvolution },
+    };
+
+    const size_t NUM_TESTS = sizeof(TESTS) / sizeof(TESTS[0]);
+
+    // Set by skipTest() during the test running, if it is
+    const char* s_skipReason = nullptr;
+
+    bool runTest(const NamedTest& test)
+    {
+        s_skipReason = nullptr;
+        const bool passed = test.run();
+        if(passed && s_skipReason)
+            std::printf("%s: skipped, %s\n\n", test.name, s_skipReason);
+        else
+            std::printf("%s: %s\n\n", test.name, passed ? "passed" : "FAILED");
+        return passed;
+    }
+}
+
+void skipTest(const char* reason)
+{
+    s_skipReason = reason;
+}
+
+/*
+    With no arguments, opens the default devices. Otherwise runs the tests and benchmarks named,
+    or all of them for "all", and returns how many failed.
+*/
 int main(int argc, char* argv[])
 {
+    if(argc > 1)
+    {
+        int numFailed = 0;
+        for(int i = 1; i < argc; ++i)
+        {
+            bool found = false;
+            for(size_t j = 0; j < NUM_TESTS; ++j)
+            {
+                if(std::strcmp(argv[i], "all") != 0 && std::strcmp(argv[i], TESTS[j].name) != 0)
+                    continue;
+                found = true;
+                if(!runTest(TESTS[j]))
+                    ++numFailed;
+            }
+            if(!found)
+            {
+                std::printf("Unknown test %s\n", argv[i]);
+                ++numFailed;
+            }
+        }
+        return numFailed;
+    }
+
     {
         AudioDeviceManager manager;
         //manager.initialize();
@@ -20,4 +97,4 @@ int main(int argc, char* argv[])
     }
 
     return 0;
-}
\ No newline at end of file
+}